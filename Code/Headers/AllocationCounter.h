@@ -0,0 +1,58 @@
+/****************************************************************************
+		Description:	Defines the AllocationCounter and LibraryAllocations
+						Classes.
+
+		Classes:		AllocationCounter, LibraryAllocations
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef AllocationCounter_h
+#define AllocationCounter_h
+
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Counts heap allocations so vision_bench can check that the
+        processing loop doesn't allocate once it has warmed up. Nothing
+        calls Count() in VISION; vision_bench replaces operator new and the
+        default cv::MatAllocator with versions that do.
+
+        Some OpenCV calls (findContours, putText, dnn, ...) allocate inside
+        themselves no matter what buffers we hand them. Wrap those calls in
+        a LibraryAllocations scope so their allocations are counted apart
+        from ours.
+****************************************************************************/
+class AllocationCounter
+{
+public:
+    // Declare class methods.
+    static void Count();
+    static uint64_t GetCount();
+    static uint64_t GetLibraryCount();
+};
+
+/****************************************************************************
+        Marks allocations made by the calling thread while it is alive as
+        made inside a library. Scopes can nest.
+****************************************************************************/
+class LibraryAllocations
+{
+public:
+    // Declare class methods.
+    LibraryAllocations();
+    ~LibraryAllocations();
+    static bool IsActive();
+
+    // Scopes can't be copied.
+    LibraryAllocations(const LibraryAllocations&) = delete;
+    LibraryAllocations& operator=(const LibraryAllocations&) = delete;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,73 @@
+/****************************************************************************
+		Description:	Defines the BitMask Class.
+
+		Classes:		BitMask
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef BitMask_h
+#define BitMask_h
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "VisionKernels.h"
+
+using namespace cv;
+using namespace std;
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        A binary mask packed one bit per pixel, MASK_WORD_PIXELS pixels to
+        a word, so a 640x480 mask is 38KB instead of 300KB. Erode and
+        dilate with the 3x3 cross work on whole words with the VisionKernels
+        bits kernels, 64 pixels per 64-bit operation before any SIMD, and
+        give the same result as the byte kernels. The area is a popcount.
+
+        Masks only need to become Mats with ToMat when an OpenCV call
+        downstream needs one. Rows are padded to a whole word and the
+        padding bits are always clear.
+
+        The words keep their memory from frame to frame. A BitMask isn't
+        thread safe, but separate rows can be written from separate threads.
+****************************************************************************/
+class BitMask
+{
+public:
+    // Declare class methods.
+    BitMask();
+    ~BitMask();
+    void Create(int width, int height);
+    void FromMat(const Mat &maskImg, const KernelSet &kernels = VisionKernels::Get());
+    void ToMat(Mat &maskImg, const KernelSet &kernels = VisionKernels::Get()) const;
+    void Erode(BitMask &destination, const KernelSet &kernels = VisionKernels::Get()) const;
+    void Dilate(BitMask &destination, const KernelSet &kernels = VisionKernels::Get()) const;
+    void Open(BitMask &destination, const KernelSet &kernels = VisionKernels::Get());
+    int CountPixels() const;
+    void GetColumn(int x, uint64_t* columnWords) const;
+    static int EncodeRuns(const uint64_t* words, int length, uint16_t* runs);
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetWordsPerRow() const;
+    bool IsEmpty() const;
+    uint64_t* GetRow(int y);
+    const uint64_t* GetRow(int y) const;
+
+private:
+    // Declare class methods.
+    void RunMorphology(BitMask &destination, void (*rowKernel)(const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*, int)) const;
+
+    // Declare class variables.
+    vector<uint64_t>			words;
+    vector<uint64_t>			ringWords;
+    int							width;
+    int							height;
+    int							wordsPerRow;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,93 @@
+/****************************************************************************
+		Description:	Defines the BlobExtractor Class.
+
+		Classes:		BlobExtractor
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef BlobExtractor_h
+#define BlobExtractor_h
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "BitMask.h"
+#include "ContourSet.h"
+#include "VisionKernels.h"
+
+using namespace cv;
+using namespace std;
+
+// Define structs.
+struct Blob
+{
+    int area = 0;                       // Pixels in the blob.
+    Point2d centroid;                   // Mean position of those pixels.
+    Rect bounds;
+    Point top;                          // Leftmost pixel of the blob's top row.
+    Point bottom;                       // Leftmost pixel of the blob's bottom row.
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Finds the 8-connected blobs of a mask and measures them, without
+        tracing any outlines. Each row is run length encoded with the
+        VisionKernels EncodeRowRuns kernel, which skips through empty
+        stretches a vector at a time, and the runs touching between each
+        pair of rows are joined with union-find. The blobs' stats are
+        then summed straight from the runs, so the work grows with the
+        number of runs and not with the size of their outlines.
+
+        This can stand in for findContours + contourArea + moments when
+        only the size and position of each blob is needed. Areas count
+        pixels, like connectedComponentsWithStats, so they are a little
+        bigger than contourArea's, which goes through the outer pixels'
+        centers. Holes aren't filled, and a blob inside another's hole is
+        its own blob. Blobs come out in the order of their first pixel,
+        top to bottom and left to right.
+
+        A BitMask can be given instead of a Mat. Its runs are read
+        straight off the set bits, so it never has to be unpacked.
+
+        Set the VISION_BLOBS environment variable to runs to have the
+        trench mode use it instead of contours.
+****************************************************************************/
+class BlobExtractor
+{
+public:
+    // Declare class methods.
+    BlobExtractor();
+    ~BlobExtractor();
+    void Find(const Mat &maskImg, Point offset = Point(), const KernelSet &kernels = VisionKernels::Get());
+    void Find(const BitMask &mask, Point offset = Point(), int scale = 1);
+    void Clear();
+    int GetCount();
+    const Blob& GetBlob(int index);
+    int GetBiggest(double minArea, double maxArea);
+
+private:
+    // Declare class methods.
+    void Reserve(int width, int height);
+    void AddRow(int y, int rowRunCount);
+    void Measure(int height, Point offset, int scale);
+    int FindRoot(int run);
+    void JoinRows(int aboveFirst, int aboveEnd, int first, int end);
+
+    // Declare class variables.
+    vector<uint16_t>			runs;
+    vector<int>					rowFirstRuns;
+    vector<int>					parents;
+    vector<int>					runBlobs;
+    vector<Blob>				blobs;
+    vector<int64_t>				sumsX;
+    vector<int64_t>				sumsY;
+    int							runCount;
+    int							count;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
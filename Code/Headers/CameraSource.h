@@ -0,0 +1,47 @@
+/****************************************************************************
+			Description:	Defines the CameraSource Class
+
+			Classes:		CameraSource
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#ifndef CameraSource_h
+#define CameraSource_h
+
+#include <cstdio>
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "FrameSource.h"
+
+#include <opencv2/core/core.hpp>
+#include <cameraserver/CameraServer.h>
+
+using namespace std;
+using namespace cv;
+using namespace cs;
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Grabs frames from the USB cameras started by main through cscore.
+****************************************************************************/
+class CameraSource : public FrameSource
+{
+public:
+    // Declare class methods.
+    CameraSource(vector<CvSink> &cameraSinks, bool &cameraSourceIndex);
+    ~CameraSource();
+    bool GrabFrame(Mat &frame, FrameMeta &frameMeta);
+    string GetName();
+
+private:
+    // Declare class objects and variables.
+    vector<CvSink>&						cameraSinks;
+    bool&								cameraSourceIndex;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,64 @@
+/****************************************************************************
+		Description:	Defines the ChangeDetector Class.
+
+		Classes:		ChangeDetector
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef ChangeDetector_h
+#define ChangeDetector_h
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const int CHANGE_TILE_COLUMNS                       = 16;       // Tiles the frame is cut into across. (40 pixels wide at 640x480)
+const int CHANGE_TILE_ROWS                          = 12;       // Tiles the frame is cut into down.
+const int CHANGE_SAMPLE_STEP                        = 4;        // Only every 4th pixel of every 4th row is sampled.
+const double CHANGE_THRESHOLD                       = 3.0;      // Mean luma a tile has to move by to count as changed. (0-255)
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Finds the parts of the frame that have changed since they were
+        last searched. The frame is cut into CHANGE_TILE_COLUMNS x
+        CHANGE_TILE_ROWS tiles, and each tile's mean luma is taken from a
+        sparse grid of its pixels, which is the frame shrunk down to one
+        pixel a tile. A tile has changed if its luma has moved by more
+        than CHANGE_THRESHOLD since the last time a search covered all of
+        it. Tiles that are only compared to when they were last searched
+        can't drift away a little at a time without ever being searched.
+
+        Measure, then GetChangedRegion, then MarkSearched with whatever
+        was searched. Nothing is allocated once the tiles are set up for
+        the frame size. A ChangeDetector isn't thread safe.
+****************************************************************************/
+class ChangeDetector
+{
+public:
+    // Declare class methods.
+    ChangeDetector();
+    ~ChangeDetector();
+    void Measure(const Mat &frame);
+    Rect GetChangedRegion();
+    void MarkSearched(const Rect &region);
+    void Reset();
+
+private:
+    // Declare class variables.
+    vector<Rect>				tiles;
+    vector<float>				tileLumas;
+    vector<float>				referenceLumas;
+    vector<uint8_t>				hasReference;
+    Size						frameSize;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
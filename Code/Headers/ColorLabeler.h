@@ -0,0 +1,122 @@
+/****************************************************************************
+		Description:	Defines the ColorLabeler Class.
+
+		Classes:		ColorLabeler
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef ColorLabeler_h
+#define ColorLabeler_h
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BitMask.h"
+#include "VisionKernels.h"
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const int MAX_LABEL_COLORS                          = 8;        // One bit of the label image per color.
+const int COLOR_TABLE_BITS                          = 6;        // Bits kept from each of B, G and R when looking up a pixel. 6 bits makes a 256KB table that stays in the Pi's L2 cache.
+const int COLOR_TABLE_SIZE                          = 1 << (3 * COLOR_TABLE_BITS);
+const int MIN_STRIPE_ROWS                           = 32;       // Thinnest row stripe worth giving its own thread. Each stripe redoes up to 4 halo rows.
+
+// Define structs.
+struct LabelStats
+{
+    Rect bounds;                        // Smallest rect holding every pixel of the color. Empty if the color wasn't seen.
+    int pixelCount = 0;                 // Pixels of the color after dilation.
+};
+
+struct LabelStripeStats
+{
+    int pixelCounts[MAX_LABEL_COLORS];  // Per-color stats of one stripe, merged into LabelStats once every stripe is done.
+    int minX[MAX_LABEL_COLORS];
+    int minY[MAX_LABEL_COLORS];
+    int maxX[MAX_LABEL_COLORS];
+    int maxY[MAX_LABEL_COLORS];
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Classifies every pixel of a BGR camera image against a set of HSV
+        color ranges in one pass, without converting the image to HSV.
+        The top COLOR_TABLE_BITS of each channel index a 3D table holding a
+        bit for every color whose range covers the center of that BGR cell.
+        The table is only rebuilt when the ranges change.
+
+        The table stands in for a fixed-point BGR to HSV kernel followed
+        by a 3-channel range test. A lookup is one load per pixel instead
+        of a divide and six compares, but it isn't bit-exact with
+        cvtColor + inRange. Every pixel in a 4x4x4 cell gets the label of
+        the cell's center, so pixels in cells that straddle a range edge
+        can land on the wrong side of it, about 2 levels of B, G or R at
+        most. Hue is the most affected in dark or washed out pixels, where
+        a few levels of BGR swing it the furthest. vision_bench
+        --check-kernels prints how many pixels disagree.
+
+        FilterImage and LabelImage run the whole blur -> threshold ->
+        erode/dilate chain on the camera frame one row at a time. Each stage
+        keeps only the last BAND_RING_ROWS rows it made in a small ring
+        (about 6KB for a 640 wide frame), so the intermediates stay in L1
+        and only the finished image is written to memory. The frame is
+        also cut into row stripes that run on the ThreadPool together.
+        Each stripe redoes the few halo rows its 3x3 kernels reach into
+        its neighbours, so the output is the same as one stripe.
+
+        FilterImage's threshold writes packed bits (see BitMask) and the
+        erode and dilate run on whole words, so its rings are only 480
+        bytes for a 640 wide frame. It can hand back the BitMask itself, or unpack each row
+        into a 0/255 Mat as it finishes.
+
+        LabelImage dilates the label image with the same 3x3 cross the
+        per-color masks used and gathers per-color bounds, so each color's
+        blobs can be pulled out of just the area it covers. MaskImage just
+        writes a 0/255 mask of pixels matching any color, with no blur or
+        morphology.
+****************************************************************************/
+class ColorLabeler
+{
+public:
+    // Declare class methods.
+    ColorLabeler();
+    ~ColorLabeler();
+    void SetColorRanges(const vector<vector<Scalar>> &colorRanges);
+    void SetColorRange(const Scalar &lower, const Scalar &upper);
+    void FilterImage(const Mat &BGRImg, Mat &maskImg);
+    void FilterImage(const Mat &BGRImg, BitMask &mask);
+    void LabelImage(const Mat &BGRImg, Mat &labelImg);
+    void MaskImage(const Mat &BGRImg, Mat &maskImg);
+    Mat GetColorMask(const Mat &labelImg, int colorIndex, Mat &maskImg, Point offset = Point());
+    const vector<LabelStats>& GetStats();
+
+private:
+    // Declare class methods.
+    int GetStripeCount(int height);
+    void FilterStripes(const Mat &BGRImg, BitMask &mask, Mat* maskImg);
+    void FilterStripe(const Mat &BGRImg, BitMask &mask, Mat* maskImg, int firstRow, int lastRow, int stripe);
+    void LabelStripe(const Mat &BGRImg, Mat &labelImg, int firstRow, int lastRow, int stripe);
+    void BuildColorTable();
+
+    // Declare class variables.
+    vector<uint8_t>				colorTable;
+    vector<Scalar>				lowerBounds;
+    vector<Scalar>				upperBounds;
+    vector<uint8_t>				blurRows;
+    Mat							labelRingImg;
+    vector<uint64_t>			maskRingWords;
+    vector<uint64_t>			erodeRingWords;
+    BitMask						filterMask;
+    vector<LabelStats>			stats;
+    vector<LabelStripeStats>	stripeStats;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,85 @@
+/****************************************************************************
+		Description:	Defines the ContourSet Class.
+
+		Classes:		ContourSet
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef ContourSet_h
+#define ContourSet_h
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "AllocationCounter.h"
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const int MAX_TRACKED_CONTOURS                      = 1024;     // Contours the metric arrays are reserved for. Frames with more still work, but grow the arrays.
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        The contours of one mask, with each contour's metrics kept in
+        arrays next to its points. Every metric (bounding box, area,
+        moments, convex hull and hull area) is worked out the first time
+        it's asked for and then cached until the next Find, so sorting or
+        filtering never computes the same one twice.
+
+        The range checks go from cheap to expensive. Neither a contour
+        nor its hull can cover more than its bounding box, and a hull
+        always covers at least its contour, so most contours are thrown
+        out by their box or area before a hull is ever built.
+
+        The arrays keep their memory from frame to frame. A ContourSet
+        isn't thread safe; give each thread its own.
+****************************************************************************/
+class ContourSet
+{
+public:
+    // Declare class methods.
+    ContourSet();
+    ~ContourSet();
+    void Find(const Mat &maskImg, Point offset = Point(), int scale = 1);
+    void Clear();
+    int GetCount();
+    const vector<Point>& GetPoints(int index);
+    const Rect& GetBounds(int index);
+    double GetArea(int index);
+    const Moments& GetMoments(int index);
+    const vector<Point>& GetHull(int index);
+    double GetHullArea(int index);
+    bool IsAreaInRange(int index, double minArea, double maxArea);
+    bool IsHullAreaInRange(int index, double minArea, double maxArea);
+    int GetBiggest(double minArea, double maxArea);
+
+private:
+    // Bits of the cached array, one per metric.
+    enum CachedMetrics
+    {
+        BOUNDS_CACHED = 1,
+        AREA_CACHED = 2,
+        MOMENTS_CACHED = 4,
+        HULL_CACHED = 8,
+        HULL_AREA_CACHED = 16
+    };
+
+    // Declare class variables.
+    vector<vector<Point>>		points;
+    vector<uint8_t>				cached;
+    vector<Rect>				bounds;
+    vector<double>				areas;
+    vector<Moments>				moments;
+    vector<vector<Point>>		hulls;
+    vector<double>				hullAreas;
+    int							count;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,77 @@
+/****************************************************************************
+			Description:	Defines the FrameBuffer Class
+
+			Classes:		FrameBuffer
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#ifndef FrameBuffer_h
+#define FrameBuffer_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Define structs.
+struct FrameMeta
+{
+    uint64_t sequence = 0;              // Increases by one for every frame the capture thread produces. Zero means no frame.
+    int cameraIndex = 0;                // Which camera sink the frame came from.
+    uint64_t grabTime = 0;              // Capture time reported by cscore. (microseconds, wpi::Now() timebase)
+    uint64_t processStartTime = 0;      // When the processing thread started on the frame.
+    uint64_t processEndTime = 0;        // When the processing thread finished drawing the frame.
+    uint64_t publishTime = 0;           // When the results from the frame were pushed to NetworkTables.
+    Rect searchRegion;                  // Part of the frame the tracking mode searched.
+    bool isFullScan = true;             // Whether that was the whole frame, or just around the last target.
+};
+///////////////////////////////////////////////////////////////////////////////
+
+/****************************************************************************
+        Lock-free triple buffer for handing frames from exactly one producer
+        thread to exactly one consumer thread. The producer only ever writes
+        into its back slot and the consumer only ever reads its front slot.
+        The third (middle) slot is swapped in and out with a single atomic
+        exchange, so neither side takes a lock and a frame can never be read
+        while it is being written. Each slot carries the FrameMeta of the
+        frame in it, so the metadata always travels with its image.
+****************************************************************************/
+class FrameBuffer
+{
+public:
+    // Declare class methods.
+    FrameBuffer();
+    ~FrameBuffer();
+    Mat& GetWriteBuffer();
+    FrameMeta& GetWriteMeta();
+    void Publish();
+    bool Acquire();
+    bool WaitForFrame(int timeoutMS);
+    Mat& GetReadBuffer();
+    FrameMeta& GetReadMeta();
+
+private:
+    // Declare class constants.
+    static const uint8_t	INDEX_MASK = 0x03;
+    static const uint8_t	FRESH_FLAG = 0x04;
+
+    // Declare class objects and variables.
+    Mat						slots[3];
+    FrameMeta				slotMeta[3];
+    atomic<uint8_t>			middleIndex;
+    uint8_t					backIndex;
+    uint8_t					frontIndex;
+    atomic<bool>			consumerWaiting;
+    mutex					waitMutex;
+    condition_variable		frameReady;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,140 @@
+/****************************************************************************
+			Description:	Defines the FrameSource Classes
+
+			Classes:		FrameSource, VideoFileSource, ImageDirectorySource,
+							SyntheticSource
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#ifndef FrameSource_h
+#define FrameSource_h
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "FrameBuffer.h"
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/core/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <wpi/timestamp.h>
+
+using namespace std;
+using namespace cv;
+
+// Define constants.
+const double SYNTHETIC_SOURCE_FPS                   = 30.0;
+const int IMAGE_PRELOAD_LIMIT                       = 64;       // Images a directory source decodes up front. The rest are decoded as they play. (about 60MB at 640x480)
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Base class for anything VideoGet can pull frames from. A source fills
+        in the image and the grab time and capture-specific fields of the
+        frame's metadata; VideoGet takes care of the sequence number.
+****************************************************************************/
+class FrameSource
+{
+public:
+    // Declare class methods.
+    FrameSource();
+    virtual ~FrameSource();
+    virtual bool GrabFrame(Mat &frame, FrameMeta &frameMeta) = 0;
+    virtual string GetName() = 0;
+    bool GetIsFinished();
+    static FrameSource* Create(int sourceType, string sourcePath, bool isPaced, bool isLooping);
+
+    // Declare public variables.
+    enum SourceType
+    {
+        CAMERA_SOURCE = 0,
+        VIDEO_FILE_SOURCE,
+        IMAGE_DIRECTORY_SOURCE,
+        SYNTHETIC_SOURCE
+    };
+
+protected:
+    // Declare class methods.
+    void WaitForNextFrame(double framesPerSecond);
+
+    // Declare class variables.
+    chrono::steady_clock::time_point	startTime;
+    uint64_t							framesPaced;
+    bool								isPaced;
+    bool								isLooping;
+    bool								isFinished;
+};
+
+
+/****************************************************************************
+        Reads frames from a video file such as the clips in Example_Videos.
+****************************************************************************/
+class VideoFileSource : public FrameSource
+{
+public:
+    // Declare class methods.
+    VideoFileSource(string filePath, bool isPaced, bool isLooping);
+    ~VideoFileSource();
+    bool GrabFrame(Mat &frame, FrameMeta &frameMeta);
+    string GetName();
+
+private:
+    // Declare class objects and variables.
+    VideoCapture						cap;
+    string								filePath;
+    double								fileFPS;
+};
+
+
+/****************************************************************************
+        Plays back every image in a directory in file name order. The first
+        IMAGE_PRELOAD_LIMIT images are decoded once up front so disk and
+        decode time don't limit the unpaced frame rate of short clips. The
+        rest are decoded from disk as they play, so a directory of
+        thousands of snapshots doesn't fill memory.
+****************************************************************************/
+class ImageDirectorySource : public FrameSource
+{
+public:
+    // Declare class methods.
+    ImageDirectorySource(string directoryPath, bool isPaced, bool isLooping);
+    ~ImageDirectorySource();
+    bool GrabFrame(Mat &frame, FrameMeta &frameMeta);
+    string GetName();
+
+private:
+    // Declare class objects and variables.
+    vector<String>						imagePaths;
+    vector<Mat>							images;
+    Mat									streamImg;
+    string								directoryPath;
+    int									imageIndex;
+};
+
+
+/****************************************************************************
+        Generates moving colored shapes on a dark background. Useful for
+        exercising the pipeline when no camera or footage is available.
+****************************************************************************/
+class SyntheticSource : public FrameSource
+{
+public:
+    // Declare class methods.
+    SyntheticSource(bool isPaced);
+    ~SyntheticSource();
+    bool GrabFrame(Mat &frame, FrameMeta &frameMeta);
+    string GetName();
+
+private:
+    // Declare class variables.
+    int									frameIndex;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
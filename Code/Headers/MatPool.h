@@ -0,0 +1,94 @@
+/****************************************************************************
+		Description:	Defines the MatPool Class.
+
+		Classes:		MatPool
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef MatPool_h
+#define MatPool_h
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const size_t MAT_POOL_PAGE_SIZE                     = 4096;     // Pooled buffers start on a page and are a whole number of pages long.
+const int MIN_POOLED_BITS                           = 16;       // Buffers under 64KB are left to OpenCV's allocator. malloc already serves those from its own free lists.
+const int MAX_POOLED_BITS                           = 25;       // Size classes stop below 64MB. Anything bigger gets its own buffer every time.
+const int SIZE_CLASS_STEPS                          = 4;        // Size classes per power of two, so a buffer wastes at most 25% of its class.
+const int MAT_POOL_CLASSES                          = (MAX_POOLED_BITS - MIN_POOLED_BITS + 1) * SIZE_CLASS_STEPS;
+const size_t MAX_POOL_CACHED_BYTES                  = 256 << 20; // Free buffers kept for reuse. Past this, freed buffers go back to the system.
+
+// Define structs.
+struct MatPoolStats
+{
+    uint64_t hits = 0;                  // Buffers handed out from a free list.
+    uint64_t misses = 0;                // Buffers that had to come from the system.
+    size_t cachedBytes = 0;             // Bytes sitting in the free lists.
+    bool isLocked = false;              // Whether pooled buffers are locked into RAM.
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        A cv::MatAllocator that keeps freed frame-sized buffers in free
+        lists by size class and hands them back out, instead of going
+        through malloc and free and faulting fresh pages in every time a
+        frame-sized Mat is made. Once the pipeline has run for a few
+        frames every size it uses is in the pool and creating a Mat costs
+        a lock and a pointer swap.
+
+        New buffers are page aligned and touched once so their pages are
+        mapped before any pixels go in. Set the VISION_LOCK_POOL
+        environment variable to 1 to also mlock them, so the kernel can't
+        page them back out. That needs a big enough RLIMIT_MEMLOCK; the
+        pool warns once and carries on unlocked if it isn't.
+
+        The pool is installed as OpenCV's default allocator for the whole
+        program, so every thread's Mats come from it. Small buffers and
+        Mats wrapping memory they don't own are passed on to OpenCV's
+        standard allocator.
+****************************************************************************/
+class MatPool : public MatAllocator
+{
+public:
+    // Declare class methods.
+    MatPool(bool lockMemory);
+    ~MatPool();
+    static MatPool& Get();
+    MatPoolStats GetStats();
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const override;
+    bool allocate(UMatData* data, AccessFlag accessFlags, UMatUsageFlags usageFlags) const override;
+    void deallocate(UMatData* data) const override;
+
+private:
+    // Define structs.
+    struct FreeBuffer
+    {
+        FreeBuffer* next;               // Kept in the first bytes of the free buffer itself, so the lists never allocate.
+    };
+
+    // Declare class methods.
+    static int GetSizeClass(size_t bytes);
+    static size_t GetClassBytes(int sizeClass, size_t bytes);
+    uchar* TakeBuffer(int sizeClass, size_t bytes) const;
+    void ReturnBuffer(uchar* buffer, int sizeClass, size_t bytes) const;
+
+    // Declare class variables.
+    mutable mutex						poolMutex;
+    mutable FreeBuffer*					freeLists[MAT_POOL_CLASSES];
+    mutable size_t						cachedBytes;
+    mutable atomic<uint64_t>			hitCount;
+    mutable atomic<uint64_t>			missCount;
+    mutable atomic<bool>				isLocking;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
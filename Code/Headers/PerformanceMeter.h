@@ -0,0 +1,71 @@
+/****************************************************************************
+		Description:	Defines the PerformanceMeter Class.
+
+		Classes:		PerformanceMeter
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef PerformanceMeter_h
+#define PerformanceMeter_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <math.h>
+
+using namespace std;
+
+// Declare constants.
+const int LATENCY_BUCKET_COUNT                      = 80;       // Bucket upper bounds grow by LATENCY_BUCKET_GROWTH from LATENCY_BUCKET_START, so the last bucket ends past 6 seconds.
+const double LATENCY_BUCKET_START                   = 0.1;      // Upper bound of the first latency bucket. (milliseconds)
+const double LATENCY_BUCKET_GROWTH                  = 1.15;
+const int LATENCY_WINDOW_SAMPLES                    = 256;      // Bucket counts are halved this often so the percentiles follow recent frames.
+const double RATE_SMOOTHING                         = 0.1;      // EWMA weight given to the newest frame interval.
+
+// Define structs.
+struct PerformanceSnapshot
+{
+    uint64_t frames = 0;                // Total frames counted since start.
+    double framesPerSec = 0.0;          // Smoothed frame rate.
+    double p50 = 0.0;                   // Latency percentiles and max over recent frames. (milliseconds)
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Measures how fast a thread runs and how long each of its frames
+        takes. Only the owning thread counts frames and records latencies,
+        but any thread can take a snapshot at any time without locking.
+****************************************************************************/
+class PerformanceMeter
+{
+public:
+    // Declare class methods.
+    PerformanceMeter();
+    ~PerformanceMeter();
+    void Increment();
+    void RecordLatency(double milliseconds);
+    double GetFramesPerSec();
+    PerformanceSnapshot GetSnapshot();
+
+private:
+    // Declare class methods.
+    double GetBucketLimit(int bucket);
+
+    // Declare class variables.
+    chrono::steady_clock::time_point	startTime;
+    atomic<int64_t>						lastTickNanoseconds;
+    atomic<double>						smoothedInterval;
+    atomic<uint64_t>					frameCount;
+    atomic<uint32_t>					latencyBuckets[LATENCY_BUCKET_COUNT];
+    atomic<double>						windowMaxLatency;
+    atomic<double>						previousWindowMaxLatency;
+    int									windowSamples;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
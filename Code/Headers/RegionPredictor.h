@@ -0,0 +1,60 @@
+/****************************************************************************
+		Description:	Defines the RegionPredictor Class.
+
+		Classes:		RegionPredictor
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef RegionPredictor_h
+#define RegionPredictor_h
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const int ROI_PADDING                               = 40;       // Pixels searched on every side of where the target is expected.
+const int ROI_FULL_SCAN_INTERVAL                    = 30;       // Frames between full frame searches while tracking. (about 1 second at 30 fps)
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Predicts where in the frame a tracking mode needs to look, from
+        where its target was last found. Targets only move a few pixels
+        between frames, so after a hit the next frame is only searched
+        in a window around the last target, moved on by how far it moved
+        last frame and padded by ROI_PADDING plus that distance.
+
+        The whole frame is searched again after any miss, every
+        ROI_FULL_SCAN_INTERVAL frames so a better target elsewhere is
+        never missed for long, and whenever the frame size changes.
+
+        Keep one per tracking mode. A RegionPredictor isn't thread safe.
+****************************************************************************/
+class RegionPredictor
+{
+public:
+    // Declare class methods.
+    RegionPredictor();
+    ~RegionPredictor();
+    Rect Predict(Size frameSize);
+    void Hit(const Rect &targetBounds);
+    void Miss();
+    void Reset();
+    bool IsFullScan();
+    bool HasTarget();
+
+private:
+    // Declare class variables.
+    Rect						lastBounds;
+    Point						velocity;
+    Size						lastFrameSize;
+    int							framesSinceFullScan;
+    bool						hasTarget;
+    bool						isFullScan;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
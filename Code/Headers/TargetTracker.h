@@ -0,0 +1,88 @@
+/****************************************************************************
+		Description:	Defines the TargetTracker Class.
+
+		Classes:		TargetTracker
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef TargetTracker_h
+#define TargetTracker_h
+
+#include <cstdint>
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const double TARGET_MEASUREMENT_NOISE               = 16.0;     // Variance of a measured position. (pixels^2, about 4 pixels of jitter)
+const double TARGET_PROCESS_NOISE                   = 4000.0;   // How hard a target can accelerate, as white noise. (pixels^2/s^3)
+const double TARGET_INITIAL_VELOCITY_VARIANCE       = 40000.0;  // How unsure a new target's velocity of zero is. (pixels^2/s^2, about 200 pixels/s)
+const uint64_t TARGET_TIMEOUT                       = 500000;   // Time without a measurement before a target is dropped. (microseconds)
+
+// Define structs.
+struct TargetEstimate
+{
+    bool isValid = false;               // False if the target isn't being tracked.
+    Point2d position;                   // Where the target is predicted to be. (pixels)
+    Point2d velocity;                   // (pixels per second)
+    Vec3d covarianceX;                  // Covariance of x and its velocity. (position, cross, velocity)
+    Vec3d covarianceY;                  // The same for y. The axes are filtered separately, so there is none between them.
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        A constant velocity Kalman filter for one target's position. Each
+        measurement is taken at its frame's capture time, and the state
+        can be predicted forward to any later time, so results published
+        well after the frame was grabbed still say where the target is
+        now, and how sure that is.
+
+        x and y are filtered separately, each with a 2x2 covariance, which
+        is exact for a constant velocity model with independent noise on
+        each axis. That keeps every step to a few multiplies and nothing
+        is ever allocated. A target not measured for TARGET_TIMEOUT is
+        dropped, and starts over from its next measurement.
+
+        Times are microseconds in the wpi::Now() timebase. A
+        TargetTracker isn't thread safe.
+****************************************************************************/
+class TargetTracker
+{
+public:
+    // Declare class methods.
+    TargetTracker();
+    ~TargetTracker();
+    void Update(Point2d measurement, uint64_t time);
+    TargetEstimate Predict(uint64_t time) const;
+    void Reset();
+    bool IsTracking(uint64_t time) const;
+
+private:
+    // The state of one axis, and its covariance.
+    struct AxisState
+    {
+        double position = 0.0;
+        double velocity = 0.0;
+        double positionVariance = 0.0;
+        double crossVariance = 0.0;
+        double velocityVariance = 0.0;
+    };
+
+    // Declare class methods.
+    static void PredictAxis(AxisState &axis, double deltaTime);
+    static void CorrectAxis(AxisState &axis, double measurement);
+    static void StartAxis(AxisState &axis, double measurement);
+
+    // Declare class variables.
+    AxisState					axisX;
+    AxisState					axisY;
+    uint64_t					lastTime;
+    bool						isTracking;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,90 @@
+/****************************************************************************
+		Description:	Defines the ThreadPool Class.
+
+		Classes:		ThreadPool
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Declare constants.
+const int MAX_POOL_THREADS                          = 8;        // Never start more threads than this, even on big machines.
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        A fixed set of worker threads that lives for the whole program, so
+        splitting one frame's work up doesn't pay for starting threads.
+        ParallelFor hands out task indexes to the workers and the calling
+        thread alike and returns once every task is done, so it cuts the
+        latency of the frame and not just the throughput.
+
+        The pool uses one thread per core, counting the caller. Set the
+        VISION_THREADS environment variable to use fewer, or 1 to run
+        everything on the calling thread.
+****************************************************************************/
+class ThreadPool
+{
+public:
+    // Declare class methods.
+    ThreadPool(int threadCount);
+    ~ThreadPool();
+    static ThreadPool& Get();
+    int GetThreadCount();
+    template<class Task> void ParallelFor(int taskCount, const Task &task);
+
+private:
+    // Declare class methods.
+    void Run(int taskCount, void (*invoke)(const void*, int), const void* task);
+    void WorkerLoop(int workerIndex);
+    void RunTasks();
+
+    // Declare class variables.
+    vector<thread>					workers;
+    mutex							callMutex;
+    mutex							jobMutex;
+    condition_variable				jobStarted;
+    condition_variable				jobFinished;
+    void							(*jobInvoke)(const void*, int);
+    const void*						job;
+    int								jobTaskCount;
+    atomic<int>						nextTask;
+    int								busyWorkers;
+    uint64_t						jobGeneration;
+    exception_ptr					jobException;
+    bool							isStopping;
+};
+
+/****************************************************************************
+			Description:	Runs task(0) through task(taskCount - 1) across the
+							workers and the calling thread, and waits for all
+							of them. If a task throws, the first exception is
+							rethrown here once every task has finished. Calls
+							from different threads take turns. The task is
+							only referenced, never copied, so no matter what
+							it captures this doesn't allocate.
+
+			Arguments: 		INT, CONST TASK&
+
+			Returns: 		Nothing
+****************************************************************************/
+template<class Task> void ThreadPool::ParallelFor(int taskCount, const Task &task)
+{
+    Run(taskCount, [](const void* context, int index) { (*static_cast<const Task*>(context))(index); }, &task);
+}
+///////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,97 @@
+/****************************************************************************
+		Description:	Defines the Tracer and TraceSpan Classes.
+
+		Classes:		Tracer, TraceSpan
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef Tracer_h
+#define Tracer_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+// Declare constants.
+const int TRACE_RING_SIZE                           = 8192;     // Spans kept per thread. Must be a power of two. At ~20 spans a frame this is several seconds of history.
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        One thread's span history. Only the owning thread writes to it, so
+        recording a span is a few relaxed stores and one release store of
+        the head. A reader copies the ring and then throws away anything
+        the writer may have lapped while it was copying.
+****************************************************************************/
+struct TraceRing
+{
+    // Spans are stored as separate atomics so a reader racing the writer is never undefined behaviour.
+    struct Span
+    {
+        atomic<const char*> name;
+        atomic<int64_t> startTime;       // Nanoseconds since the tracer started.
+        atomic<int64_t> duration;        // Nanoseconds.
+    };
+
+    string threadName;
+    int threadID = 0;
+    atomic<uint64_t> head;               // Total spans ever written. The next span goes in head % TRACE_RING_SIZE.
+    Span spans[TRACE_RING_SIZE];
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Records timed spans from any thread into that thread's own lock-free
+        ring, and writes every ring out as a Chrome trace-event JSON file
+        that can be opened in chrome://tracing or ui.perfetto.dev.
+
+        Span names must be string literals (or otherwise never freed),
+        only the pointer is stored.
+****************************************************************************/
+class Tracer
+{
+public:
+    // Declare class methods.
+    static void SetThreadName(string threadName);
+    static int64_t Now();
+    static void Record(const char* name, int64_t startTime, int64_t endTime);
+    static bool WriteChromeTrace(string filePath);
+
+private:
+    // Declare class methods.
+    static TraceRing* GetThreadRing();
+};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Times the code between its construction and destruction. Next()
+        closes the current span and opens another, so a run of pipeline
+        stages can be traced without wrapping each one in its own block.
+****************************************************************************/
+class TraceSpan
+{
+public:
+    // Declare class methods.
+    TraceSpan(const char* name);
+    ~TraceSpan();
+    void Next(const char* name);
+    void End();
+
+private:
+    // Declare class variables.
+    const char*				name;
+    int64_t					startTime;
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
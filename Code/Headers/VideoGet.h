@@ -19,19 +19,17 @@
 #include <algorithm>
 #include <vector>
 
-#include "FPS.h"
+#include "PerformanceMeter.h"
+#include "Tracer.h"
+#include "FrameBuffer.h"
+#include "FrameSource.h"
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/opencv.hpp>
-#include <cameraserver/CameraServer.h>
 
 using namespace std;
 using namespace cv;
-using namespace cs;
-
-// Define constants.
-const bool USE_VIRTUAL_CAM = false;
 ///////////////////////////////////////////////////////////////////////////////
 
 class VideoGet
@@ -40,17 +38,17 @@ public:
     // Declare class methods.
     VideoGet();
     ~VideoGet();
-    void StartCapture(Mat &frame, bool &cameraSourceIndex, bool &drivingMode, vector<CvSink> &cameraSinks, shared_timed_mutex &Mutex);
+    void StartCapture(FrameSource &frameSource, FrameBuffer &frameBuffer);
     void SetIsStopping(bool isStopping);
     bool GetIsStopped();
     int GetFPS();
+    PerformanceSnapshot GetPerformance();
 
 private:
     // Declare class objects and variables.
-    FPS*					FPSCounter;
-    VideoCapture			cap;
+    PerformanceMeter*		PerformanceCounter;
     
-    int						FPSCount;
+    uint64_t				frameSequence;
     bool					isStopping;
     bool					isStopped;
 };
@@ -10,40 +10,48 @@
 #ifndef VideoProcess_h
 #define VideoProcess_h
 
+#include <cfloat>
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <atomic>
 #include <iostream>
 #include <algorithm>
 #include <vector>
 #include <math.h>
 
 #include "VideoGet.h"
-#include "FPS.h"
+#include "FrameBuffer.h"
+#include "PerformanceMeter.h"
+#include "ColorLabeler.h"
+#include "ContourSet.h"
+#include "BlobExtractor.h"
+#include "BitMask.h"
+#include "RegionPredictor.h"
+#include "ChangeDetector.h"
+#include "TargetTracker.h"
+#include "VisionKernels.h"
+#include "ThreadPool.h"
+#include "AllocationCounter.h"
+#include "Tracer.h"
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/opencv.hpp>
-#include <networktables/NetworkTableInstance.h>
-#include <vision/VisionPipeline.h>
-#include <vision/VisionRunner.h>
-#include <wpi/json.h>
-#include <wpi/raw_istream.h>
-#include <wpi/raw_ostream.h>
-#include <cameraserver/CameraServer.h>
+#include <wpi/timestamp.h>
 
 using namespace cv;
-using namespace cs;
-using namespace nt;
-using namespace frc;
 using namespace wpi;
 using namespace std;
 
 // Declare constants.
-const Mat KERNEL								    = getStructuringElement(MORPH_ELLIPSE, Size(3, 3));
-const int GREEN_BLUR_RADIUS						    = 3;
+const Mat KERNEL								    = getStructuringElement(MORPH_ELLIPSE, Size(3, 3));      // The 3x3 cross VisionKernels erodes and dilates with.
+const int GREEN_BLUR_RADIUS						    = 3;                                                    // The 3x3 box VisionKernels blurs with.
 const int HORIZONTAL_ASPECT						    = 4;
 const int VERTICAL_ASPECT						    = 3;
 const int CAMERA_FOV							    = 75;
@@ -56,6 +64,19 @@ const double DNN_NMS_THRESH                         = 0.4;
 const double PI                                     = 3.14159265358979323846;
 const double FOCAL_LENGTH						    = (SCREEN_WIDTH / 2.0) / tan((CAMERA_FOV * PI / 180.0) / 2.0);
 const vector<Scalar> DETECTION_COLORS               = {Scalar(255, 255, 0), Scalar(0, 255, 0), Scalar(0, 255, 255), Scalar(255, 0, 0)};
+const int DNN_MAX_PREDICTIONS                       = 25200;    // Rows of the YOLO output. Detection buffers are reserved for all of them.
+const int MAX_LINE_SPLITS                           = 8;        // Strips the line tracking mode cuts the frame into.
+const int MAX_LINE_SCANLINES                        = 30;       // Most scanlines the line tracking fast path samples. Each sends back a point, which has to fit in MAX_TRACKING_RESULTS.
+const int LINE_SCANLINE_REACH                       = 3;        // Rows (or columns) on each side of a scanline that reach it through the blur, erode and dilate.
+const int MAX_PYRAMID_LEVEL                         = 2;        // Most times the color modes can halve the frame before thresholding it. (4x smaller each way)
+const int PYRAMID_MIN_SIZE                          = 16;       // Smallest side a shrunk search region can have. Smaller regions are searched at full size.
+const int TAPE_REFINE_PADDING                       = 2;        // Pyramid pixels added around a tape strip's coarse box when it's found again at full size.
+const int MAX_TRACKING_RESULTS                      = 64;       // Values a mode can send back to the main thread without trackingResults growing.
+const int MAX_TRACKED_TARGETS                       = 8;        // Targets filtered before more filters are added. (a tape color or fish class each, or the trench center, or the line each way)
+const int TARGET_ESTIMATE_VALUES                    = 11;       // Values published for each filtered target. (index, x, y, vx, vy, then the x and y covariances)
+const int CHANGE_MAX_GATED_FRAMES                   = 30;       // Frames in a row the change gate can skip or narrow before one is searched in full anyway. (about 1 second at 30 fps)
+const int CHANGE_REGION_PADDING                     = 40;       // Pixels added around the changed tiles, so a target reaching into an unchanged tile isn't cut off.
+const double CHANGE_TIME_SMOOTHING                  = 0.1;      // Weight of each full frame in the moving average the time saved is estimated from.
 
 // Define structs.
 struct Detection
@@ -64,6 +85,43 @@ struct Detection
     float confidence;
     Rect box;
 };
+
+struct HullCandidate
+{
+    int index;                          // Index of the contour in the ContourSet, of the blob in the BlobExtractor, or the first column of a wall.
+    double area;
+    Vec4i extremes;                     // Highest and lowest point of the hull. (x1, y1, x2, y2)
+};
+
+struct LineStrip
+{
+    int area = 0;                       // Mask pixels in the strip.
+    int64_t sumX = 0;                   // First order moments of those pixels. (m10, m01)
+    int64_t sumY = 0;
+    Rect bounds;
+};
+
+struct TargetMeasurement
+{
+    int index;                          // Which of the mode's targets this is.
+    Point2d position;
+    double confidence;                  // Only the most confident measurement of each target is kept.
+};
+
+struct ChangeGateStats
+{
+    uint64_t checkedFrames = 0;         // Frames the change gate looked at.
+    uint64_t skippedFrames = 0;         // Frames that hadn't changed, so the last results were kept.
+    uint64_t narrowedFrames = 0;        // Frames where only the part that changed was searched.
+    uint64_t spentTime = 0;             // Time spent on the frames looked at, gate included. (microseconds)
+    uint64_t savedTime = 0;             // Estimated time saved, against searching each frame in full. (microseconds)
+};
+
+struct TapeObject
+{
+    int colorIndex;                     // Index into the tape colors.
+    RotatedRect rect;
+};
 ///////////////////////////////////////////////////////////////////////////////
 
 
@@ -73,12 +131,25 @@ public:
     // Declare class methods.
     VideoProcess();
     ~VideoProcess();
-    void Process(Mat &frame, Mat &finalImg, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &tuningMode, bool &drivingMode, int &trackingMode, bool &takeShapshot, bool &solvePNPEnabled, vector<int> &trackbarValues, vector<double> &trackingResults, vector<double> &solvePNPValues, vector<string> &classList, cv::dnn::Net &onnxModel, VideoGet &VideoGetter, shared_timed_mutex &MutexGet, shared_timed_mutex &MutexShow);
+    void Process(FrameBuffer &inputBuffer, FrameBuffer &outputBuffer, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &tuningMode, bool &drivingMode, int &trackingMode, bool &takeShapshot, bool &solvePNPEnabled, vector<int> &trackbarValues, vector<double> &trackingResults, vector<double> &solvePNPValues, vector<string> &classList, cv::dnn::Net &onnxModel, VideoGet &VideoGetter);
+    bool ProcessFrame(Mat &frame, Mat &finalImg, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &drivingMode, int &trackingMode, bool &takeShapshot, vector<int> &trackbarValues, vector<double> &trackingResults, vector<string> &classList, cv::dnn::Net &onnxModel);
     int SignNum(double val);
     vector<double> SolveObjectPose(vector<Point2f> imagePoints, Mat &finalImg, Mat &frame, int targetPositionX, int targetPositionY);
     void SetIsStopping(bool isStopping);
+    void SetLineScanlines(int scanlineCount);
+    void SetTrenchColumns(bool enabled);
+    void SetRegionPrediction(bool enabled);
+    void SetPyramidLevel(int level);
+    void SetChangeGate(bool enabled);
+    void UpdateTargets(uint64_t captureTime);
+    void GetTargetEstimates(uint64_t time, vector<double> &estimates);
     bool GetIsStopped();
     int GetFPS();
+    PerformanceSnapshot GetPerformance();
+    uint64_t GetDuplicateFramesSkipped();
+    uint64_t GetDroppedFrames();
+    FrameMeta GetLastFrameMeta();
+    ChangeGateStats GetChangeGateStats();
 
     // Declare public variables.
     enum TrackingMode
@@ -90,11 +161,25 @@ public:
     };
 
 private:
+    // Declare class methods.
+    Mat GetSearchImage(Mat &frame);
+    bool SkipUnchangedFrame(Mat &frame, Mat &finalImg, int centerLineTolerance, double contourAreaMinLimit, double contourAreaMaxLimit, vector<int> &trackbarValues);
+    bool LimitToChangedRegion(RegionPredictor &predictor);
+    void FindTrenchWalls(Point offset, int scale, double contourAreaMinLimit, double contourAreaMaxLimit);
+    Rect TrackTrenchCenter(Mat &finalImg, int &centerLineTolerance, int &targetCenterX, int &targetCenterY);
+    void MeasureLineStrips(const BitMask &mask, Point offset, int scale, Size frameSize, double contourAreaMinLimit, double contourAreaMaxLimit);
+    void FindLineScanlines(Mat &frame, Rect region, bool isVertical, int scanlineCount, double contourAreaMinLimit, double contourAreaMaxLimit);
+    void AddLinePoint(bool isVertical, Point center, Rect bounds, double contourAreaMaxLimit);
+    void AddTargetMeasurement(int index, Point2d position, double confidence = 1.0);
+
     // Declare class objects.
-    Mat							HSVImg;
-    Mat							blurImg;
-    Mat							filterImg;
     Mat							dilateImg;
+    BitMask						dilateMask;
+    Mat							labelImg;
+    Mat							pyramidImg;
+    Mat							pyramidMaskImg;
+    Mat							pyramidLabelImg;
+    Mat							refineMaskImg;
     Mat							corners;
     Mat							cornersNormalized;
     Mat							cornersScaled;
@@ -102,16 +187,81 @@ private:
     Mat							cameraMatrix;
     Mat							distanceCoefficients;
     vector<Point3f>				objectPoints;
-    vector<vector<Point>>		contours;
-    vector<Vec4i>				hierarchy;
+    ContourSet					contours;
+    BlobExtractor				blobs;
+    vector<Mat>					colorMaskImgs;
+    vector<ContourSet>			colorContours;
+    ContourSet					refineContours;
+    vector<HullCandidate>		hullCandidates;
+    ColumnProjection			trenchProjection;
+    vector<LineStrip>			lineStrips;
+    vector<Point>				verticalLinePoints;
+    vector<Point>				horizontalLinePoints;
+    vector<Rect>				verticalLineBounds;
+    vector<Rect>				horizontalLineBounds;
+    BitMask						scanlineMask;
+    RegionPredictor				trenchRegion;
+    RegionPredictor				lineRegion;
+    RegionPredictor				tapeRegion;
+    ChangeDetector				changeDetector;
+    Mat							lastFinalImg;
+    vector<int>					gateTrackbarValues;
+    vector<TargetMeasurement>	targetMeasurements;
+    vector<TargetTracker>		targetTrackers;
+    vector<uint64_t>			scanlineWords;
+    vector<uint16_t>			lineRuns;
+    Mat							blobImg;
+    vector<Mat>					predictions;
+    vector<String>				outputLayerNames;
+    vector<int>					classIDs;
+    vector<float>				confidences;
+    vector<Rect>				predictionBoxes;
+    vector<int>					NMSResults;
+    vector<Detection>			finalDetections;
+    vector<TapeObject>			tapeObjects;
+    vector<LabelStats>			tapeStats;
+    vector<Point2f>				boundingContour;
+    string						overlayText;
     vector<vector<Scalar>>      colorRanges;
     vector<string>                 colors;
-    FPS*						FPSCounter;
+    ColorLabeler				tapeLabeler;
+    ColorLabeler				trackbarLabeler;
+    PerformanceMeter*			PerformanceCounter;
 
     // Declare class variables.
-    int                         FPSCount;
+    FrameMeta                   lastFrameMeta;
+    mutex                       frameMetaMutex;
+    mutex                       targetMutex;
+    atomic<uint64_t>            duplicateFramesSkipped;
+    atomic<uint64_t>            droppedFrames;
+    atomic<uint64_t>            gateCheckedFrames;
+    atomic<uint64_t>            gateSkippedFrames;
+    atomic<uint64_t>            gateNarrowedFrames;
+    atomic<uint64_t>            gateSpentTime;
+    atomic<uint64_t>            gateSavedTime;
     bool						isStopping;
     bool						isStopped;
+    bool						useRunLengthBlobs;
+    bool						lineIsVertical;
+    int							lastTrackingMode;
+    int							filteredTrackingMode;
+    Rect						searchRegion;
+    int							searchLevel;
+    Rect						changedRegion;
+    bool						isChangeGated;
+    int							gatedFrameCount;
+    int							gateTolerance;
+    double						gateAreaMinLimit;
+    double						gateAreaMaxLimit;
+    int							gateScanlineCount;
+    bool						gateTrenchColumns;
+    int							gatePyramidLevel;
+    double						fullFrameTime;
+    atomic<int>					lineScanlineCount;
+    atomic<bool>				useTrenchColumns;
+    atomic<bool>				useRegionPrediction;
+    atomic<int>					pyramidLevel;
+    atomic<bool>				useChangeGate;
 };
 ///////////////////////////////////////////////////////////////////////////////
 #endif
\ No newline at end of file
@@ -19,7 +19,9 @@
 #include <algorithm>
 #include <vector>
 
-#include "FPS.h"
+#include "PerformanceMeter.h"
+#include "Tracer.h"
+#include "FrameBuffer.h"
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/opencv.hpp>
@@ -45,16 +47,19 @@ public:
     // Define class methods.
     VideoShow();
     ~VideoShow();
-    void ShowFrame(Mat &frame, vector<CvSource> &cameraSources, shared_timed_mutex &Mutex);
+    void ShowFrame(FrameBuffer &frameBuffer, vector<CvSource> &cameraSources);
     void SetIsStopping(bool isStopping);
     bool GetIsStopped();
     int GetFPS();
+    PerformanceSnapshot GetPerformance();
+    FrameMeta GetLastFrameMeta();
 
 private:
     // Declare class objects and variables.
-    FPS*						FPSCounter;
+    PerformanceMeter*			PerformanceCounter;
     
-    int							FPSCount;
+    FrameMeta					lastFrameMeta;
+    mutex						frameMetaMutex;
     bool						isStopping;
     bool						isStopped;
 };
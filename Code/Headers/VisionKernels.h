@@ -0,0 +1,281 @@
+/****************************************************************************
+		Description:	Defines the VisionKernels Class.
+
+		Classes:		VisionKernels
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#ifndef VisionKernels_h
+#define VisionKernels_h
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+// Declare constants.
+const int MASK_WORD_PIXELS                          = 64;       // Pixels packed into each word of a bit mask row.
+const int BAND_RING_ROWS                            = 3;        // Rows kept of each intermediate stage. A 3x3 kernel only ever needs the row above and below.
+
+// Define structs.
+/****************************************************************************
+        One implementation of every row kernel. Each kernel produces one
+        output row from the input row and the rows above and below it.
+        Edge rows are handled by the caller: pass the row itself for a
+        missing morphology neighbour (it can't change a min, max or OR),
+        and the reflected row (BORDER_REFLECT_101) for the blur.
+
+        EncodeRowRuns run length encodes one mask row instead. It writes
+        a start and end (one past the last pixel) pair for every run of
+        non-zero pixels and returns how many runs it found. A row has at
+        most (width + 1) / 2 runs.
+
+        The bits kernels work on mask rows packed MASK_WORD_PIXELS pixels
+        to a word, with pixel x in bit x % 64 of word x / 64. Bits past
+        the end of the row are always left clear. PackMaskRow and
+        UnpackMaskRow convert between these and 0/255 byte rows.
+
+        ProjectColumnsRow adds one mask row y to per-column stats: how
+        many pixels each column has, how long the vertical run each column
+        is in at row y is, and the longest run so far with the row it
+        ended on (the topmost, on a tie). Give it every row from the top,
+        starting from stats that are all zero.
+****************************************************************************/
+struct KernelSet
+{
+    const char* name;
+    void (*BoxBlur3x3Row)(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width, int channels);
+    void (*ErodeCrossRow)(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width);
+    void (*DilateCrossRow)(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width);
+    void (*DilateLabelsRow)(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width);
+    int (*EncodeRowRuns)(const uint8_t* row, int width, uint16_t* runs);
+    void (*PackMaskRow)(const uint8_t* row, int width, uint64_t* words);
+    void (*UnpackMaskRow)(const uint64_t* words, int width, uint8_t* row);
+    void (*ErodeBitsRow)(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width);
+    void (*DilateBitsRow)(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width);
+    void (*ProjectColumnsRow)(const uint8_t* row, int width, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds);
+};
+
+/****************************************************************************
+        Per-column stats of a mask, filled in by ProjectColumnsRow.
+****************************************************************************/
+struct ColumnProjection
+{
+    vector<uint16_t> counts;            // Mask pixels in each column.
+    vector<uint16_t> runLengths;        // Length of the run each column is in at the last row.
+    vector<uint16_t> longestRuns;       // Longest vertical run in each column.
+    vector<uint16_t> longestEnds;       // Last row of that run.
+};
+
+/****************************************************************************
+        Per-pixel versions of the kernels. The scalar kernels are loops over
+        these, and the SIMD kernels use them for the row edges and for the
+        pixels left over after the last full vector.
+****************************************************************************/
+static inline uint8_t BoxBlur3x3Pixel(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, int index, int rowBytes, int channels)
+{
+    // Reflect around the edge pixel (BORDER_REFLECT_101). A one pixel wide row reflects onto itself.
+    int left = (index >= channels) ? index - channels : min(index + channels, rowBytes - channels + index % channels);
+    int right = (index + channels < rowBytes) ? index + channels : max(index - channels, index % channels);
+    int sum = aboveRow[left] + aboveRow[index] + aboveRow[right] + row[left] + row[index] + row[right] + belowRow[left] + belowRow[index] + belowRow[right];
+
+    // Round to nearest, the same as OpenCV's fixed point (sum + 4) * 7282 >> 16.
+    return uint8_t((sum + 4) / 9);
+}
+
+static inline uint8_t ErodeCrossPixel(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, int x, int width)
+{
+    uint8_t value = min(row[x], min(aboveRow[x], belowRow[x]));
+    value = min(value, row[(x > 0) ? x - 1 : x]);
+    return min(value, row[(x < width - 1) ? x + 1 : x]);
+}
+
+static inline uint8_t DilateCrossPixel(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, int x, int width)
+{
+    uint8_t value = max(row[x], max(aboveRow[x], belowRow[x]));
+    value = max(value, row[(x > 0) ? x - 1 : x]);
+    return max(value, row[(x < width - 1) ? x + 1 : x]);
+}
+
+static inline uint8_t DilateLabelsPixel(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, int x, int width)
+{
+    return row[x] | aboveRow[x] | belowRow[x] | row[(x > 0) ? x - 1 : x] | row[(x < width - 1) ? x + 1 : x];
+}
+
+static inline void ProjectColumnsPixel(const uint8_t* row, int x, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds)
+{
+    bool isSet = row[x] != 0;
+    counts[x] += isSet ? 1 : 0;
+    runLengths[x] = isSet ? runLengths[x] + 1 : 0;
+    if (runLengths[x] > longestRuns[x])
+    {
+        longestRuns[x] = runLengths[x];
+        longestEnds[x] = uint16_t(y);
+    }
+}
+
+/****************************************************************************
+        Run length encoding helpers. The SIMD kernels turn a vector of mask
+        pixels into one bit per pixel (bit 0 is the leftmost) and only look
+        at the bits where a run starts or ends. inRun carries whether the
+        pixel before the chunk was set from one chunk to the next.
+****************************************************************************/
+static inline uint32_t GetMaskBits(const uint8_t* row, int count)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bits |= uint32_t(row[i] != 0) << i;
+    }
+    return bits;
+}
+
+static inline void AppendRunBits(uint32_t bits, int bitCount, int x, bool &inRun, uint16_t* runs, int &runCount)
+{
+    // A bit is set wherever a pixel differs from the one before it.
+    uint32_t chunkMask = (bitCount >= 32) ? 0xFFFFFFFFu : ((1u << bitCount) - 1);
+    uint32_t edges = (bits ^ ((bits << 1) | (inRun ? 1u : 0u))) & chunkMask;
+    while (edges != 0)
+    {
+        uint16_t edgeX = uint16_t(x + __builtin_ctz(edges));
+        if (inRun)
+        {
+            runs[2 * runCount + 1] = edgeX;
+            runCount++;
+        }
+        else
+        {
+            runs[2 * runCount] = edgeX;
+        }
+        inRun = !inRun;
+        edges &= edges - 1;
+    }
+}
+
+static inline int FinishRuns(int width, bool inRun, uint16_t* runs, int runCount)
+{
+    // A run touching the right edge ends there.
+    if (inRun)
+    {
+        runs[2 * runCount + 1] = uint16_t(width);
+        runCount++;
+    }
+    return runCount;
+}
+
+/****************************************************************************
+        Bit mask helpers. The SIMD kernels do whole words with both
+        neighbours inside the row and leave the first and last words to
+        these. A word's left and right neighbours are the word shifted one
+        bit, with the bit shifted in taken from the next word over. Past
+        the ends of the row an erode sees set pixels and a dilate clear
+        ones, which is the same as the byte kernels using the pixel itself.
+****************************************************************************/
+static inline int GetMaskWordCount(int width)
+{
+    return (width + MASK_WORD_PIXELS - 1) / MASK_WORD_PIXELS;
+}
+
+static inline uint64_t GetMaskWordBits(int index, int width)
+{
+    // Every word is full except maybe the last.
+    int count = min(width - index * MASK_WORD_PIXELS, MASK_WORD_PIXELS);
+    return (count >= MASK_WORD_PIXELS) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+}
+
+static inline uint64_t PackMaskWord(const uint8_t* row, int count)
+{
+    uint64_t word = 0;
+    for (int i = 0; i < count; i++)
+    {
+        word |= uint64_t(row[i] != 0) << i;
+    }
+    return word;
+}
+
+static inline void UnpackMaskWord(uint64_t word, uint8_t* row, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        row[i] = ((word >> i) & 1) ? 255 : 0;
+    }
+}
+
+static inline uint64_t ErodeBitsWord(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, int index, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int lastBit = (width - 1) % MASK_WORD_PIXELS;
+    uint64_t word = words[index];
+
+    uint64_t left = (word << 1) | ((index > 0) ? words[index - 1] >> (MASK_WORD_PIXELS - 1) : 1);
+    uint64_t right = (word >> 1) | ((index < wordCount - 1) ? words[index + 1] << (MASK_WORD_PIXELS - 1) : uint64_t(1) << lastBit);
+    return word & left & right & aboveWords[index] & belowWords[index] & GetMaskWordBits(index, width);
+}
+
+static inline uint64_t DilateBitsWord(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, int index, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    uint64_t word = words[index];
+
+    uint64_t left = (word << 1) | ((index > 0) ? words[index - 1] >> (MASK_WORD_PIXELS - 1) : 0);
+    uint64_t right = (word >> 1) | ((index < wordCount - 1) ? words[index + 1] << (MASK_WORD_PIXELS - 1) : 0);
+    return (word | left | right | aboveWords[index] | belowWords[index]) & GetMaskWordBits(index, width);
+}
+
+static inline void GetRingWords(const uint64_t* ringWords, int wordsPerRow, int y, int height, const uint64_t* &aboveWords, const uint64_t* &words, const uint64_t* &belowWords)
+{
+    // Row y of a ring of BAND_RING_ROWS packed rows. A missing neighbour past the edge of the image is the row itself.
+    words = ringWords + (y % BAND_RING_ROWS) * wordsPerRow;
+    aboveWords = (y > 0) ? ringWords + ((y - 1) % BAND_RING_ROWS) * wordsPerRow : words;
+    belowWords = (y < height - 1) ? ringWords + ((y + 1) % BAND_RING_ROWS) * wordsPerRow : words;
+}
+
+// Each instruction set's kernels live in their own file, built with that instruction set enabled. They return nullptr when not compiled in.
+const KernelSet* GetScalarKernels();
+const KernelSet* GetSSE4Kernels();
+const KernelSet* GetAVX2Kernels();
+const KernelSet* GetNEONKernels();
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Hand vectorized replacements for the 3x3 blur, erode and dilate the
+        color tracking modes run every frame, on byte images and on bit
+        masks (see BitMask). Results are bit-exact with
+        OpenCV's blur (normalized 3x3 box, BORDER_REFLECT_101) and with
+        erode/dilate using the 3x3 MORPH_ELLIPSE kernel (a cross) and the
+        default border. vision_bench --check-kernels checks this against
+        the installed OpenCV and times both.
+
+        The fastest kernel set the CPU supports is picked the first time
+        Get() is called. Set the VISION_KERNELS environment variable to
+        scalar, sse4, avx2 or neon to force one.
+****************************************************************************/
+class VisionKernels
+{
+public:
+    // Declare class methods.
+    static const KernelSet& Get();
+    static vector<const KernelSet*> GetSupported();
+    static void BoxBlur3x3(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels = Get());
+    static void ErodeCross(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels = Get());
+    static void DilateCross(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels = Get());
+    static void DilateLabels(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels = Get());
+    static void ProjectColumns(const Mat &maskImg, ColumnProjection &projection, const KernelSet &kernels = Get());
+
+private:
+    // Declare class methods.
+    static const KernelSet* Select();
+    static void RunMorphology(const Mat &sourceImg, Mat &destinationImg, void (*rowKernel)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int));
+};
+///////////////////////////////////////////////////////////////////////////////
+#endif
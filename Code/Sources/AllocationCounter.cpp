@@ -0,0 +1,103 @@
+/****************************************************************************
+		Description:	Implements the AllocationCounter and
+						LibraryAllocations Classes.
+
+		Classes:		AllocationCounter, LibraryAllocations
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/AllocationCounter.h"
+
+// Count() can be called from inside operator new, so these must never allocate themselves.
+static atomic<uint64_t> allocationCount(0);
+static atomic<uint64_t> libraryAllocationCount(0);
+static thread_local int libraryDepth = 0;
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Counts one allocation, as ours or as a library's
+							depending on the calling thread's scope.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void AllocationCounter::Count()
+{
+    if (libraryDepth > 0)
+    {
+        libraryAllocationCount.fetch_add(1, memory_order_relaxed);
+    }
+    else
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/****************************************************************************
+			Description:	Gets how many allocations were made outside of
+							any LibraryAllocations scope.
+
+			Arguments: 		None
+
+			Returns: 		UINT64
+****************************************************************************/
+uint64_t AllocationCounter::GetCount()
+{
+    return allocationCount.load(memory_order_relaxed);
+}
+
+/****************************************************************************
+			Description:	Gets how many allocations were made inside a
+							LibraryAllocations scope.
+
+			Arguments: 		None
+
+			Returns: 		UINT64
+****************************************************************************/
+uint64_t AllocationCounter::GetLibraryCount()
+{
+    return libraryAllocationCount.load(memory_order_relaxed);
+}
+
+
+/****************************************************************************
+			Description:	LibraryAllocations constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+LibraryAllocations::LibraryAllocations()
+{
+    libraryDepth++;
+}
+
+/****************************************************************************
+			Description:	LibraryAllocations destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+LibraryAllocations::~LibraryAllocations()
+{
+    libraryDepth--;
+}
+
+/****************************************************************************
+			Description:	Gets whether the calling thread is inside a
+							LibraryAllocations scope.
+
+			Arguments: 		None
+
+			Returns: 		BOOL
+****************************************************************************/
+bool LibraryAllocations::IsActive()
+{
+    return libraryDepth > 0;
+}
+///////////////////////////////////////////////////////////////////////////////
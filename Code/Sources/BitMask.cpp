@@ -0,0 +1,311 @@
+/****************************************************************************
+		Description:	Implements the BitMask Class.
+
+		Classes:		BitMask
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/BitMask.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	BitMask constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+BitMask::BitMask()
+{
+    // Initialize member variables.
+    width = 0;
+    height = 0;
+    wordsPerRow = 0;
+}
+
+/****************************************************************************
+			Description:	BitMask destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+BitMask::~BitMask()
+{
+}
+
+/****************************************************************************
+			Description:	Sizes the mask. The words only grow, so a mask
+							the same size as last frame doesn't allocate.
+							The contents are left as they were.
+
+			Arguments: 		INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::Create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    wordsPerRow = GetMaskWordCount(width);
+    words.resize(size_t(wordsPerRow) * height);
+}
+
+/****************************************************************************
+			Description:	Packs a CV_8UC1 mask. Any non-zero pixel is set.
+
+			Arguments: 		CONST MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::FromMat(const Mat &maskImg, const KernelSet &kernels)
+{
+    CV_Assert(maskImg.type() == CV_8UC1);
+
+    Create(maskImg.cols, maskImg.rows);
+    for (int y = 0; y < height; y++)
+    {
+        kernels.PackMaskRow(maskImg.ptr<uint8_t>(y), width, GetRow(y));
+    }
+}
+
+/****************************************************************************
+			Description:	Unpacks the mask into a 0/255 CV_8UC1 Mat.
+
+			Arguments: 		MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::ToMat(Mat &maskImg, const KernelSet &kernels) const
+{
+    maskImg.create(height, width, CV_8UC1);
+    for (int y = 0; y < height; y++)
+    {
+        kernels.UnpackMaskRow(GetRow(y), width, maskImg.ptr<uint8_t>(y));
+    }
+}
+
+/****************************************************************************
+			Description:	Erodes the mask with a 3x3 cross.
+
+			Arguments: 		BITMASK& (not this mask), CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::Erode(BitMask &destination, const KernelSet &kernels) const
+{
+    RunMorphology(destination, kernels.ErodeBitsRow);
+}
+
+/****************************************************************************
+			Description:	Dilates the mask with a 3x3 cross.
+
+			Arguments: 		BITMASK& (not this mask), CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::Dilate(BitMask &destination, const KernelSet &kernels) const
+{
+    RunMorphology(destination, kernels.DilateBitsRow);
+}
+
+/****************************************************************************
+			Description:	Erodes then dilates the mask with a 3x3 cross.
+							The eroded rows only pass through a ring of
+							BAND_RING_ROWS rows, with each dilate running one
+							row behind the erode.
+
+			Arguments: 		BITMASK& (not this mask), CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::Open(BitMask &destination, const KernelSet &kernels)
+{
+    CV_Assert(&destination != this);
+
+    // Create instance variables.
+    const uint64_t* aboveWords;
+    const uint64_t* rowWords;
+    const uint64_t* belowWords;
+    destination.Create(width, height);
+    ringWords.resize(size_t(BAND_RING_ROWS) * wordsPerRow);
+
+    for (int y = 0; y < height + 1; y++)
+    {
+        // Erode row y.
+        if (y < height)
+        {
+            aboveWords = (y > 0) ? GetRow(y - 1) : GetRow(y);
+            rowWords = GetRow(y);
+            belowWords = (y < height - 1) ? GetRow(y + 1) : GetRow(y);
+            kernels.ErodeBitsRow(aboveWords, rowWords, belowWords, &ringWords[(y % BAND_RING_ROWS) * wordsPerRow], width);
+        }
+
+        // Dilate row y - 1 now that the eroded row below it exists.
+        int dilateY = y - 1;
+        if (dilateY >= 0)
+        {
+            GetRingWords(ringWords.data(), wordsPerRow, dilateY, height, aboveWords, rowWords, belowWords);
+            kernels.DilateBitsRow(aboveWords, rowWords, belowWords, destination.GetRow(dilateY), width);
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Counts the set pixels.
+
+			Arguments: 		None
+
+			Returns: 		INT
+****************************************************************************/
+int BitMask::CountPixels() const
+{
+    // Create instance variables.
+    int count = 0;
+
+    // The padding bits are clear, so every word can be counted whole.
+    for (uint64_t word : words)
+    {
+        count += __builtin_popcountll(word);
+    }
+
+    return count;
+}
+
+/****************************************************************************
+			Description:	Packs one column of the mask into words, the same
+							way a row is packed.
+
+			Arguments: 		INT, UINT64_T* (room for height pixels)
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::GetColumn(int x, uint64_t* columnWords) const
+{
+    // Create instance variables.
+    int wordIndex = x / MASK_WORD_PIXELS;
+    int bit = x % MASK_WORD_PIXELS;
+
+    for (int y = 0; y < height; y += MASK_WORD_PIXELS)
+    {
+        uint64_t word = 0;
+        int count = min(height - y, MASK_WORD_PIXELS);
+        for (int i = 0; i < count; i++)
+        {
+            word |= ((GetRow(y + i)[wordIndex] >> bit) & 1) << i;
+        }
+        columnWords[y / MASK_WORD_PIXELS] = word;
+    }
+}
+
+/****************************************************************************
+			Description:	Run length encodes a packed row, the same as the
+							EncodeRowRuns kernels do a byte row. Words with
+							no run starting or ending in them are skipped.
+
+			Arguments: 		CONST UINT64_T*, INT (pixels), UINT16_T*
+
+			Returns: 		INT (runs found)
+****************************************************************************/
+int BitMask::EncodeRuns(const uint64_t* words, int length, uint16_t* runs)
+{
+    // Create instance variables.
+    int runCount = 0;
+    bool inRun = false;
+
+    for (int x = 0; x < length; x += MASK_WORD_PIXELS)
+    {
+        uint64_t word = words[x / MASK_WORD_PIXELS];
+        int count = min(length - x, MASK_WORD_PIXELS);
+
+        // Most words are all background, or all inside one run.
+        if (word != (inRun ? ~uint64_t(0) : 0))
+        {
+            AppendRunBits(uint32_t(word), min(count, 32), x, inRun, runs, runCount);
+            if (count > 32)
+            {
+                AppendRunBits(uint32_t(word >> 32), count - 32, x + 32, inRun, runs, runCount);
+            }
+        }
+    }
+
+    return FinishRuns(length, inRun, runs, runCount);
+}
+
+/****************************************************************************
+			Description:	Gets the size of the mask.
+
+			Arguments: 		None
+
+			Returns: 		INT
+****************************************************************************/
+int BitMask::GetWidth() const
+{
+    return width;
+}
+
+int BitMask::GetHeight() const
+{
+    return height;
+}
+
+int BitMask::GetWordsPerRow() const
+{
+    return wordsPerRow;
+}
+
+/****************************************************************************
+			Description:	Checks if the mask has no pixels at all.
+
+			Arguments: 		None
+
+			Returns: 		BOOL
+****************************************************************************/
+bool BitMask::IsEmpty() const
+{
+    return width == 0 || height == 0;
+}
+
+/****************************************************************************
+			Description:	Gets the packed words of a row.
+
+			Arguments: 		INT
+
+			Returns: 		UINT64_T*
+****************************************************************************/
+uint64_t* BitMask::GetRow(int y)
+{
+    return words.data() + size_t(y) * wordsPerRow;
+}
+
+const uint64_t* BitMask::GetRow(int y) const
+{
+    return words.data() + size_t(y) * wordsPerRow;
+}
+
+/****************************************************************************
+			Description:	Runs a 3x3 cross bits kernel over the whole mask.
+							Missing neighbours past the top and bottom are
+							replaced by the row itself.
+
+			Arguments: 		BITMASK&, ROW KERNEL
+
+			Returns: 		Nothing
+****************************************************************************/
+void BitMask::RunMorphology(BitMask &destination, void (*rowKernel)(const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*, int)) const
+{
+    CV_Assert(&destination != this);
+
+    destination.Create(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        const uint64_t* rowWords = GetRow(y);
+        const uint64_t* aboveWords = (y > 0) ? GetRow(y - 1) : rowWords;
+        const uint64_t* belowWords = (y < height - 1) ? GetRow(y + 1) : rowWords;
+        rowKernel(aboveWords, rowWords, belowWords, destination.GetRow(y), width);
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
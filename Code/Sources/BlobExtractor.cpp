@@ -0,0 +1,327 @@
+/****************************************************************************
+		Description:	Implements the BlobExtractor Class.
+
+		Classes:		BlobExtractor
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/BlobExtractor.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	BlobExtractor constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+BlobExtractor::BlobExtractor()
+{
+    // Initialize member variables.
+    runCount = 0;
+    count = 0;
+
+    // Reserve the blob arrays up front. The run arrays are sized for the worst case once the frame size is known.
+    blobs.reserve(MAX_TRACKED_CONTOURS);
+    sumsX.reserve(MAX_TRACKED_CONTOURS);
+    sumsY.reserve(MAX_TRACKED_CONTOURS);
+}
+
+/****************************************************************************
+			Description:	BlobExtractor destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+BlobExtractor::~BlobExtractor()
+{
+}
+
+/****************************************************************************
+			Description:	Finds and measures the blobs of a mask.
+
+			Arguments: 		CONST MAT&, POINT (added to every position), CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::Find(const Mat &maskImg, Point offset, const KernelSet &kernels)
+{
+    // Create instance variables.
+    int width = maskImg.cols;
+    int height = maskImg.rows;
+
+    Reserve(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        AddRow(y, kernels.EncodeRowRuns(maskImg.ptr<uint8_t>(y), width, &runs[2 * runCount]));
+    }
+    Measure(height, offset, 1);
+}
+
+/****************************************************************************
+			Description:	Finds and measures the blobs of a bit mask. The
+							runs come straight from the set bits of each
+							word, so the mask never has to be unpacked.
+
+							A mask shrunk down a pyramid level can give its
+							scale, and the blobs are measured in full size
+							pixels.
+
+			Arguments: 		CONST BITMASK&, POINT (added to every position), INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::Find(const BitMask &mask, Point offset, int scale)
+{
+    // Create instance variables.
+    int width = mask.GetWidth();
+    int height = mask.GetHeight();
+
+    Reserve(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        AddRow(y, BitMask::EncodeRuns(mask.GetRow(y), width, &runs[2 * runCount]));
+    }
+    Measure(height, offset, scale);
+}
+
+/****************************************************************************
+			Description:	Makes room for the runs of a mask, sized for every
+							row to be as broken up as it can be so a busy
+							frame never grows the arrays.
+
+			Arguments: 		INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::Reserve(int width, int height)
+{
+    size_t maxRuns = size_t(height) * ((width + 1) / 2);
+    if (runs.size() < 2 * maxRuns)
+    {
+        runs.resize(2 * maxRuns);
+        parents.resize(maxRuns);
+        runBlobs.resize(maxRuns);
+    }
+    rowFirstRuns.resize(height + 1);
+    runCount = 0;
+}
+
+/****************************************************************************
+			Description:	Adds the runs just encoded for a row, and joins
+							them to the ones touching them in the row above.
+
+			Arguments: 		INT, INT (runs in the row)
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::AddRow(int y, int rowRunCount)
+{
+    rowFirstRuns[y] = runCount;
+    for (int i = runCount; i < runCount + rowRunCount; i++)
+    {
+        parents[i] = i;
+    }
+    runCount += rowRunCount;
+
+    if (y > 0)
+    {
+        JoinRows(rowFirstRuns[y - 1], rowFirstRuns[y], rowFirstRuns[y], runCount);
+    }
+}
+
+/****************************************************************************
+			Description:	Sums up each blob's stats from its runs.
+
+			Arguments: 		INT, POINT (added to every position), INT (every position is multiplied by)
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::Measure(int height, Point offset, int scale)
+{
+    rowFirstRuns[height] = runCount;
+
+    // Roots are always a blob's first run, so a blob is started before any of its other runs come up.
+    count = 0;
+    blobs.clear();
+    sumsX.clear();
+    sumsY.clear();
+    for (int y = 0; y < height; y++)
+    {
+        for (int i = rowFirstRuns[y]; i < rowFirstRuns[y + 1]; i++)
+        {
+            int start = runs[2 * i];
+            int end = runs[2 * i + 1];
+            int length = end - start;
+            int root = FindRoot(i);
+
+            // Start a new blob at its first run.
+            if (root == i)
+            {
+                Blob blob;
+                blob.bounds = Rect(start, y, length, 1);
+                blob.top = Point(start, y);
+                blob.bottom = Point(start, y);
+                blobs.push_back(blob);
+                sumsX.push_back(0);
+                sumsY.push_back(0);
+                runBlobs[i] = count++;
+            }
+            else
+            {
+                runBlobs[i] = runBlobs[root];
+            }
+
+            // Add the run. The x values of a run sum to (start + end - 1) * length / 2.
+            int index = runBlobs[i];
+            Blob &blob = blobs[index];
+            blob.area += length;
+            sumsX[index] += int64_t(start + end - 1) * length / 2;
+            sumsY[index] += int64_t(y) * length;
+            blob.bounds |= Rect(start, y, length, 1);
+            if (y > blob.bottom.y)
+            {
+                blob.bottom = Point(start, y);
+            }
+        }
+    }
+
+    // Finish the centroids and move everything into place. Each pixel of a scaled mask stands for scale x scale pixels.
+    for (int i = 0; i < count; i++)
+    {
+        Blob &blob = blobs[i];
+        blob.centroid = Point2d(double(sumsX[i]) / blob.area * scale + offset.x, double(sumsY[i]) / blob.area * scale + offset.y);
+        blob.area *= scale * scale;
+        blob.bounds = Rect(blob.bounds.x * scale + offset.x, blob.bounds.y * scale + offset.y, blob.bounds.width * scale, blob.bounds.height * scale);
+        blob.top = blob.top * scale + offset;
+        blob.bottom = blob.bottom * scale + offset;
+    }
+}
+
+/****************************************************************************
+			Description:	Empties the set without finding anything.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::Clear()
+{
+    count = 0;
+}
+
+/****************************************************************************
+			Description:	Gets how many blobs the last Find found.
+
+			Arguments: 		None
+
+			Returns: 		INT
+****************************************************************************/
+int BlobExtractor::GetCount()
+{
+    return count;
+}
+
+/****************************************************************************
+			Description:	Gets the stats of a blob.
+
+			Arguments: 		INT
+
+			Returns: 		CONST BLOB&
+****************************************************************************/
+const Blob& BlobExtractor::GetBlob(int index)
+{
+    return blobs[index];
+}
+
+/****************************************************************************
+			Description:	Finds the blob with the most pixels within limits.
+							Ties go to the first blob.
+
+			Arguments: 		DOUBLE, DOUBLE
+
+			Returns: 		INT (index of the blob, or -1 if none fit)
+****************************************************************************/
+int BlobExtractor::GetBiggest(double minArea, double maxArea)
+{
+    // Create instance variables.
+    int biggestIndex = -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        int area = blobs[i].area;
+        if (area >= minArea && area <= maxArea && (biggestIndex < 0 || area > blobs[biggestIndex].area))
+        {
+            biggestIndex = i;
+        }
+    }
+
+    return biggestIndex;
+}
+
+/****************************************************************************
+			Description:	Finds the first run of a run's blob, halving the
+							path to it on the way.
+
+			Arguments: 		INT
+
+			Returns: 		INT
+****************************************************************************/
+int BlobExtractor::FindRoot(int run)
+{
+    while (parents[run] != run)
+    {
+        parents[run] = parents[parents[run]];
+        run = parents[run];
+    }
+
+    return run;
+}
+
+/****************************************************************************
+			Description:	Joins the runs of a row to the runs of the row
+							above that they touch, including at a corner.
+							Both rows are walked left to right together.
+
+			Arguments: 		INT, INT (runs of the row above), INT, INT (runs of the row)
+
+			Returns: 		Nothing
+****************************************************************************/
+void BlobExtractor::JoinRows(int aboveFirst, int aboveEnd, int first, int end)
+{
+    int above = aboveFirst;
+    int current = first;
+    while (above < aboveEnd && current < end)
+    {
+        // Runs are 8-connected if each starts no further right than one past the other's last pixel.
+        if (runs[2 * above] <= runs[2 * current + 1] && runs[2 * current] <= runs[2 * above + 1])
+        {
+            // The earlier run becomes the root, so roots stay each blob's first run.
+            int aboveRoot = FindRoot(above);
+            int root = FindRoot(current);
+            if (aboveRoot < root)
+            {
+                parents[root] = aboveRoot;
+            }
+            else if (root < aboveRoot)
+            {
+                parents[aboveRoot] = root;
+            }
+        }
+
+        // Whichever run ends first can't touch anything further right.
+        if (runs[2 * above + 1] < runs[2 * current + 1])
+        {
+            above++;
+        }
+        else
+        {
+            current++;
+        }
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,82 @@
+/****************************************************************************
+			Description:	Implements the CameraSource Class
+
+			Classes:		CameraSource
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#include "../Headers/CameraSource.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Description:	CameraSource constructor.
+
+        Arguments:		VECTOR<CVSINK>&, BOOL&
+
+        Derived From:	FrameSource
+****************************************************************************/
+CameraSource::CameraSource(vector<CvSink> &cameraSinks, bool &cameraSourceIndex) : cameraSinks(cameraSinks), cameraSourceIndex(cameraSourceIndex)
+{
+    // Cameras deliver frames at their own pace.
+    isLooping                               = true;
+}
+
+/****************************************************************************
+        Description:	CameraSource destructor.
+
+        Arguments:		None
+
+        Derived From:	FrameSource
+****************************************************************************/
+CameraSource::~CameraSource()
+{
+
+}
+
+/****************************************************************************
+        Description:	Grabs a frame from either camera1 or camera2.
+
+        Arguments: 		MAT&, FRAMEMETA&
+
+        Returns: 		BOOL (true if a frame was grabbed)
+****************************************************************************/
+bool CameraSource::GrabFrame(Mat &frame, FrameMeta &frameMeta)
+{
+    // If there are no cameras, stop the capture.
+    if (cameraSinks.empty())
+    {
+        isFinished = true;
+        return false;
+    }
+
+    // Pick the camera, falling back to the first one if the second isn't plugged in.
+    int cameraIndex = (cameraSourceIndex && cameraSinks.size() > 1) ? 1 : 0;
+
+    // Get camera frame. A frame time of zero means the grab failed.
+    uint64_t frameTime = cameraSinks[cameraIndex].GrabFrame(frame);
+    if (frameTime == 0)
+    {
+        return false;
+    }
+
+    // Stamp the frame with the time cscore captured it.
+    frameMeta.cameraIndex = cameraIndex;
+    frameMeta.grabTime = frameTime;
+    return true;
+}
+
+/****************************************************************************
+        Description:	Gets a name describing the source.
+
+        Arguments: 		None
+
+        Returns: 		STRING
+****************************************************************************/
+string CameraSource::GetName()
+{
+    return "camera";
+}
+///////////////////////////////////////////////////////////////////////////////
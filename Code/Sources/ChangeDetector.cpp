@@ -0,0 +1,151 @@
+/****************************************************************************
+		Description:	Implements the ChangeDetector Class.
+
+		Classes:		ChangeDetector
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/ChangeDetector.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	ChangeDetector constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ChangeDetector::ChangeDetector()
+{
+    // Size the tile arrays up front. They never change size.
+    tiles.resize(CHANGE_TILE_COLUMNS * CHANGE_TILE_ROWS);
+    tileLumas.resize(CHANGE_TILE_COLUMNS * CHANGE_TILE_ROWS);
+    referenceLumas.resize(CHANGE_TILE_COLUMNS * CHANGE_TILE_ROWS);
+    hasReference.resize(CHANGE_TILE_COLUMNS * CHANGE_TILE_ROWS);
+    Reset();
+}
+
+/****************************************************************************
+			Description:	ChangeDetector destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ChangeDetector::~ChangeDetector()
+{
+}
+
+/****************************************************************************
+			Description:	Takes the mean luma of every tile of a BGR frame.
+							Luma is (B + 2G + R) / 4, which is close enough
+							to tell if anything moved. A new frame size
+							sets the tiles up again and forgets everything.
+
+			Arguments: 		CONST MAT&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ChangeDetector::Measure(const Mat &frame)
+{
+    CV_Assert(frame.type() == CV_8UC3);
+
+    // Cut the new frame size into tiles.
+    if (frame.size() != frameSize)
+    {
+        Reset();
+        frameSize = frame.size();
+        for (int row = 0; row < CHANGE_TILE_ROWS; row++)
+        {
+            for (int column = 0; column < CHANGE_TILE_COLUMNS; column++)
+            {
+                Point topLeft(column * frameSize.width / CHANGE_TILE_COLUMNS, row * frameSize.height / CHANGE_TILE_ROWS);
+                Point bottomRight((column + 1) * frameSize.width / CHANGE_TILE_COLUMNS, (row + 1) * frameSize.height / CHANGE_TILE_ROWS);
+                tiles[row * CHANGE_TILE_COLUMNS + column] = Rect(topLeft, bottomRight);
+            }
+        }
+    }
+
+    // Sample each tile.
+    for (int i = 0; i < int(tiles.size()); i++)
+    {
+        const Rect &tile = tiles[i];
+        int sum = 0;
+        int count = 0;
+        for (int y = tile.y; y < tile.y + tile.height; y += CHANGE_SAMPLE_STEP)
+        {
+            const uint8_t* row = frame.ptr<uint8_t>(y);
+            for (int x = tile.x; x < tile.x + tile.width; x += CHANGE_SAMPLE_STEP)
+            {
+                const uint8_t* pixel = row + 3 * x;
+                sum += pixel[0] + 2 * pixel[1] + pixel[2];
+                count++;
+            }
+        }
+        tileLumas[i] = (count > 0) ? float(sum) / (4 * count) : 0.0f;
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the box around every tile that has changed
+							since it was last searched, or was never
+							searched.
+
+			Arguments: 		None
+
+			Returns: 		RECT (empty if nothing changed)
+****************************************************************************/
+Rect ChangeDetector::GetChangedRegion()
+{
+    // Create instance variables.
+    Rect region;
+
+    for (int i = 0; i < int(tiles.size()); i++)
+    {
+        if (!hasReference[i] || fabs(tileLumas[i] - referenceLumas[i]) > CHANGE_THRESHOLD)
+        {
+            region |= tiles[i];
+        }
+    }
+
+    return region;
+}
+
+/****************************************************************************
+			Description:	Records that a region of the last frame measured
+							was searched. Only the tiles it covers all of
+							are counted as searched.
+
+			Arguments: 		CONST RECT&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ChangeDetector::MarkSearched(const Rect &region)
+{
+    for (int i = 0; i < int(tiles.size()); i++)
+    {
+        if ((tiles[i] & region) == tiles[i])
+        {
+            referenceLumas[i] = tileLumas[i];
+            hasReference[i] = 1;
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Forgets every tile, so the next frame has changed
+							everywhere.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void ChangeDetector::Reset()
+{
+    fill(hasReference.begin(), hasReference.end(), 0);
+    frameSize = Size();
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,665 @@
+/****************************************************************************
+		Description:	Implements the ColorLabeler Class.
+
+		Classes:		ColorLabeler
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/ColorLabeler.h"
+#include "../Headers/ThreadPool.h"
+#include "../Headers/Tracer.h"
+
+#include <cstring>
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Converts one BGR pixel to 8-bit HSV with the same
+							fixed point math cvtColor uses, so the table
+							agrees with the old cvtColor + inRange path.
+
+			Arguments: 		INT (x3), INT& (x3)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void ConvertBGRToHSV(int blue, int green, int red, int &hue, int &saturation, int &value)
+{
+    // Create instance variables.
+    const int shift = 12;
+    int maxValue = max(blue, max(green, red));
+    int minValue = min(blue, min(green, red));
+    int difference = maxValue - minValue;
+
+    // Saturation and value.
+    value = maxValue;
+    saturation = (maxValue == 0) ? 0 : (difference * cvRound((255 << shift) / double(maxValue)) + (1 << (shift - 1))) >> shift;
+
+    // Hue, in OpenCV's 0-180 range.
+    int hueOffset = 0;
+    if (maxValue == red)
+    {
+        hueOffset = green - blue;
+    }
+    else if (maxValue == green)
+    {
+        hueOffset = blue - red + 2 * difference;
+    }
+    else
+    {
+        hueOffset = red - green + 4 * difference;
+    }
+    int hueScale = (difference == 0) ? 0 : cvRound((180 << shift) / (6.0 * difference));
+    hue = (hueOffset * hueScale + (1 << (shift - 1))) >> shift;
+    if (hue < 0)
+    {
+        hue += 180;
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the table index of a BGR pixel.
+
+			Arguments: 		CONST UINT8_T*
+
+			Returns: 		INT
+****************************************************************************/
+static inline int GetColorTableIndex(const uint8_t* pixel)
+{
+    const int dropBits = 8 - COLOR_TABLE_BITS;
+    return ((pixel[0] >> dropBits) << (2 * COLOR_TABLE_BITS)) | ((pixel[1] >> dropBits) << COLOR_TABLE_BITS) | (pixel[2] >> dropBits);
+}
+
+/****************************************************************************
+			Description:	Looks up the color bits of one row of BGR pixels.
+
+			Arguments: 		CONST UINT8_T*, UINT8_T*, INT, CONST UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void LabelRow(const uint8_t* BGRRow, uint8_t* labelRow, int width, const uint8_t* colorTable)
+{
+    for (int x = 0; x < width; x++)
+    {
+        labelRow[x] = colorTable[GetColorTableIndex(BGRRow)];
+        BGRRow += 3;
+    }
+}
+
+/****************************************************************************
+			Description:	Writes 255 for every pixel in a row that matches
+							any color and 0 for the rest.
+
+			Arguments: 		CONST UINT8_T*, UINT8_T*, INT, CONST UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void MaskRow(const uint8_t* BGRRow, uint8_t* maskRow, int width, const uint8_t* colorTable)
+{
+    for (int x = 0; x < width; x++)
+    {
+        maskRow[x] = colorTable[GetColorTableIndex(BGRRow)] ? 255 : 0;
+        BGRRow += 3;
+    }
+}
+
+/****************************************************************************
+			Description:	Sets the bit of every pixel in a row that matches
+							any color, straight into packed words.
+
+			Arguments: 		CONST UINT8_T*, UINT64_T*, INT, CONST UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void MaskBitsRow(const uint8_t* BGRRow, uint64_t* words, int width, const uint8_t* colorTable)
+{
+    for (int x = 0; x < width; x += MASK_WORD_PIXELS)
+    {
+        uint64_t word = 0;
+        int count = min(width - x, MASK_WORD_PIXELS);
+        for (int i = 0; i < count; i++)
+        {
+            word |= uint64_t(colorTable[GetColorTableIndex(BGRRow)] != 0) << i;
+            BGRRow += 3;
+        }
+        words[x / MASK_WORD_PIXELS] = word;
+    }
+}
+
+/****************************************************************************
+			Description:	Blurs one row of a BGR image into a row buffer,
+							reflecting rows past the top and bottom edges the
+							same as VisionKernels::BoxBlur3x3.
+
+			Arguments: 		CONST MAT&, INT, UINT8_T*, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+static void BlurSourceRow(const Mat &BGRImg, int y, uint8_t* blurRow, const KernelSet &kernels)
+{
+    int height = BGRImg.rows;
+    int aboveY = (y > 0) ? y - 1 : min(1, height - 1);
+    int belowY = (y < height - 1) ? y + 1 : max(height - 2, 0);
+    kernels.BoxBlur3x3Row(BGRImg.ptr<uint8_t>(aboveY), BGRImg.ptr<uint8_t>(y), BGRImg.ptr<uint8_t>(belowY), blurRow, BGRImg.cols, 3);
+}
+
+/****************************************************************************
+			Description:	Gets a row and its neighbours out of a ring of
+							BAND_RING_ROWS rows. A missing neighbour past the
+							edge of the image is replaced by the row itself,
+							which can't change a min, max or OR.
+
+			Arguments: 		CONST MAT&, INT, INT, CONST UINT8_T*& (x3)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void GetRingRows(const Mat &ringImg, int y, int height, const uint8_t* &aboveRow, const uint8_t* &row, const uint8_t* &belowRow)
+{
+    row = ringImg.ptr<uint8_t>(y % BAND_RING_ROWS);
+    aboveRow = (y > 0) ? ringImg.ptr<uint8_t>((y - 1) % BAND_RING_ROWS) : row;
+    belowRow = (y < height - 1) ? ringImg.ptr<uint8_t>((y + 1) % BAND_RING_ROWS) : row;
+}
+
+/****************************************************************************
+			Description:	Adds one row of the dilated label image to the
+							per-color pixel counts and bounds. Tape is a small
+							part of the frame, so empty stretches are skipped
+							eight pixels at a time.
+
+			Arguments: 		CONST UINT8_T*, INT, INT, INT* (x5)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AccumulateRow(const uint8_t* labelRow, int y, int width, int* pixelCounts, int* minX, int* minY, int* maxX, int* maxY)
+{
+    int x = 0;
+    while (x < width)
+    {
+        // Skip empty blocks.
+        if (x + 8 <= width)
+        {
+            uint64_t block;
+            memcpy(&block, labelRow + x, sizeof(block));
+            if (block == 0)
+            {
+                x += 8;
+                continue;
+            }
+        }
+
+        // Count every color the pixel belongs to.
+        unsigned int label = labelRow[x];
+        while (label != 0)
+        {
+            int color = __builtin_ctz(label);
+            label &= label - 1;
+            pixelCounts[color]++;
+            minX[color] = min(minX[color], x);
+            maxX[color] = max(maxX[color], x);
+            minY[color] = min(minY[color], y);
+            maxY[color] = max(maxY[color], y);
+        }
+        x++;
+    }
+}
+
+
+/****************************************************************************
+			Description:	ColorLabeler constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ColorLabeler::ColorLabeler()
+{
+    // Initialize member variables. With no colors every pixel is unlabeled.
+    colorTable.assign(COLOR_TABLE_SIZE, 0);
+}
+
+/****************************************************************************
+			Description:	ColorLabeler destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ColorLabeler::~ColorLabeler()
+{
+
+}
+
+/****************************************************************************
+			Description:	Sets the colors to look for. Each range is
+							(lower HSV, upper HSV, ...) with inclusive bounds,
+							the same as inRange. Colors past MAX_LABEL_COLORS
+							are ignored. The table is only rebuilt if the
+							ranges changed, so this is cheap to call every
+							frame.
+
+			Arguments: 		CONST VECTOR<VECTOR<SCALAR>>&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::SetColorRanges(const vector<vector<Scalar>> &colorRanges)
+{
+    // Check if anything changed.
+    int colorCount = min(int(colorRanges.size()), MAX_LABEL_COLORS);
+    bool isChanged = (colorCount != int(lowerBounds.size()));
+    for (int i = 0; i < colorCount && !isChanged; i++)
+    {
+        isChanged = (colorRanges[i][0] != lowerBounds[i] || colorRanges[i][1] != upperBounds[i]);
+    }
+    if (!isChanged)
+    {
+        return;
+    }
+
+    // Store the new ranges and rebuild.
+    lowerBounds.clear();
+    upperBounds.clear();
+    for (int i = 0; i < colorCount; i++)
+    {
+        lowerBounds.emplace_back(colorRanges[i][0]);
+        upperBounds.emplace_back(colorRanges[i][1]);
+    }
+    BuildColorTable();
+}
+
+/****************************************************************************
+			Description:	Sets a single color to look for, such as the
+							trackbar range. The table is only rebuilt if the
+							range changed.
+
+			Arguments: 		CONST SCALAR&, CONST SCALAR&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::SetColorRange(const Scalar &lower, const Scalar &upper)
+{
+    // Check if anything changed.
+    if (lowerBounds.size() == 1 && lowerBounds[0] == lower && upperBounds[0] == upper)
+    {
+        return;
+    }
+
+    // Store the new range and rebuild.
+    lowerBounds.assign(1, lower);
+    upperBounds.assign(1, upper);
+    BuildColorTable();
+}
+
+/****************************************************************************
+			Description:	Blurs, thresholds, erodes and dilates a CV_8UC3
+							BGR image into a CV_8UC1 0/255 mask. The result is
+							the same as BoxBlur3x3 -> MaskImage -> ErodeCross
+							-> DilateCross, but streamed a row at a time so
+							only the mask is written to memory. The frame is
+							split into row stripes that run on the thread
+							pool at the same time.
+
+			Arguments: 		CONST MAT&, MAT&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::FilterImage(const Mat &BGRImg, Mat &maskImg)
+{
+    CV_Assert(BGRImg.data != maskImg.data);
+
+    // Each stripe unpacks its rows as soon as they're done, while they're still in cache.
+    maskImg.create(BGRImg.rows, BGRImg.cols, CV_8UC1);
+    FilterStripes(BGRImg, filterMask, &maskImg);
+}
+
+/****************************************************************************
+			Description:	Blurs, thresholds, erodes and dilates a BGR image
+							into a bit mask, without ever making a byte mask.
+
+			Arguments: 		CONST MAT&, BITMASK&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::FilterImage(const Mat &BGRImg, BitMask &mask)
+{
+    FilterStripes(BGRImg, mask, nullptr);
+}
+
+/****************************************************************************
+			Description:	Blurs, classifies and dilates a CV_8UC3 BGR image
+							into a CV_8UC1 image holding one bit per color,
+							and gathers each color's pixel count and bounds.
+							Streamed and split into stripes like FilterImage.
+
+			Arguments: 		CONST MAT&, MAT&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::LabelImage(const Mat &BGRImg, Mat &labelImg)
+{
+    CV_Assert(BGRImg.type() == CV_8UC3 && BGRImg.data != labelImg.data);
+
+    // Create instance variables.
+    int width = BGRImg.cols;
+    int height = BGRImg.rows;
+    int colorCount = int(lowerBounds.size());
+    int stripeCount = GetStripeCount(height);
+    labelImg.create(height, width, CV_8UC1);
+    blurRows.resize(size_t(stripeCount) * width * 3);
+    // The ring only grows, so labelling a smaller part of the frame reuses it.
+    if (labelRingImg.rows < stripeCount * BAND_RING_ROWS || labelRingImg.cols < width)
+    {
+        labelRingImg.create(max(labelRingImg.rows, stripeCount * BAND_RING_ROWS), max(labelRingImg.cols, width), CV_8UC1);
+    }
+    stripeStats.resize(stripeCount);
+
+    // Label the stripes at the same time, each gathering its own stats.
+    ThreadPool::Get().ParallelFor(stripeCount, [&](int stripe) {
+        TraceSpan stripeSpan("stripe");
+        LabelStripe(BGRImg, labelImg, stripe * height / stripeCount, (stripe + 1) * height / stripeCount, stripe);
+    });
+
+    // Merge the stripes' stats.
+    for (int i = 0; i < colorCount; i++)
+    {
+        int pixelCount = 0;
+        Point topLeft(width, height);
+        Point bottomRight(-1, -1);
+        for (int stripe = 0; stripe < stripeCount; stripe++)
+        {
+            const LabelStripeStats &stripeStat = stripeStats[stripe];
+            pixelCount += stripeStat.pixelCounts[i];
+            topLeft.x = min(topLeft.x, stripeStat.minX[i]);
+            topLeft.y = min(topLeft.y, stripeStat.minY[i]);
+            bottomRight.x = max(bottomRight.x, stripeStat.maxX[i]);
+            bottomRight.y = max(bottomRight.y, stripeStat.maxY[i]);
+        }
+
+        stats[i].pixelCount = pixelCount;
+        stats[i].bounds = (pixelCount > 0) ? Rect(topLeft, bottomRight + Point(1, 1)) : Rect();
+    }
+}
+
+/****************************************************************************
+			Description:	Classifies a CV_8UC3 BGR image into a CV_8UC1 mask
+							that is 255 wherever a pixel matches any color.
+							This replaces cvtColor + inRange for a single
+							range.
+
+			Arguments: 		CONST MAT&, MAT&
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::MaskImage(const Mat &BGRImg, Mat &maskImg)
+{
+    CV_Assert(BGRImg.type() == CV_8UC3);
+
+    maskImg.create(BGRImg.rows, BGRImg.cols, CV_8UC1);
+    for (int y = 0; y < BGRImg.rows; y++)
+    {
+        MaskRow(BGRImg.ptr<uint8_t>(y), maskImg.ptr<uint8_t>(y), BGRImg.cols, colorTable.data());
+    }
+}
+
+/****************************************************************************
+			Description:	Pulls one color's binary mask out of the label
+							image, cropped to the bounds from the last
+							LabelImage call. maskImg is kept the size of the
+							whole label image so its memory is reused from
+							frame to frame, and only the part inside the
+							bounds is written and returned. Pass the bounds'
+							top left corner as the findContours offset to get
+							frame coordinates back.
+
+							If LabelImage was given just part of labelImg,
+							pass where that part starts as the offset, and
+							add it to the findContours offset too.
+
+			Arguments: 		CONST MAT&, INT, MAT&, POINT
+
+			Returns: 		MAT (the color's mask, a view into maskImg)
+****************************************************************************/
+Mat ColorLabeler::GetColorMask(const Mat &labelImg, int colorIndex, Mat &maskImg, Point offset)
+{
+    // Create instance variables.
+    Rect bounds = stats[colorIndex].bounds + offset;
+    uint8_t bit = uint8_t(1 << colorIndex);
+    maskImg.create(labelImg.size(), CV_8UC1);
+    Mat colorMaskImg = maskImg(bounds);
+
+    // Expand the color's bit into a 0/255 mask.
+    for (int y = 0; y < bounds.height; y++)
+    {
+        const uint8_t* labelRow = labelImg.ptr<uint8_t>(bounds.y + y) + bounds.x;
+        uint8_t* maskRow = colorMaskImg.ptr<uint8_t>(y);
+        for (int x = 0; x < bounds.width; x++)
+        {
+            maskRow[x] = (labelRow[x] & bit) ? 255 : 0;
+        }
+    }
+
+    return colorMaskImg;
+}
+
+/****************************************************************************
+			Description:	Gets the per-color stats from the last LabelImage
+							call, in the same order as the color ranges.
+
+			Arguments: 		None
+
+			Returns: 		CONST VECTOR<LABELSTATS>&
+****************************************************************************/
+const vector<LabelStats>& ColorLabeler::GetStats()
+{
+    return stats;
+}
+
+/****************************************************************************
+			Description:	Gets how many stripes to split an image into. One
+							per pool thread, but no thinner than
+							MIN_STRIPE_ROWS so the halo rows stay cheap.
+
+			Arguments: 		INT
+
+			Returns: 		INT
+****************************************************************************/
+int ColorLabeler::GetStripeCount(int height)
+{
+    return max(1, min(ThreadPool::Get().GetThreadCount(), height / MIN_STRIPE_ROWS));
+}
+
+/****************************************************************************
+			Description:	Runs the filter chain over row stripes of the
+							image on the ThreadPool, optionally unpacking
+							each finished row into a byte mask as well.
+
+			Arguments: 		CONST MAT&, BITMASK&, MAT* (or nullptr)
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::FilterStripes(const Mat &BGRImg, BitMask &mask, Mat* maskImg)
+{
+    CV_Assert(BGRImg.type() == CV_8UC3);
+
+    // Create instance variables.
+    int width = BGRImg.cols;
+    int height = BGRImg.rows;
+    int stripeCount = GetStripeCount(height);
+    mask.Create(width, height);
+    blurRows.resize(size_t(stripeCount) * width * 3);
+    maskRingWords.resize(size_t(stripeCount) * BAND_RING_ROWS * mask.GetWordsPerRow());
+    erodeRingWords.resize(size_t(stripeCount) * BAND_RING_ROWS * mask.GetWordsPerRow());
+
+    // Every stripe has its own rings and writes only its own rows of the mask, so the stripes never share memory they write.
+    ThreadPool::Get().ParallelFor(stripeCount, [&](int stripe) {
+        TraceSpan stripeSpan("stripe");
+        FilterStripe(BGRImg, mask, maskImg, stripe * height / stripeCount, (stripe + 1) * height / stripeCount, stripe);
+    });
+}
+
+/****************************************************************************
+			Description:	Runs the FilterImage chain for rows firstRow to
+							lastRow - 1 of the mask. The erode and dilate each
+							reach one row past the row they make, so the
+							threshold starts two rows and the erode one row
+							outside the stripe. Those halo rows are redone by
+							the neighbouring stripe but never written out.
+
+			Arguments: 		CONST MAT&, BITMASK&, MAT* (or nullptr), INT, INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::FilterStripe(const Mat &BGRImg, BitMask &mask, Mat* maskImg, int firstRow, int lastRow, int stripe)
+{
+    // Create instance variables.
+    int width = BGRImg.cols;
+    int height = BGRImg.rows;
+    int wordsPerRow = mask.GetWordsPerRow();
+    const KernelSet &kernels = VisionKernels::Get();
+    const uint64_t* aboveWords;
+    const uint64_t* words;
+    const uint64_t* belowWords;
+    uint8_t* blurRow = &blurRows[size_t(stripe) * width * 3];
+    uint64_t* maskRing = &maskRingWords[size_t(stripe) * BAND_RING_ROWS * wordsPerRow];
+    uint64_t* erodeRing = &erodeRingWords[size_t(stripe) * BAND_RING_ROWS * wordsPerRow];
+    int maskLastRow = min(lastRow + 2, height);
+    int erodeFirstRow = max(firstRow - 1, 0);
+    int erodeLastRow = min(lastRow + 1, height);
+
+    // Every stage runs one row behind the stage it reads from, so it only needs the rows still in that stage's ring.
+    for (int y = max(firstRow - 2, 0); y < lastRow + 2; y++)
+    {
+        // Blur and threshold row y.
+        if (y < maskLastRow)
+        {
+            BlurSourceRow(BGRImg, y, blurRow, kernels);
+            MaskBitsRow(blurRow, maskRing + (y % BAND_RING_ROWS) * wordsPerRow, width, colorTable.data());
+        }
+
+        // Erode row y - 1 now that the mask row below it exists.
+        int erodeY = y - 1;
+        if (erodeY >= erodeFirstRow && erodeY < erodeLastRow)
+        {
+            GetRingWords(maskRing, wordsPerRow, erodeY, height, aboveWords, words, belowWords);
+            kernels.ErodeBitsRow(aboveWords, words, belowWords, erodeRing + (erodeY % BAND_RING_ROWS) * wordsPerRow, width);
+        }
+
+        // Dilate row y - 2 straight into the output.
+        int dilateY = y - 2;
+        if (dilateY >= firstRow && dilateY < lastRow)
+        {
+            GetRingWords(erodeRing, wordsPerRow, dilateY, height, aboveWords, words, belowWords);
+            kernels.DilateBitsRow(aboveWords, words, belowWords, mask.GetRow(dilateY), width);
+            if (maskImg != nullptr)
+            {
+                kernels.UnpackMaskRow(mask.GetRow(dilateY), width, maskImg->ptr<uint8_t>(dilateY));
+            }
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Runs the LabelImage chain for rows firstRow to
+							lastRow - 1 of the label image, classifying one
+							halo row past each end of the stripe, and
+							gathers the stripe's stats.
+
+			Arguments: 		CONST MAT&, MAT&, INT, INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::LabelStripe(const Mat &BGRImg, Mat &labelImg, int firstRow, int lastRow, int stripe)
+{
+    // Create instance variables.
+    int width = BGRImg.cols;
+    int height = BGRImg.rows;
+    const KernelSet &kernels = VisionKernels::Get();
+    const uint8_t* aboveRow;
+    const uint8_t* row;
+    const uint8_t* belowRow;
+    uint8_t* blurRow = &blurRows[size_t(stripe) * width * 3];
+    Mat labelRing = labelRingImg(Rect(0, stripe * BAND_RING_ROWS, width, BAND_RING_ROWS));
+    int labelLastRow = min(lastRow + 1, height);
+    LabelStripeStats &stripeStat = stripeStats[stripe];
+    for (int i = 0; i < MAX_LABEL_COLORS; i++)
+    {
+        stripeStat.pixelCounts[i] = 0;
+        stripeStat.minX[i] = width;
+        stripeStat.minY[i] = height;
+        stripeStat.maxX[i] = -1;
+        stripeStat.maxY[i] = -1;
+    }
+
+    for (int y = max(firstRow - 1, 0); y < lastRow + 1; y++)
+    {
+        // Blur and classify row y once, no matter how many colors there are.
+        if (y < labelLastRow)
+        {
+            BlurSourceRow(BGRImg, y, blurRow, kernels);
+            LabelRow(blurRow, labelRing.ptr<uint8_t>(y % BAND_RING_ROWS), width, colorTable.data());
+        }
+
+        // Dilate all of the colors of row y - 1 together and gather their stats from the finished row.
+        int dilateY = y - 1;
+        if (dilateY >= firstRow && dilateY < lastRow)
+        {
+            GetRingRows(labelRing, dilateY, height, aboveRow, row, belowRow);
+            kernels.DilateLabelsRow(aboveRow, row, belowRow, labelImg.ptr<uint8_t>(dilateY), width);
+            AccumulateRow(labelImg.ptr<uint8_t>(dilateY), dilateY, width, stripeStat.pixelCounts, stripeStat.minX, stripeStat.minY, stripeStat.maxX, stripeStat.maxY);
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Fills the BGR table. Every cell is classified by
+							the HSV of the color at its center.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void ColorLabeler::BuildColorTable()
+{
+    // Create instance variables.
+    const int cellsPerChannel = 1 << COLOR_TABLE_BITS;
+    const int cellSize = 256 / cellsPerChannel;
+    int colorCount = int(lowerBounds.size());
+
+    // Round the bounds the same way inRange does.
+    int lower[MAX_LABEL_COLORS][3];
+    int upper[MAX_LABEL_COLORS][3];
+    for (int i = 0; i < colorCount; i++)
+    {
+        for (int channel = 0; channel < 3; channel++)
+        {
+            lower[i][channel] = cvRound(lowerBounds[i][channel]);
+            upper[i][channel] = cvRound(upperBounds[i][channel]);
+        }
+    }
+
+    // Classify the center of every cell.
+    for (int blue = 0; blue < cellsPerChannel; blue++)
+    {
+        for (int green = 0; green < cellsPerChannel; green++)
+        {
+            for (int red = 0; red < cellsPerChannel; red++)
+            {
+                int hsv[3];
+                ConvertBGRToHSV(blue * cellSize + cellSize / 2, green * cellSize + cellSize / 2, red * cellSize + cellSize / 2, hsv[0], hsv[1], hsv[2]);
+
+                uint8_t label = 0;
+                for (int i = 0; i < colorCount; i++)
+                {
+                    if (hsv[0] >= lower[i][0] && hsv[0] <= upper[i][0] && hsv[1] >= lower[i][1] && hsv[1] <= upper[i][1] && hsv[2] >= lower[i][2] && hsv[2] <= upper[i][2])
+                    {
+                        label |= uint8_t(1 << i);
+                    }
+                }
+                colorTable[(blue << (2 * COLOR_TABLE_BITS)) | (green << COLOR_TABLE_BITS) | red] = label;
+            }
+        }
+    }
+
+    stats.assign(colorCount, LabelStats());
+}
+///////////////////////////////////////////////////////////////////////////////
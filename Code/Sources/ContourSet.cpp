@@ -0,0 +1,287 @@
+/****************************************************************************
+		Description:	Implements the ContourSet Class.
+
+		Classes:		ContourSet
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/ContourSet.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	ContourSet constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ContourSet::ContourSet()
+{
+    // Initialize member variables.
+    count = 0;
+
+    // Reserve the metric arrays up front, so finding contours doesn't allocate once running.
+    cached.reserve(MAX_TRACKED_CONTOURS);
+    bounds.reserve(MAX_TRACKED_CONTOURS);
+    areas.reserve(MAX_TRACKED_CONTOURS);
+    moments.reserve(MAX_TRACKED_CONTOURS);
+    hulls.reserve(MAX_TRACKED_CONTOURS);
+    hullAreas.reserve(MAX_TRACKED_CONTOURS);
+}
+
+/****************************************************************************
+			Description:	ContourSet destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ContourSet::~ContourSet()
+{
+}
+
+/****************************************************************************
+			Description:	Finds the outer contours of a mask and forgets
+							the metrics of the last ones.
+
+							A mask shrunk down a pyramid level can give its
+							scale, and every point is multiplied by it before
+							the offset is added. The metrics are then all in
+							full size pixels.
+
+			Arguments: 		CONST MAT&, POINT (added to every point), INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void ContourSet::Find(const Mat &maskImg, Point offset, int scale)
+{
+    // OpenCV allocates inside findContours no matter what buffers it gets.
+    {
+        LibraryAllocations libraryAllocations;
+        findContours(maskImg, points, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE, (scale == 1) ? offset : Point());
+    }
+    count = int(points.size());
+
+    // Scale the points back up to the full size frame.
+    if (scale != 1)
+    {
+        for (vector<Point> &contour : points)
+        {
+            for (Point &point : contour)
+            {
+                point = point * scale + offset;
+            }
+        }
+    }
+
+    // Nothing is cached yet. The arrays only ever grow, so hulls keep their memory.
+    cached.assign(count, 0);
+    if (int(bounds.size()) < count)
+    {
+        bounds.resize(count);
+        areas.resize(count);
+        moments.resize(count);
+        hulls.resize(count);
+        hullAreas.resize(count);
+    }
+}
+
+/****************************************************************************
+			Description:	Empties the set without finding anything.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void ContourSet::Clear()
+{
+    count = 0;
+}
+
+/****************************************************************************
+			Description:	Gets how many contours the last Find found.
+
+			Arguments: 		None
+
+			Returns: 		INT
+****************************************************************************/
+int ContourSet::GetCount()
+{
+    return count;
+}
+
+/****************************************************************************
+			Description:	Gets the points of a contour.
+
+			Arguments: 		INT
+
+			Returns: 		CONST VECTOR<POINT>&
+****************************************************************************/
+const vector<Point>& ContourSet::GetPoints(int index)
+{
+    return points[index];
+}
+
+/****************************************************************************
+			Description:	Gets the upright bounding box of a contour.
+
+			Arguments: 		INT
+
+			Returns: 		CONST RECT&
+****************************************************************************/
+const Rect& ContourSet::GetBounds(int index)
+{
+    if (!(cached[index] & BOUNDS_CACHED))
+    {
+        bounds[index] = boundingRect(points[index]);
+        cached[index] |= BOUNDS_CACHED;
+    }
+
+    return bounds[index];
+}
+
+/****************************************************************************
+			Description:	Gets the area inside a contour.
+
+			Arguments: 		INT
+
+			Returns: 		DOUBLE
+****************************************************************************/
+double ContourSet::GetArea(int index)
+{
+    if (!(cached[index] & AREA_CACHED))
+    {
+        areas[index] = contourArea(points[index]);
+        cached[index] |= AREA_CACHED;
+    }
+
+    return areas[index];
+}
+
+/****************************************************************************
+			Description:	Gets the moments of a contour.
+
+			Arguments: 		INT
+
+			Returns: 		CONST MOMENTS&
+****************************************************************************/
+const Moments& ContourSet::GetMoments(int index)
+{
+    if (!(cached[index] & MOMENTS_CACHED))
+    {
+        moments[index] = cv::moments(points[index], true);
+        cached[index] |= MOMENTS_CACHED;
+    }
+
+    return moments[index];
+}
+
+/****************************************************************************
+			Description:	Gets the convex hull of a contour.
+
+			Arguments: 		INT
+
+			Returns: 		CONST VECTOR<POINT>&
+****************************************************************************/
+const vector<Point>& ContourSet::GetHull(int index)
+{
+    if (!(cached[index] & HULL_CACHED))
+    {
+        LibraryAllocations libraryAllocations;
+        convexHull(points[index], hulls[index]);
+        cached[index] |= HULL_CACHED;
+    }
+
+    return hulls[index];
+}
+
+/****************************************************************************
+			Description:	Gets the area inside the convex hull of a contour.
+
+			Arguments: 		INT
+
+			Returns: 		DOUBLE
+****************************************************************************/
+double ContourSet::GetHullArea(int index)
+{
+    if (!(cached[index] & HULL_AREA_CACHED))
+    {
+        hullAreas[index] = contourArea(GetHull(index));
+        cached[index] |= HULL_AREA_CACHED;
+    }
+
+    return hullAreas[index];
+}
+
+/****************************************************************************
+			Description:	Checks if the area of a contour is within limits,
+							ruling it out by its bounding box first.
+
+			Arguments: 		INT, DOUBLE, DOUBLE
+
+			Returns: 		BOOL
+****************************************************************************/
+bool ContourSet::IsAreaInRange(int index, double minArea, double maxArea)
+{
+    // The contour can't cover more than its box.
+    if (GetBounds(index).area() < minArea)
+    {
+        return false;
+    }
+
+    double area = GetArea(index);
+    return area >= minArea && area <= maxArea;
+}
+
+/****************************************************************************
+			Description:	Checks if the area of a contour's convex hull is
+							within limits. The hull is only built if the box
+							and the contour's own area can't rule it out.
+
+			Arguments: 		INT, DOUBLE, DOUBLE
+
+			Returns: 		BOOL
+****************************************************************************/
+bool ContourSet::IsHullAreaInRange(int index, double minArea, double maxArea)
+{
+    // The hull can't cover more than the box, or less than the contour.
+    if (GetBounds(index).area() < minArea || GetArea(index) > maxArea)
+    {
+        return false;
+    }
+
+    double hullArea = GetHullArea(index);
+    return hullArea >= minArea && hullArea <= maxArea;
+}
+
+/****************************************************************************
+			Description:	Finds the contour with the biggest area within
+							limits. Contours whose box is no bigger than the
+							best area so far are skipped without measuring
+							them. Ties go to the first contour.
+
+			Arguments: 		DOUBLE, DOUBLE
+
+			Returns: 		INT (index of the contour, or -1 if none fit)
+****************************************************************************/
+int ContourSet::GetBiggest(double minArea, double maxArea)
+{
+    // Create instance variables.
+    int biggestIndex = -1;
+    double biggestArea = 0.0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if ((biggestIndex < 0 || GetBounds(i).area() > biggestArea) && IsAreaInRange(i, minArea, maxArea) && (biggestIndex < 0 || GetArea(i) > biggestArea))
+        {
+            biggestIndex = i;
+            biggestArea = GetArea(i);
+        }
+    }
+
+    return biggestIndex;
+}
+///////////////////////////////////////////////////////////////////////////////
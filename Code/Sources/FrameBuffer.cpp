@@ -0,0 +1,167 @@
+/****************************************************************************
+			Description:	Implements the FrameBuffer Class
+
+			Classes:		FrameBuffer
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#include "../Headers/FrameBuffer.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Description:	FrameBuffer constructor.
+
+        Arguments:		None
+
+        Derived From:	Nothing
+****************************************************************************/
+FrameBuffer::FrameBuffer()
+{
+    // Initialize member variables. Each thread owns one slot and the middle slot is shared.
+    backIndex                               = 0;
+    middleIndex                             = 1;
+    frontIndex                              = 2;
+    consumerWaiting                         = false;
+}
+
+/****************************************************************************
+        Description:	FrameBuffer destructor.
+
+        Arguments:		None
+
+        Derived From:	Nothing
+****************************************************************************/
+FrameBuffer::~FrameBuffer()
+{
+
+}
+
+/****************************************************************************
+        Description:	Gets the slot the producer thread is allowed to write
+                        into. Only call this from the producer thread.
+
+        Arguments: 		None
+
+        Returns: 		MAT&
+****************************************************************************/
+Mat& FrameBuffer::GetWriteBuffer()
+{
+    return slots[backIndex];
+}
+
+/****************************************************************************
+        Description:	Gets the metadata of the slot the producer thread is
+                        allowed to write into. Only call this from the
+                        producer thread.
+
+        Arguments: 		None
+
+        Returns: 		FRAMEMETA&
+****************************************************************************/
+FrameMeta& FrameBuffer::GetWriteMeta()
+{
+    return slotMeta[backIndex];
+}
+
+/****************************************************************************
+        Description:	Makes the frame in the write slot available to the
+                        consumer by swapping it with the middle slot. Only
+                        call this from the producer thread.
+
+        Arguments: 		None
+
+        Returns: 		Nothing
+****************************************************************************/
+void FrameBuffer::Publish()
+{
+    // Hand our finished slot to the middle and take back whatever was there. If the consumer never picked it up, that frame is simply overwritten next time.
+    uint8_t previous = middleIndex.exchange(backIndex | FRESH_FLAG);
+    backIndex = previous & INDEX_MASK;
+
+    // Only touch the mutex if the consumer is actually asleep waiting for us.
+    if (consumerWaiting.load())
+    {
+        lock_guard<mutex> guard(waitMutex);
+        frameReady.notify_one();
+    }
+}
+
+/****************************************************************************
+        Description:	Swaps the newest published frame into the read slot.
+                        Only call this from the consumer thread.
+
+        Arguments: 		None
+
+        Returns: 		BOOL (true if the read slot now holds a newer frame)
+****************************************************************************/
+bool FrameBuffer::Acquire()
+{
+    // Nothing new has been published since the last time we swapped.
+    if (!(middleIndex.load(memory_order_relaxed) & FRESH_FLAG))
+    {
+        return false;
+    }
+
+    // Take the newest frame and give our old read slot back to the middle.
+    uint8_t previous = middleIndex.exchange(frontIndex, memory_order_acq_rel);
+    frontIndex = previous & INDEX_MASK;
+
+    return true;
+}
+
+/****************************************************************************
+        Description:	Blocks the consumer thread until a frame newer than
+                        the one in its read slot has been published, or the
+                        timeout runs out. Only call this from the consumer
+                        thread.
+
+        Arguments: 		INT (timeout in milliseconds)
+
+        Returns: 		BOOL (true if a new frame is ready to acquire)
+****************************************************************************/
+bool FrameBuffer::WaitForFrame(int timeoutMS)
+{
+    // Don't bother sleeping if a new frame is already waiting.
+    if (middleIndex.load() & FRESH_FLAG)
+    {
+        return true;
+    }
+
+    // Tell the producer to wake us, then recheck under the lock so a frame published in between isn't missed.
+    consumerWaiting.store(true);
+    unique_lock<mutex> lock(waitMutex);
+    bool isReady = frameReady.wait_for(lock, chrono::milliseconds(timeoutMS), [this] { return (middleIndex.load() & FRESH_FLAG) != 0; });
+    consumerWaiting.store(false);
+
+    return isReady;
+}
+
+/****************************************************************************
+        Description:	Gets the slot the consumer thread is allowed to read
+                        from. Only call this from the consumer thread.
+
+        Arguments: 		None
+
+        Returns: 		MAT&
+****************************************************************************/
+Mat& FrameBuffer::GetReadBuffer()
+{
+    return slots[frontIndex];
+}
+
+/****************************************************************************
+        Description:	Gets the metadata of the frame in the read slot. Only
+                        call this from the consumer thread.
+
+        Arguments: 		None
+
+        Returns: 		FRAMEMETA& (sequence is 0 if no frame has been acquired yet)
+****************************************************************************/
+FrameMeta& FrameBuffer::GetReadMeta()
+{
+    return slotMeta[frontIndex];
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,403 @@
+/****************************************************************************
+			Description:	Implements the FrameSource Classes
+
+			Classes:		FrameSource, VideoFileSource, ImageDirectorySource,
+							SyntheticSource
+
+			Project:		MATE 2022
+
+			Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#include "../Headers/FrameSource.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+        Description:	FrameSource constructor.
+
+        Arguments:		None
+
+        Derived From:	Nothing
+****************************************************************************/
+FrameSource::FrameSource()
+{
+    // Initialize member variables.
+    startTime                               = chrono::steady_clock::now();
+    framesPaced                             = 0;
+    isPaced                                 = false;
+    isLooping                               = false;
+    isFinished                              = false;
+}
+
+/****************************************************************************
+        Description:	FrameSource destructor.
+
+        Arguments:		None
+
+        Derived From:	Nothing
+****************************************************************************/
+FrameSource::~FrameSource()
+{
+
+}
+
+/****************************************************************************
+        Description:	Gets if the source has run out of frames. Sources
+                        that loop never finish.
+
+        Arguments: 		None
+
+        Returns: 		BOOL
+****************************************************************************/
+bool FrameSource::GetIsFinished()
+{
+    return isFinished;
+}
+
+/****************************************************************************
+        Description:	Creates one of the file based or synthetic sources.
+                        Camera sources need the cscore sinks from main, so
+                        they are created there instead.
+
+        Arguments: 		INT (SourceType), STRING, BOOL, BOOL
+
+        Returns: 		FRAMESOURCE* (nullptr if the type isn't handled here)
+****************************************************************************/
+FrameSource* FrameSource::Create(int sourceType, string sourcePath, bool isPaced, bool isLooping)
+{
+    switch (sourceType)
+    {
+        case VIDEO_FILE_SOURCE:
+            return new VideoFileSource(sourcePath, isPaced, isLooping);
+        case IMAGE_DIRECTORY_SOURCE:
+            return new ImageDirectorySource(sourcePath, isPaced, isLooping);
+        case SYNTHETIC_SOURCE:
+            return new SyntheticSource(isPaced);
+        default:
+            return nullptr;
+    }
+}
+
+/****************************************************************************
+        Description:	Sleeps until the next frame is due when pacing is
+                        enabled, so files play back in real time. Frames are
+                        scheduled from the start time instead of the last
+                        frame so slow frames don't make playback drift.
+
+        Arguments: 		DOUBLE
+
+        Returns: 		Nothing
+****************************************************************************/
+void FrameSource::WaitForNextFrame(double framesPerSecond)
+{
+    // Unpaced sources deliver frames as fast as they can be read.
+    if (!isPaced || framesPerSecond <= 0)
+    {
+        return;
+    }
+
+    // Sleep until this frame's slot in the real time schedule.
+    chrono::duration<double> frameOffset(framesPaced / framesPerSecond);
+    this_thread::sleep_until(startTime + chrono::duration_cast<chrono::steady_clock::duration>(frameOffset));
+    framesPaced++;
+}
+
+
+/****************************************************************************
+        Description:	VideoFileSource constructor.
+
+        Arguments:		STRING, BOOL, BOOL
+
+        Derived From:	FrameSource
+****************************************************************************/
+VideoFileSource::VideoFileSource(string filePath, bool isPaced, bool isLooping)
+{
+    // Initialize member variables.
+    this->filePath                          = filePath;
+    this->isPaced                           = isPaced;
+    this->isLooping                         = isLooping;
+
+    // Open the video file and find out how fast it should play.
+    cap.open(filePath);
+    fileFPS = cap.get(CAP_PROP_FPS);
+    if (!cap.isOpened())
+    {
+        cout << "WARNING: Unable to open video file " << filePath << endl;
+        isFinished = true;
+    }
+}
+
+/****************************************************************************
+        Description:	VideoFileSource destructor.
+
+        Arguments:		None
+
+        Derived From:	FrameSource
+****************************************************************************/
+VideoFileSource::~VideoFileSource()
+{
+    cap.release();
+}
+
+/****************************************************************************
+        Description:	Reads the next frame from the file, rewinding to the
+                        start when looping is enabled.
+
+        Arguments: 		MAT&, FRAMEMETA&
+
+        Returns: 		BOOL (true if a frame was read)
+****************************************************************************/
+bool VideoFileSource::GrabFrame(Mat &frame, FrameMeta &frameMeta)
+{
+    // Nothing left to read.
+    if (isFinished)
+    {
+        return false;
+    }
+
+    // Hold the frame back until it is due if we are playing in real time.
+    WaitForNextFrame(fileFPS);
+
+    // Read the frame, rewinding once if we hit the end of the file.
+    bool success = cap.read(frame);
+    if (!success && isLooping)
+    {
+        cap.set(CAP_PROP_POS_FRAMES, 0);
+        success = cap.read(frame);
+    }
+
+    // Stop once the file runs out.
+    if (!success || frame.empty())
+    {
+        isFinished = true;
+        return false;
+    }
+
+    // Stamp the frame.
+    frameMeta.grabTime = wpi::Now();
+    return true;
+}
+
+/****************************************************************************
+        Description:	Gets a name describing the source.
+
+        Arguments: 		None
+
+        Returns: 		STRING
+****************************************************************************/
+string VideoFileSource::GetName()
+{
+    return "file:" + filePath;
+}
+
+
+/****************************************************************************
+        Description:	ImageDirectorySource constructor.
+
+        Arguments:		STRING, BOOL, BOOL
+
+        Derived From:	FrameSource
+****************************************************************************/
+ImageDirectorySource::ImageDirectorySource(string directoryPath, bool isPaced, bool isLooping)
+{
+    // Initialize member variables.
+    this->directoryPath                     = directoryPath;
+    this->isPaced                           = isPaced;
+    this->isLooping                         = isLooping;
+    imageIndex                              = 0;
+
+    // Find every file in the directory. glob returns them sorted by name.
+    vector<String> filePaths;
+    glob(directoryPath, filePaths, false);
+
+    // Keep everything OpenCV can read as an image, from its header alone, and skip everything else.
+    for (String filePath : filePaths)
+    {
+        if (haveImageReader(filePath))
+        {
+            imagePaths.emplace_back(filePath);
+        }
+    }
+
+    // Decode the first few up front. An image that fails to decode is dropped.
+    for (int i = 0; i < int(imagePaths.size()) && int(images.size()) < IMAGE_PRELOAD_LIMIT;)
+    {
+        Mat image = imread(imagePaths[i], IMREAD_COLOR);
+        if (image.empty())
+        {
+            imagePaths.erase(imagePaths.begin() + i);
+            continue;
+        }
+        images.emplace_back(image);
+        i++;
+    }
+
+    // Nothing to play.
+    if (imagePaths.empty())
+    {
+        cout << "WARNING: No images found in " << directoryPath << endl;
+        isFinished = true;
+    }
+}
+
+/****************************************************************************
+        Description:	ImageDirectorySource destructor.
+
+        Arguments:		None
+
+        Derived From:	FrameSource
+****************************************************************************/
+ImageDirectorySource::~ImageDirectorySource()
+{
+
+}
+
+/****************************************************************************
+        Description:	Copies the next image into the frame. Images past
+                        the preloaded ones are decoded before waiting for
+                        the frame to be due, so pacing stays on time.
+                        Images that fail to decode are skipped.
+
+        Arguments: 		MAT&, FRAMEMETA&
+
+        Returns: 		BOOL (true if a frame was produced)
+****************************************************************************/
+bool ImageDirectorySource::GrabFrame(Mat &frame, FrameMeta &frameMeta)
+{
+    // Create instance variables.
+    const Mat* image = nullptr;
+
+    while (!isFinished && image == nullptr)
+    {
+        // Wrap around to the first image, or stop, at the end of the directory.
+        if (imageIndex >= int(imagePaths.size()))
+        {
+            if (isLooping && !imagePaths.empty())
+            {
+                imageIndex = 0;
+            }
+            else
+            {
+                isFinished = true;
+                break;
+            }
+        }
+
+        // Use the preloaded image, or read the next one from disk.
+        if (imageIndex < int(images.size()))
+        {
+            image = &images[imageIndex];
+        }
+        else
+        {
+            streamImg = imread(imagePaths[imageIndex], IMREAD_COLOR);
+            image = streamImg.empty() ? nullptr : &streamImg;
+        }
+        imageIndex++;
+    }
+
+    // Nothing left to play.
+    if (isFinished)
+    {
+        return false;
+    }
+
+    // Play images back at the camera's frame rate when pacing.
+    WaitForNextFrame(SYNTHETIC_SOURCE_FPS);
+
+    // Copy the image so the pipeline can't modify our copy.
+    image->copyTo(frame);
+    frameMeta.grabTime = wpi::Now();
+    return true;
+}
+
+/****************************************************************************
+        Description:	Gets a name describing the source.
+
+        Arguments: 		None
+
+        Returns: 		STRING
+****************************************************************************/
+string ImageDirectorySource::GetName()
+{
+    return "images:" + directoryPath;
+}
+
+
+/****************************************************************************
+        Description:	SyntheticSource constructor.
+
+        Arguments:		BOOL
+
+        Derived From:	FrameSource
+****************************************************************************/
+SyntheticSource::SyntheticSource(bool isPaced)
+{
+    // Initialize member variables.
+    this->isPaced                           = isPaced;
+    this->isLooping                         = true;
+    frameIndex                              = 0;
+}
+
+/****************************************************************************
+        Description:	SyntheticSource destructor.
+
+        Arguments:		None
+
+        Derived From:	FrameSource
+****************************************************************************/
+SyntheticSource::~SyntheticSource()
+{
+
+}
+
+/****************************************************************************
+        Description:	Draws the next synthetic frame. The scene is a pair
+                        of vertical bars, a sweeping line, and a few colored
+                        boxes that all drift a little every frame.
+
+        Arguments: 		MAT&, FRAMEMETA&
+
+        Returns: 		BOOL (always true)
+****************************************************************************/
+bool SyntheticSource::GrabFrame(Mat &frame, FrameMeta &frameMeta)
+{
+    // Play at the camera's frame rate when pacing.
+    WaitForNextFrame(SYNTHETIC_SOURCE_FPS);
+
+    // Create instance variables.
+    int width = 640;
+    int height = 480;
+    int drift = int(40 * sin(frameIndex * 0.05));
+
+    // Draw the background.
+    frame.create(height, width, CV_8UC3);
+    frame.setTo(Scalar(60, 40, 20));
+
+    // Draw two tall bars, like the walls of a trench.
+    rectangle(frame, Rect(180 + drift, 40, 30, 400), Scalar(230, 120, 20), FILLED);
+    rectangle(frame, Rect(430 + drift, 40, 30, 400), Scalar(230, 120, 20), FILLED);
+    // Draw a sweeping line.
+    line(frame, Point(0, 240 + drift), Point(width, 200 - drift), Scalar(40, 220, 40), 12);
+    // Draw a few colored boxes.
+    rectangle(frame, Rect(60, 60 + drift, 50, 30), Scalar(0, 240, 255), FILLED);
+    rectangle(frame, Rect(520, 380 - drift, 50, 30), Scalar(255, 0, 195), FILLED);
+
+    // Stamp the frame.
+    frameIndex++;
+    frameMeta.grabTime = wpi::Now();
+    return true;
+}
+
+/****************************************************************************
+        Description:	Gets a name describing the source.
+
+        Arguments: 		None
+
+        Returns: 		STRING
+****************************************************************************/
+string SyntheticSource::GetName()
+{
+    return "synthetic";
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,312 @@
+/****************************************************************************
+		Description:	Implements the MatPool Class.
+
+		Classes:		MatPool
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/MatPool.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	MatPool constructor.
+
+			Arguments:		BOOL (lock pooled buffers into RAM)
+
+			Derived From:	MatAllocator
+****************************************************************************/
+MatPool::MatPool(bool lockMemory)
+{
+    // Initialize member variables.
+    for (int i = 0; i < MAT_POOL_CLASSES; i++)
+    {
+        freeLists[i] = nullptr;
+    }
+    cachedBytes = 0;
+    hitCount = 0;
+    missCount = 0;
+    isLocking = lockMemory;
+}
+
+/****************************************************************************
+			Description:	MatPool destructor.
+
+			Arguments:		None
+
+			Derived From:	MatAllocator
+****************************************************************************/
+MatPool::~MatPool()
+{
+    // Give every cached buffer back.
+    for (int i = 0; i < MAT_POOL_CLASSES; i++)
+    {
+        while (freeLists[i] != nullptr)
+        {
+            FreeBuffer* buffer = freeLists[i];
+            freeLists[i] = buffer->next;
+            free(buffer);
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the pool shared by the whole program.
+
+			Arguments: 		None
+
+			Returns: 		MATPOOL&
+****************************************************************************/
+MatPool& MatPool::Get()
+{
+    // Thread safe one time creation. Never destroyed, since Mats can outlive main.
+    static MatPool* pool = new MatPool([]() {
+        const char* requested = getenv("VISION_LOCK_POOL");
+        return requested != nullptr && atoi(requested) > 0;
+    }());
+    return *pool;
+}
+
+/****************************************************************************
+			Description:	Gets how often the pool could reuse a buffer.
+
+			Arguments: 		None
+
+			Returns: 		MATPOOLSTATS
+****************************************************************************/
+MatPoolStats MatPool::GetStats()
+{
+    // Create instance variables.
+    MatPoolStats stats;
+
+    stats.hits = hitCount.load(memory_order_relaxed);
+    stats.misses = missCount.load(memory_order_relaxed);
+    stats.isLocked = isLocking;
+    {
+        lock_guard<mutex> guard(poolMutex);
+        stats.cachedBytes = cachedBytes;
+    }
+
+    return stats;
+}
+
+/****************************************************************************
+			Description:	Allocates the buffer of a new Mat. Works out the
+							steps of a continuous buffer the same way
+							OpenCV's standard allocator does.
+
+			Arguments: 		INT, CONST INT*, INT, VOID*, SIZE_T*, ACCESSFLAG, UMATUSAGEFLAGS
+
+			Returns: 		UMATDATA*
+****************************************************************************/
+UMatData* MatPool::allocate(int dims, const int* sizes, int type, void* data, size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const
+{
+    // Memory someone else owns isn't ours to pool.
+    if (data != nullptr)
+    {
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    // Find the size of the buffer, and leave small ones to OpenCV.
+    size_t bytes = CV_ELEM_SIZE(type);
+    for (int i = 0; i < dims; i++)
+    {
+        bytes *= sizes[i];
+    }
+    if (bytes < (size_t(1) << MIN_POOLED_BITS))
+    {
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    // Rows are packed one after another.
+    if (step != nullptr)
+    {
+        size_t rowBytes = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--)
+        {
+            step[i] = rowBytes;
+            rowBytes *= sizes[i];
+        }
+    }
+
+    // Hand out a pooled buffer. The size class is kept with the Mat so it goes back on the right list.
+    int sizeClass = GetSizeClass(bytes);
+    UMatData* matData = new UMatData(this);
+    matData->data = matData->origdata = TakeBuffer(sizeClass, bytes);
+    matData->size = bytes;
+    matData->allocatorFlags_ = sizeClass;
+
+    return matData;
+}
+
+/****************************************************************************
+			Description:	Maps a buffer for use. CPU buffers always are.
+
+			Arguments: 		UMATDATA*, ACCESSFLAG, UMATUSAGEFLAGS
+
+			Returns: 		BOOL
+****************************************************************************/
+bool MatPool::allocate(UMatData* data, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+{
+    return data != nullptr;
+}
+
+/****************************************************************************
+			Description:	Puts the buffer of a released Mat back in the pool.
+
+			Arguments: 		UMATDATA*
+
+			Returns: 		Nothing
+****************************************************************************/
+void MatPool::deallocate(UMatData* data) const
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+
+    CV_Assert(data->urefcount == 0 && data->refcount == 0);
+    ReturnBuffer(data->origdata, data->allocatorFlags_, data->size);
+    delete data;
+}
+
+/****************************************************************************
+			Description:	Gets the size class of a buffer. There are
+							SIZE_CLASS_STEPS classes between each power of
+							two, and MAT_POOL_CLASSES means too big to pool.
+
+			Arguments: 		SIZE_T
+
+			Returns: 		INT
+****************************************************************************/
+int MatPool::GetSizeClass(size_t bytes)
+{
+    // Find the power of two at or below the size.
+    int bits = MIN_POOLED_BITS;
+    while (bits <= MAX_POOLED_BITS && (size_t(2) << bits) <= bytes)
+    {
+        bits++;
+    }
+
+    // Round up to the next step of that power of two. The last step rounds up into the next power.
+    size_t stepBytes = (size_t(1) << bits) / SIZE_CLASS_STEPS;
+    int steps = int((bytes + stepBytes - 1) / stepBytes) - SIZE_CLASS_STEPS;
+    if (steps == SIZE_CLASS_STEPS)
+    {
+        bits++;
+        steps = 0;
+    }
+
+    if (bits > MAX_POOLED_BITS)
+    {
+        return MAT_POOL_CLASSES;
+    }
+    return (bits - MIN_POOLED_BITS) * SIZE_CLASS_STEPS + steps;
+}
+
+/****************************************************************************
+			Description:	Gets how big the buffers of a size class are.
+							Buffers too big to pool are just rounded up to a
+							whole page.
+
+			Arguments: 		INT, SIZE_T
+
+			Returns: 		SIZE_T
+****************************************************************************/
+size_t MatPool::GetClassBytes(int sizeClass, size_t bytes)
+{
+    if (sizeClass == MAT_POOL_CLASSES)
+    {
+        return (bytes + MAT_POOL_PAGE_SIZE - 1) / MAT_POOL_PAGE_SIZE * MAT_POOL_PAGE_SIZE;
+    }
+
+    int bits = MIN_POOLED_BITS + sizeClass / SIZE_CLASS_STEPS;
+    return (size_t(1) << bits) / SIZE_CLASS_STEPS * (SIZE_CLASS_STEPS + sizeClass % SIZE_CLASS_STEPS);
+}
+
+/****************************************************************************
+			Description:	Takes a buffer off a size class's free list, or
+							makes a new one with its pages already mapped.
+
+			Arguments: 		INT, SIZE_T
+
+			Returns: 		UCHAR*
+****************************************************************************/
+uchar* MatPool::TakeBuffer(int sizeClass, size_t bytes) const
+{
+    // Reuse a free buffer if there is one.
+    if (sizeClass < MAT_POOL_CLASSES)
+    {
+        lock_guard<mutex> guard(poolMutex);
+        FreeBuffer* buffer = freeLists[sizeClass];
+        if (buffer != nullptr)
+        {
+            freeLists[sizeClass] = buffer->next;
+            cachedBytes -= GetClassBytes(sizeClass, bytes);
+            hitCount.fetch_add(1, memory_order_relaxed);
+            return reinterpret_cast<uchar*>(buffer);
+        }
+    }
+
+    // Make a new page aligned buffer.
+    missCount.fetch_add(1, memory_order_relaxed);
+    size_t classBytes = GetClassBytes(sizeClass, bytes);
+    void* buffer = aligned_alloc(MAT_POOL_PAGE_SIZE, classBytes);
+    if (buffer == nullptr)
+    {
+        throw bad_alloc();
+    }
+
+    // Fault every page in now, so the first frame written to it doesn't. Locking does the same.
+    if (isLocking && mlock(buffer, classBytes) != 0)
+    {
+        cout << "WARNING: Unable to lock Mat buffers into RAM (" << strerror(errno) << "). Raise RLIMIT_MEMLOCK to use VISION_LOCK_POOL." << endl;
+        isLocking = false;
+    }
+    if (!isLocking)
+    {
+        memset(buffer, 0, classBytes);
+    }
+
+    return static_cast<uchar*>(buffer);
+}
+
+/****************************************************************************
+			Description:	Puts a buffer back on its size class's free list,
+							or frees it if it's too big or the pool is full.
+
+			Arguments: 		UCHAR*, INT, SIZE_T
+
+			Returns: 		Nothing
+****************************************************************************/
+void MatPool::ReturnBuffer(uchar* buffer, int sizeClass, size_t bytes) const
+{
+    // Keep the buffer for the next Mat of its size.
+    size_t classBytes = GetClassBytes(sizeClass, bytes);
+    if (sizeClass < MAT_POOL_CLASSES)
+    {
+        lock_guard<mutex> guard(poolMutex);
+        if (cachedBytes + classBytes <= MAX_POOL_CACHED_BYTES)
+        {
+            FreeBuffer* freeBuffer = reinterpret_cast<FreeBuffer*>(buffer);
+            freeBuffer->next = freeLists[sizeClass];
+            freeLists[sizeClass] = freeBuffer;
+            cachedBytes += classBytes;
+            return;
+        }
+    }
+
+    // Unlocking a buffer that was never locked is harmless.
+    munlock(buffer, classBytes);
+    free(buffer);
+}
+///////////////////////////////////////////////////////////////////////////////
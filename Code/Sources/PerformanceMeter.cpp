@@ -0,0 +1,201 @@
+/****************************************************************************
+		Description:	Implements the PerformanceMeter Class.
+
+		Classes:		PerformanceMeter
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/PerformanceMeter.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	PerformanceMeter constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+PerformanceMeter::PerformanceMeter()
+{
+    // Initialize member variables. A negative tick means no frame has been counted yet.
+    startTime = chrono::steady_clock::now();
+    lastTickNanoseconds = -1;
+    smoothedInterval = 0.0;
+    frameCount = 0;
+    windowMaxLatency = 0.0;
+    previousWindowMaxLatency = 0.0;
+    windowSamples = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        latencyBuckets[i] = 0;
+    }
+}
+
+/****************************************************************************
+			Description:	PerformanceMeter destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+PerformanceMeter::~PerformanceMeter()
+{
+
+}
+
+/****************************************************************************
+			Description:	Counts one frame and folds the time since the last
+							frame into the smoothed frame interval.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void PerformanceMeter::Increment()
+{
+    // Get the time since the meter was created.
+    int64_t timeNow = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count();
+    int64_t lastTick = lastTickNanoseconds.load(memory_order_relaxed);
+
+    // Smooth the frame interval with an EWMA. The first interval seeds the average.
+    if (lastTick >= 0)
+    {
+        double interval = (timeNow - lastTick) / 1e9;
+        double smoothed = smoothedInterval.load(memory_order_relaxed);
+        smoothed = (smoothed <= 0.0) ? interval : smoothed + RATE_SMOOTHING * (interval - smoothed);
+        smoothedInterval.store(smoothed, memory_order_relaxed);
+    }
+
+    // Store the tick.
+    lastTickNanoseconds.store(timeNow, memory_order_relaxed);
+    frameCount.fetch_add(1, memory_order_relaxed);
+}
+
+/****************************************************************************
+			Description:	Adds a frame's latency to the histogram.
+
+			Arguments: 		DOUBLE (milliseconds)
+
+			Returns: 		Nothing
+****************************************************************************/
+void PerformanceMeter::RecordLatency(double milliseconds)
+{
+    // Find the bucket whose upper limit covers this latency.
+    int bucket = 0;
+    if (milliseconds > LATENCY_BUCKET_START)
+    {
+        bucket = int(ceil(log(milliseconds / LATENCY_BUCKET_START) / log(LATENCY_BUCKET_GROWTH)));
+        bucket = min(bucket, LATENCY_BUCKET_COUNT - 1);
+    }
+    latencyBuckets[bucket].fetch_add(1, memory_order_relaxed);
+
+    // Keep track of the worst frame.
+    if (milliseconds > windowMaxLatency.load(memory_order_relaxed))
+    {
+        windowMaxLatency.store(milliseconds, memory_order_relaxed);
+    }
+
+    // Every so often halve all the counts, so old frames fade out of the percentiles.
+    if (++windowSamples >= LATENCY_WINDOW_SAMPLES)
+    {
+        for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        {
+            latencyBuckets[i].store(latencyBuckets[i].load(memory_order_relaxed) / 2, memory_order_relaxed);
+        }
+        previousWindowMaxLatency.store(windowMaxLatency.load(memory_order_relaxed), memory_order_relaxed);
+        windowMaxLatency.store(0.0, memory_order_relaxed);
+        windowSamples = 0;
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the smoothed frame rate. If the thread has
+							stalled, the time since the last frame is used so
+							the rate drops instead of freezing.
+
+			Arguments: 		None
+
+			Returns: 		DOUBLE
+****************************************************************************/
+double PerformanceMeter::GetFramesPerSec()
+{
+    // Create instance variables.
+    int64_t lastTick = lastTickNanoseconds.load(memory_order_relaxed);
+    double interval = smoothedInterval.load(memory_order_relaxed);
+
+    // Need at least two frames to have a rate.
+    if (lastTick < 0 || interval <= 0.0)
+    {
+        return 0.0;
+    }
+
+    // Use whichever is longer, the average interval or the current wait.
+    int64_t timeNow = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count();
+    double sinceLastTick = (timeNow - lastTick) / 1e9;
+    return 1.0 / max(interval, sinceLastTick);
+}
+
+/****************************************************************************
+			Description:	Gets the frame count, frame rate and latency
+							percentiles. Percentiles are reported as the upper
+							limit of the bucket they fall in, capped at the max.
+
+			Arguments: 		None
+
+			Returns: 		PERFORMANCESNAPSHOT
+****************************************************************************/
+PerformanceSnapshot PerformanceMeter::GetSnapshot()
+{
+    // Create instance variables.
+    PerformanceSnapshot snapshot;
+    uint32_t counts[LATENCY_BUCKET_COUNT];
+    uint64_t total = 0;
+
+    // Copy the histogram.
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        counts[i] = latencyBuckets[i].load(memory_order_relaxed);
+        total += counts[i];
+    }
+
+    // Get rate and max.
+    snapshot.frames = frameCount.load(memory_order_relaxed);
+    snapshot.framesPerSec = GetFramesPerSec();
+    snapshot.max = max(windowMaxLatency.load(memory_order_relaxed), previousWindowMaxLatency.load(memory_order_relaxed));
+
+    // Walk the histogram once to find each percentile.
+    if (total > 0)
+    {
+        double percentiles[3] = {0.50, 0.95, 0.99};
+        double* results[3] = {&snapshot.p50, &snapshot.p95, &snapshot.p99};
+        uint64_t cumulative = 0;
+        int next = 0;
+        for (int i = 0; i < LATENCY_BUCKET_COUNT && next < 3; i++)
+        {
+            cumulative += counts[i];
+            while (next < 3 && cumulative >= uint64_t(ceil(percentiles[next] * total)))
+            {
+                *results[next] = min(GetBucketLimit(i), snapshot.max);
+                next++;
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+/****************************************************************************
+			Description:	Gets the upper limit of a latency bucket.
+
+			Arguments: 		INT
+
+			Returns: 		DOUBLE (milliseconds)
+****************************************************************************/
+double PerformanceMeter::GetBucketLimit(int bucket)
+{
+    return LATENCY_BUCKET_START * pow(LATENCY_BUCKET_GROWTH, bucket);
+}
+///////////////////////////////////////////////////////////////////////////////
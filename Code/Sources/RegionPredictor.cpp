@@ -0,0 +1,144 @@
+/****************************************************************************
+		Description:	Implements the RegionPredictor Class.
+
+		Classes:		RegionPredictor
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/RegionPredictor.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	RegionPredictor constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+RegionPredictor::RegionPredictor()
+{
+    // Initialize member variables.
+    Reset();
+}
+
+/****************************************************************************
+			Description:	RegionPredictor destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+RegionPredictor::~RegionPredictor()
+{
+}
+
+/****************************************************************************
+			Description:	Gets the part of the frame to search this frame.
+
+			Arguments: 		SIZE
+
+			Returns: 		RECT (the whole frame for a full scan)
+****************************************************************************/
+Rect RegionPredictor::Predict(Size frameSize)
+{
+    // Create instance variables.
+    Rect frameRect(Point(0, 0), frameSize);
+    Rect region = frameRect;
+
+    // Look around where the target should be now, unless it's time to look everywhere.
+    if (hasTarget && frameSize == lastFrameSize && framesSinceFullScan < ROI_FULL_SCAN_INTERVAL)
+    {
+        int padding = ROI_PADDING + max(abs(velocity.x), abs(velocity.y));
+        region = Rect(lastBounds.tl() + velocity - Point(padding, padding), lastBounds.br() + velocity + Point(padding, padding)) & frameRect;
+    }
+
+    // A target that has moved off the frame is a miss, so search all of it.
+    isFullScan = region.empty() || region == frameRect;
+    if (isFullScan)
+    {
+        region = frameRect;
+        framesSinceFullScan = 0;
+    }
+    framesSinceFullScan++;
+    lastFrameSize = frameSize;
+
+    return region;
+}
+
+/****************************************************************************
+			Description:	Records where the target was found this frame.
+
+			Arguments: 		CONST RECT& (frame coordinates)
+
+			Returns: 		Nothing
+****************************************************************************/
+void RegionPredictor::Hit(const Rect &targetBounds)
+{
+    // The target's center moved this far since the last frame.
+    Point center = (targetBounds.tl() + targetBounds.br()) / 2;
+    Point lastCenter = (lastBounds.tl() + lastBounds.br()) / 2;
+    velocity = hasTarget ? center - lastCenter : Point(0, 0);
+    lastBounds = targetBounds;
+    hasTarget = true;
+}
+
+/****************************************************************************
+			Description:	Records that the target wasn't found, so the next
+							frame is searched in full.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void RegionPredictor::Miss()
+{
+    hasTarget = false;
+    velocity = Point(0, 0);
+}
+
+/****************************************************************************
+			Description:	Forgets the target, for when the mode is switched
+							away from and back.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void RegionPredictor::Reset()
+{
+    lastBounds = Rect();
+    velocity = Point(0, 0);
+    lastFrameSize = Size();
+    framesSinceFullScan = 0;
+    hasTarget = false;
+    isFullScan = true;
+}
+
+/****************************************************************************
+			Description:	Gets whether the last Predict searched the whole
+							frame.
+
+			Arguments: 		None
+
+			Returns: 		BOOL
+****************************************************************************/
+bool RegionPredictor::IsFullScan()
+{
+    return isFullScan;
+}
+
+/****************************************************************************
+			Description:	Gets whether the target was found last frame.
+
+			Arguments: 		None
+
+			Returns: 		BOOL
+****************************************************************************/
+bool RegionPredictor::HasTarget()
+{
+    return hasTarget;
+}
+///////////////////////////////////////////////////////////////////////////////
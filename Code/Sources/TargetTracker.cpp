@@ -0,0 +1,196 @@
+/****************************************************************************
+		Description:	Implements the TargetTracker Class.
+
+		Classes:		TargetTracker
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/TargetTracker.h"
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	TargetTracker constructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+TargetTracker::TargetTracker()
+{
+    // Initialize member variables.
+    Reset();
+}
+
+/****************************************************************************
+			Description:	TargetTracker destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+TargetTracker::~TargetTracker()
+{
+}
+
+/****************************************************************************
+			Description:	Adds a measurement of the target. The filter is
+							moved to the measurement's time first, and a
+							target that timed out starts over from it.
+							Measurements older than the last are ignored.
+
+			Arguments: 		POINT2D, UINT64_T (capture time)
+
+			Returns: 		Nothing
+****************************************************************************/
+void TargetTracker::Update(Point2d measurement, uint64_t time)
+{
+    // A measurement older than the state can't be used.
+    if (isTracking && time < lastTime)
+    {
+        return;
+    }
+
+    // Start over if the target was lost.
+    if (!IsTracking(time))
+    {
+        StartAxis(axisX, measurement.x);
+        StartAxis(axisY, measurement.y);
+        lastTime = time;
+        isTracking = true;
+        return;
+    }
+
+    double deltaTime = (time - lastTime) / 1000000.0;
+    PredictAxis(axisX, deltaTime);
+    PredictAxis(axisY, deltaTime);
+    CorrectAxis(axisX, measurement.x);
+    CorrectAxis(axisY, measurement.y);
+    lastTime = time;
+}
+
+/****************************************************************************
+			Description:	Predicts the target forward to a time, without
+							changing the filter.
+
+			Arguments: 		UINT64_T
+
+			Returns: 		TARGETESTIMATE (not valid if the target isn't tracked)
+****************************************************************************/
+TargetEstimate TargetTracker::Predict(uint64_t time) const
+{
+    // Create instance variables.
+    TargetEstimate estimate;
+    AxisState predictedX = axisX;
+    AxisState predictedY = axisY;
+
+    if (IsTracking(time))
+    {
+        // Never predict backwards.
+        double deltaTime = (time > lastTime) ? (time - lastTime) / 1000000.0 : 0.0;
+        PredictAxis(predictedX, deltaTime);
+        PredictAxis(predictedY, deltaTime);
+
+        estimate.isValid = true;
+        estimate.position = Point2d(predictedX.position, predictedY.position);
+        estimate.velocity = Point2d(predictedX.velocity, predictedY.velocity);
+        estimate.covarianceX = Vec3d(predictedX.positionVariance, predictedX.crossVariance, predictedX.velocityVariance);
+        estimate.covarianceY = Vec3d(predictedY.positionVariance, predictedY.crossVariance, predictedY.velocityVariance);
+    }
+
+    return estimate;
+}
+
+/****************************************************************************
+			Description:	Forgets the target.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void TargetTracker::Reset()
+{
+    axisX = AxisState();
+    axisY = AxisState();
+    lastTime = 0;
+    isTracking = false;
+}
+
+/****************************************************************************
+			Description:	Gets whether the target has been measured recently
+							enough to still be tracked at a time.
+
+			Arguments: 		UINT64_T
+
+			Returns: 		BOOL
+****************************************************************************/
+bool TargetTracker::IsTracking(uint64_t time) const
+{
+    return isTracking && (time <= lastTime || time - lastTime <= TARGET_TIMEOUT);
+}
+
+/****************************************************************************
+			Description:	Moves one axis forward in time. The velocity is
+							kept, and the white noise acceleration adds to
+							the covariance.
+
+			Arguments: 		AXISSTATE&, DOUBLE (seconds)
+
+			Returns: 		Nothing
+****************************************************************************/
+void TargetTracker::PredictAxis(AxisState &axis, double deltaTime)
+{
+    // Create instance variables.
+    double deltaTime2 = deltaTime * deltaTime;
+    double deltaTime3 = deltaTime2 * deltaTime;
+
+    // P = F P F' + Q, with F = [1 dt; 0 1] and Q = q [dt^3/3 dt^2/2; dt^2/2 dt].
+    axis.position += axis.velocity * deltaTime;
+    axis.positionVariance += 2.0 * deltaTime * axis.crossVariance + deltaTime2 * axis.velocityVariance + TARGET_PROCESS_NOISE * deltaTime3 / 3.0;
+    axis.crossVariance += deltaTime * axis.velocityVariance + TARGET_PROCESS_NOISE * deltaTime2 / 2.0;
+    axis.velocityVariance += TARGET_PROCESS_NOISE * deltaTime;
+}
+
+/****************************************************************************
+			Description:	Corrects one axis with a measured position.
+
+			Arguments: 		AXISSTATE&, DOUBLE
+
+			Returns: 		Nothing
+****************************************************************************/
+void TargetTracker::CorrectAxis(AxisState &axis, double measurement)
+{
+    // Only the position is measured, so the gain is the first column of P over the innovation variance.
+    double innovationVariance = axis.positionVariance + TARGET_MEASUREMENT_NOISE;
+    double positionGain = axis.positionVariance / innovationVariance;
+    double velocityGain = axis.crossVariance / innovationVariance;
+    double residual = measurement - axis.position;
+
+    axis.position += positionGain * residual;
+    axis.velocity += velocityGain * residual;
+
+    // P = (I - K H) P. The velocity variance uses the cross variance from before it's updated.
+    axis.velocityVariance -= velocityGain * axis.crossVariance;
+    axis.crossVariance -= positionGain * axis.crossVariance;
+    axis.positionVariance -= positionGain * axis.positionVariance;
+}
+
+/****************************************************************************
+			Description:	Starts one axis at a measured position with no
+							velocity.
+
+			Arguments: 		AXISSTATE&, DOUBLE
+
+			Returns: 		Nothing
+****************************************************************************/
+void TargetTracker::StartAxis(AxisState &axis, double measurement)
+{
+    axis.position = measurement;
+    axis.velocity = 0.0;
+    axis.positionVariance = TARGET_MEASUREMENT_NOISE;
+    axis.crossVariance = 0.0;
+    axis.velocityVariance = TARGET_INITIAL_VELOCITY_VARIANCE;
+}
+///////////////////////////////////////////////////////////////////////////////
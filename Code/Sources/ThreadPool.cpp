@@ -0,0 +1,215 @@
+/****************************************************************************
+		Description:	Implements the ThreadPool Class.
+
+		Classes:		ThreadPool
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/ThreadPool.h"
+#include "../Headers/Tracer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	ThreadPool constructor.
+
+			Arguments:		INT (threads to run tasks on, counting the caller)
+
+			Derived From:	Nothing
+****************************************************************************/
+ThreadPool::ThreadPool(int threadCount)
+{
+    // Initialize member variables.
+    jobInvoke = nullptr;
+    job = nullptr;
+    jobTaskCount = 0;
+    nextTask = 0;
+    busyWorkers = 0;
+    jobGeneration = 0;
+    isStopping = false;
+
+    // The calling thread does its share, so start one less worker.
+    for (int i = 1; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+/****************************************************************************
+			Description:	ThreadPool destructor.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+ThreadPool::~ThreadPool()
+{
+    // Wake the workers up and wait for them to leave.
+    {
+        lock_guard<mutex> guard(jobMutex);
+        isStopping = true;
+    }
+    jobStarted.notify_all();
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the pool shared by the whole program.
+
+			Arguments: 		None
+
+			Returns: 		THREADPOOL&
+****************************************************************************/
+ThreadPool& ThreadPool::Get()
+{
+    // Thread safe one time creation.
+    static ThreadPool pool([]() {
+        // Use every core unless the user asks for fewer.
+        int threadCount = max(1, min(int(thread::hardware_concurrency()), MAX_POOL_THREADS));
+        const char* requested = getenv("VISION_THREADS");
+        if (requested != nullptr && atoi(requested) > 0)
+        {
+            threadCount = min(atoi(requested), MAX_POOL_THREADS);
+        }
+
+        cout << "Using " << threadCount << " vision threads." << endl;
+        return threadCount;
+    }());
+    return pool;
+}
+
+/****************************************************************************
+			Description:	Gets how many threads run tasks, counting the
+							thread that calls ParallelFor.
+
+			Arguments: 		None
+
+			Returns: 		INT
+****************************************************************************/
+int ThreadPool::GetThreadCount()
+{
+    return int(workers.size()) + 1;
+}
+
+/****************************************************************************
+			Description:	Runs a ParallelFor job. The task is passed as a
+							pointer and a function that knows its type.
+
+			Arguments: 		INT, VOID (*)(CONST VOID*, INT), CONST VOID*
+
+			Returns: 		Nothing
+****************************************************************************/
+void ThreadPool::Run(int taskCount, void (*invoke)(const void*, int), const void* task)
+{
+    // Don't wake anyone up for a single task.
+    if (workers.empty() || taskCount <= 1)
+    {
+        for (int i = 0; i < taskCount; i++)
+        {
+            invoke(task, i);
+        }
+        return;
+    }
+
+    // Hand the job to the workers.
+    lock_guard<mutex> callGuard(callMutex);
+    {
+        lock_guard<mutex> guard(jobMutex);
+        jobInvoke = invoke;
+        job = task;
+        jobTaskCount = taskCount;
+        nextTask = 0;
+        busyWorkers = int(workers.size());
+        jobException = nullptr;
+        jobGeneration++;
+    }
+    jobStarted.notify_all();
+
+    // Take tasks ourselves until they run out, then wait for the workers to finish theirs.
+    RunTasks();
+    unique_lock<mutex> lock(jobMutex);
+    jobFinished.wait(lock, [this]() { return busyWorkers == 0; });
+    job = nullptr;
+
+    // Pass any failure on to the caller.
+    if (jobException != nullptr)
+    {
+        rethrow_exception(jobException);
+    }
+}
+
+/****************************************************************************
+			Description:	Waits for jobs and runs their tasks until the pool
+							is destroyed.
+
+			Arguments: 		INT
+
+			Returns: 		Nothing
+****************************************************************************/
+void ThreadPool::WorkerLoop(int workerIndex)
+{
+    // Create instance variables.
+    uint64_t lastGeneration = 0;
+    Tracer::SetThreadName("VisionWorker" + to_string(workerIndex));
+
+    while (1)
+    {
+        // Sleep until there is a new job.
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobStarted.wait(lock, [&]() { return isStopping || jobGeneration != lastGeneration; });
+            if (isStopping)
+            {
+                break;
+            }
+            lastGeneration = jobGeneration;
+        }
+
+        RunTasks();
+
+        // Let the caller know once the last worker is done.
+        lock_guard<mutex> guard(jobMutex);
+        if (--busyWorkers == 0)
+        {
+            jobFinished.notify_one();
+        }
+    }
+}
+
+/****************************************************************************
+			Description:	Claims and runs tasks of the current job until
+							there are none left.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void ThreadPool::RunTasks()
+{
+    for (int i = nextTask++; i < jobTaskCount; i = nextTask++)
+    {
+        try
+        {
+            jobInvoke(job, i);
+        }
+        catch (...)
+        {
+            // Keep the first failure. The other tasks still run so the job always finishes.
+            lock_guard<mutex> guard(jobMutex);
+            if (jobException == nullptr)
+            {
+                jobException = current_exception();
+            }
+        }
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,218 @@
+/****************************************************************************
+		Description:	Implements the Tracer and TraceSpan Classes.
+
+		Classes:		Tracer, TraceSpan
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/Tracer.h"
+
+// Rings are never freed, so a trace written after a thread exits still has its spans.
+static mutex ringListMutex;
+static vector<TraceRing*> ringList;
+static thread_local TraceRing* threadRing = nullptr;
+static const chrono::steady_clock::time_point traceStartTime = chrono::steady_clock::now();
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Names the calling thread in the trace.
+
+			Arguments: 		STRING
+
+			Returns: 		Nothing
+****************************************************************************/
+void Tracer::SetThreadName(string threadName)
+{
+    TraceRing* ring = GetThreadRing();
+    lock_guard<mutex> guard(ringListMutex);
+    ring->threadName = threadName;
+}
+
+/****************************************************************************
+			Description:	Gets the trace clock.
+
+			Arguments: 		None
+
+			Returns: 		INT64 (nanoseconds since the tracer started)
+****************************************************************************/
+int64_t Tracer::Now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStartTime).count();
+}
+
+/****************************************************************************
+			Description:	Adds a finished span to the calling thread's ring,
+							overwriting the oldest span once it is full.
+
+			Arguments: 		CONST CHAR*, INT64, INT64
+
+			Returns: 		Nothing
+****************************************************************************/
+void Tracer::Record(const char* name, int64_t startTime, int64_t endTime)
+{
+    // Get this thread's ring and the slot to write.
+    TraceRing* ring = GetThreadRing();
+    uint64_t head = ring->head.load(memory_order_relaxed);
+    TraceRing::Span &span = ring->spans[head & (TRACE_RING_SIZE - 1)];
+
+    // Fill the slot, then publish it by moving the head past it. The fence keeps the slot's stores from being seen before the last head store, the way a seqlock writer does, so a reader that sees any of them also sees the head that tells it the slot is being overwritten.
+    atomic_thread_fence(memory_order_release);
+    span.name.store(name, memory_order_relaxed);
+    span.startTime.store(startTime, memory_order_relaxed);
+    span.duration.store(endTime - startTime, memory_order_relaxed);
+    ring->head.store(head + 1, memory_order_release);
+}
+
+/****************************************************************************
+			Description:	Writes every thread's spans to a Chrome trace-event
+							JSON file. Safe to call while the other threads
+							keep recording.
+
+			Arguments: 		STRING
+
+			Returns: 		BOOL (true if the file was written)
+****************************************************************************/
+bool Tracer::WriteChromeTrace(string filePath)
+{
+    // Open the trace file.
+    FILE* file = fopen(filePath.c_str(), "w");
+    if (file == nullptr)
+    {
+        cout << "WARNING: Unable to open trace file " << filePath << endl;
+        return false;
+    }
+
+    // Hold the list lock so no rings are added or renamed while we write.
+    lock_guard<mutex> guard(ringListMutex);
+    vector<pair<const char*, pair<int64_t, int64_t>>> spans;
+    bool isFirstEvent = true;
+    int spanCount = 0;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (TraceRing* ring : ringList)
+    {
+        // Copy out everything the ring still holds.
+        uint64_t head = ring->head.load(memory_order_acquire);
+        uint64_t first = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+        spans.clear();
+        for (uint64_t i = first; i < head; i++)
+        {
+            TraceRing::Span &span = ring->spans[i & (TRACE_RING_SIZE - 1)];
+            spans.emplace_back(span.name.load(memory_order_relaxed), make_pair(span.startTime.load(memory_order_relaxed), span.duration.load(memory_order_relaxed)));
+        }
+
+        // Anything the writer reached while we were copying may be half overwritten, so drop it.
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t newHead = ring->head.load(memory_order_relaxed);
+        uint64_t firstValid = (newHead >= TRACE_RING_SIZE) ? newHead - TRACE_RING_SIZE + 1 : 0;
+        size_t skip = (firstValid > first) ? min(size_t(firstValid - first), spans.size()) : 0;
+
+        // Name the thread.
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", isFirstEvent ? "" : ",\n", ring->threadID, ring->threadName.c_str());
+        isFirstEvent = false;
+
+        // Write each span as a complete event. Chrome wants microseconds.
+        for (size_t i = skip; i < spans.size(); i++)
+        {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", spans[i].first, ring->threadID, spans[i].second.first / 1000.0, spans[i].second.second / 1000.0);
+            spanCount++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    cout << "Wrote " << spanCount << " trace spans to " << filePath << endl;
+    return true;
+}
+
+/****************************************************************************
+			Description:	Gets the calling thread's ring, creating and
+							registering it the first time the thread traces.
+
+			Arguments: 		None
+
+			Returns: 		TRACERING*
+****************************************************************************/
+TraceRing* Tracer::GetThreadRing()
+{
+    if (threadRing == nullptr)
+    {
+        TraceRing* ring = new TraceRing();
+        ring->head = 0;
+
+        lock_guard<mutex> guard(ringListMutex);
+        ring->threadID = int(ringList.size()) + 1;
+        ring->threadName = "Thread " + to_string(ring->threadID);
+        ringList.emplace_back(ring);
+        threadRing = ring;
+    }
+
+    return threadRing;
+}
+
+
+/****************************************************************************
+			Description:	TraceSpan constructor. Starts timing.
+
+			Arguments:		CONST CHAR*
+
+			Derived From:	Nothing
+****************************************************************************/
+TraceSpan::TraceSpan(const char* name)
+{
+    this->name = name;
+    startTime = Tracer::Now();
+}
+
+/****************************************************************************
+			Description:	TraceSpan destructor. Records the span if it is
+							still open.
+
+			Arguments:		None
+
+			Derived From:	Nothing
+****************************************************************************/
+TraceSpan::~TraceSpan()
+{
+    End();
+}
+
+/****************************************************************************
+			Description:	Closes the current span and starts a new one at
+							the same instant.
+
+			Arguments: 		CONST CHAR*
+
+			Returns: 		Nothing
+****************************************************************************/
+void TraceSpan::Next(const char* name)
+{
+    int64_t timeNow = Tracer::Now();
+    if (this->name != nullptr)
+    {
+        Tracer::Record(this->name, startTime, timeNow);
+    }
+
+    this->name = name;
+    startTime = timeNow;
+}
+
+/****************************************************************************
+			Description:	Closes the span early.
+
+			Arguments: 		None
+
+			Returns: 		Nothing
+****************************************************************************/
+void TraceSpan::End()
+{
+    if (name != nullptr)
+    {
+        Tracer::Record(name, startTime, Tracer::Now());
+        name = nullptr;
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
@@ -21,21 +21,12 @@
 VideoGet::VideoGet()
 {
     // Create objects.
-    FPSCounter									= new FPS();
+    PerformanceCounter							= new PerformanceMeter();
 
     // Initialize Variables.
+    frameSequence						= 0;
     isStopping							= false;
     isStopped							= false;
-
-    // Create VideoCapture object for reading video from virtual cam if enabled.
-    if (USE_VIRTUAL_CAM)
-    {
-        cap = VideoCapture();
-        cap.set(CAP_PROP_FRAME_WIDTH, 640);
-        cap.set(CAP_PROP_FRAME_HEIGHT, 480);
-        cap.set(CAP_PROP_FPS, 30);
-        cap.open(0);
-    }
 }
 
 /****************************************************************************
@@ -48,57 +39,54 @@ VideoGet::VideoGet()
 VideoGet::~VideoGet()
 {
     // Delete object pointers.
-    delete FPSCounter;
+    delete PerformanceCounter;
 
     // Set object pointers as nullptrs.
-    FPSCounter				 = nullptr;
+    PerformanceCounter		 = nullptr;
 }
 
 /****************************************************************************
-        Description:	Grabs frames from camera.
+        Description:	Grabs frames from camera, video file, image directory
+                        or synthetic source.
 
-        Arguments: 		MAT&, SHARED_TIMED_MUTEX&
+        Arguments: 		FRAMESOURCE&, FRAMEBUFFER&
 
         Returns: 		Nothing
 ****************************************************************************/
-void VideoGet::StartCapture(Mat &frame, bool &cameraSourceIndex, bool &drivingMode, vector<CvSink> &cameraSinks, shared_timed_mutex &Mutex)
+void VideoGet::StartCapture(FrameSource &frameSource, FrameBuffer &frameBuffer)
 {
+    // Print which source we are reading from.
+    Tracer::SetThreadName("VideoGet");
+    cout << "Capturing frames from " << frameSource.GetName() << endl;
+
     // Continuously grab camera frames.
     while (1)
     {
-        // Increment FPS counter.
-        FPSCounter->Increment();
-
         try
         {
-            // Acquire resource lock for thread.
-            lock_guard<shared_timed_mutex> guard(Mutex);		// unique_lock
-
-            // Check if we are using virtual camera.
-            if (USE_VIRTUAL_CAM)
+            // Get the slot we are allowed to write into. No lock is needed, the processing thread never reads this slot.
+            Mat &frame = frameBuffer.GetWriteBuffer();
+            FrameMeta &frameMeta = frameBuffer.GetWriteMeta();
+            frameMeta = FrameMeta();
+
+            // Only hand complete frames to the processing thread.
+            auto grabStart = chrono::steady_clock::now();
+            TraceSpan stage("grab");
+            if (frameSource.GrabFrame(frame, frameMeta))
             {
-                // Read frame from video file.
-                cap >> frame;
+                frameMeta.sequence = ++frameSequence;
+                stage.Next("publish");
+                frameBuffer.Publish();
+                stage.End();
+
+                // Only count frames that were actually delivered.
+                PerformanceCounter->Increment();
+                PerformanceCounter->RecordLatency(chrono::duration<double, milli>(chrono::steady_clock::now() - grabStart).count());
             }
-            else
+            else if (frameSource.GetIsFinished())
             {
-                // If the frame is empty, stop the capture.
-                if (cameraSinks.empty())
-                {
-                    break;
-                }
-
-                // Grab frame from either camera1 or camera2.
-                if (cameraSourceIndex)
-                {
-                    // Get camera frame.
-                    int success = cameraSinks[1].GrabFrame(frame);
-                }
-                else
-                {
-                    // Get camera frame.
-                    int success = cameraSinks[0].GrabFrame(frame);
-                }
+                // The source has run out of frames, so stop the capture.
+                break;
             }
         }
         catch (const exception& e)
@@ -107,9 +95,6 @@ void VideoGet::StartCapture(Mat &frame, bool &cameraSourceIndex, bool &drivingMo
             cout << "WARNING: Video data empty or camera not present." << "\n" << e.what() << endl;
         }
 
-        // Calculate FPS.
-        FPSCount = FPSCounter->FramesPerSec();
-
         // If the program stops shutdown the thread.
         if (isStopping)
         {
@@ -155,6 +140,18 @@ bool VideoGet::GetIsStopped()
 ****************************************************************************/
 int VideoGet::GetFPS()
 {
-    return FPSCount;
+    return int(round(PerformanceCounter->GetFramesPerSec()));
+}
+
+/****************************************************************************
+        Description:	Gets the frame rate and grab latency of the thread.
+
+        Arguments: 		None
+
+        Returns: 		PERFORMANCESNAPSHOT
+****************************************************************************/
+PerformanceSnapshot VideoGet::GetPerformance()
+{
+    return PerformanceCounter->GetSnapshot();
 }
 ///////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -21,12 +21,40 @@
 VideoProcess::VideoProcess()
 {
     // Create object pointers.
-    FPSCounter							    = new FPS();
+    PerformanceCounter					    = new PerformanceMeter();
     
     // Initialize member variables.
-    FPSCount                                = 0;
+    duplicateFramesSkipped                  = 0;
+    droppedFrames                           = 0;
     isStopping							    = false;
     isStopped							    = false;
+    lineIsVertical                          = false;
+    lineScanlineCount                       = 0;
+    useTrenchColumns                        = false;
+    useRegionPrediction                     = true;
+    pyramidLevel                            = 0;
+    searchLevel                             = 0;
+    lastTrackingMode                        = -1;
+    filteredTrackingMode                    = -1;
+    useChangeGate                           = false;
+    isChangeGated                           = false;
+    gatedFrameCount                         = 0;
+    gateTolerance                           = 0;
+    gateAreaMinLimit                        = 0.0;
+    gateAreaMaxLimit                        = 0.0;
+    gateScanlineCount                       = 0;
+    gateTrenchColumns                       = false;
+    gatePyramidLevel                        = 0;
+    fullFrameTime                           = 0.0;
+    gateCheckedFrames                       = 0;
+    gateSkippedFrames                       = 0;
+    gateNarrowedFrames                      = 0;
+    gateSpentTime                           = 0;
+    gateSavedTime                           = 0;
+
+    // Let the trench mode measure blobs from runs instead of contours. Their areas count pixels rather than hull area, so the area limits may need a small retune.
+    const char* blobMethod = getenv("VISION_BLOBS");
+    useRunLengthBlobs = blobMethod != nullptr && strcmp(blobMethod, "runs") == 0;
 
     // Setup colors and ranges for box tape detection. (lowerthresh, upperthresh, tracking overlay color(B,G,R))
     colorRanges.emplace_back(vector<Scalar> { Scalar(91, 219, 118), Scalar(255, 255, 157), Scalar(255, 156, 64) });         // lightblue
@@ -41,6 +69,29 @@ VideoProcess::VideoProcess()
     colors.emplace_back("green");
     colors.emplace_back("purple");
     colors.emplace_back("orange");
+    tapeLabeler.SetColorRanges(colorRanges);
+    colorMaskImgs.resize(colorRanges.size());
+    colorContours.resize(colorRanges.size());
+
+    // Reserve the per-frame buffers up front, so once running the processing loop never allocates.
+    hullCandidates.reserve(MAX_TRACKED_CONTOURS);
+    lineStrips.resize(2 * MAX_LINE_SPLITS);
+    verticalLinePoints.reserve(max(MAX_LINE_SPLITS, MAX_LINE_SCANLINES));
+    horizontalLinePoints.reserve(max(MAX_LINE_SPLITS, MAX_LINE_SCANLINES));
+    verticalLineBounds.reserve(max(MAX_LINE_SPLITS, MAX_LINE_SCANLINES));
+    horizontalLineBounds.reserve(max(MAX_LINE_SPLITS, MAX_LINE_SCANLINES));
+    scanlineWords.resize(GetMaskWordCount(max(SCREEN_WIDTH, SCREEN_HEIGHT)));
+    lineRuns.resize(max(SCREEN_WIDTH, SCREEN_HEIGHT) + 1);
+    classIDs.reserve(DNN_MAX_PREDICTIONS);
+    confidences.reserve(DNN_MAX_PREDICTIONS);
+    predictionBoxes.reserve(DNN_MAX_PREDICTIONS);
+    finalDetections.reserve(DNN_MAX_PREDICTIONS);
+    tapeObjects.reserve(MAX_LABEL_COLORS);
+    tapeStats.reserve(MAX_LABEL_COLORS);
+    targetMeasurements.reserve(MAX_TRACKED_TARGETS);
+    targetTrackers.resize(MAX_TRACKED_TARGETS);
+    boundingContour.reserve(4 * MAX_LABEL_COLORS);
+    gateTrackbarValues.reserve(6);
 
     ////
     // Setup SolvePNP data.
@@ -76,616 +127,1435 @@ VideoProcess::VideoProcess()
 VideoProcess::~VideoProcess()
 {
     // Delete object pointers.
-    delete FPSCounter;
+    delete PerformanceCounter;
 
     // Set object pointers as nullptrs.
-    FPSCounter = nullptr;
+    PerformanceCounter = nullptr;
 }
 
 /****************************************************************************
         Description:	Processes frames with OpenCV.
 
-        Arguments(dear god help us): MAT&, MAT&, INT&, INT&, DOUBLE&, DOUBLE&, BOOL&, BOOL&, BOOL&, BOOL&, VECTOR<INT>, VECTOR<DOUBLE>, VIDEOGET, SHARED_TIMED_MUTEX&, SHARED_TIMED_MUTEX&
+        Arguments(dear god help us): FRAMEBUFFER&, FRAMEBUFFER&, INT&, INT&, DOUBLE&, DOUBLE&, BOOL&, BOOL&, BOOL&, BOOL&, VECTOR<INT>, VECTOR<DOUBLE>, VIDEOGET
 
         Returns: 		Nothing
 ****************************************************************************/
-void VideoProcess::Process(Mat &frame, Mat &finalImg, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &tuningMode, bool &drivingMode, int &trackingMode, bool &takeShapshot, bool &solvePNPEnabled, vector<int> &trackbarValues, vector<double> &trackingResults, vector<double> &solvePNPValues, vector<string> &classList, cv::dnn::Net &onnxModel, VideoGet &VideoGetter, shared_timed_mutex &MutexGet, shared_timed_mutex &MutexShow)
+void VideoProcess::Process(FrameBuffer &inputBuffer, FrameBuffer &outputBuffer, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &tuningMode, bool &drivingMode, int &trackingMode, bool &takeShapshot, bool &solvePNPEnabled, vector<int> &trackbarValues, vector<double> &trackingResults, vector<double> &solvePNPValues, vector<string> &classList, cv::dnn::Net &onnxModel, VideoGet &VideoGetter)
 {
     // Give other threads enough time to start before processing camera frames.
+    Tracer::SetThreadName("VideoProcess");
     this_thread::sleep_for(std::chrono::milliseconds(800));
 
+    // Create instance variables.
+    bool isWaiting = false;
+
     while (1)
     {
-        // Increment FPS counter.
-        FPSCounter->Increment();
+        // Only process frames we haven't seen yet. If the camera hasn't delivered a new one, sleep until it does instead of reprocessing the same image.
+        if (!inputBuffer.Acquire())
+        {
+            // Count the duplicate we avoided, once per wait rather than once per timeout while the camera is stalled, and wait for the capture thread.
+            if (!isWaiting)
+            {
+                duplicateFramesSkipped++;
+                isWaiting = true;
+            }
+            TraceSpan waitSpan("wait");
+            inputBuffer.WaitForFrame(100);
+            waitSpan.End();
+
+            // If the program stops shutdown the thread.
+            if (isStopping)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Trace the whole frame, so the stage spans nest under it.
+        isWaiting = false;
+        TraceSpan frameSpan("frame");
+
+        // Carry the camera frame's metadata over to the frame we are about to draw, and stamp when we started on it.
+        FrameMeta &frameMeta = outputBuffer.GetWriteMeta();
+        uint64_t lastFrameSequence = GetLastFrameMeta().sequence;
+        frameMeta = inputBuffer.GetReadMeta();
+        frameMeta.processStartTime = Now();
+
+        // Keep track of camera frames that were replaced before we got to them.
+        if (lastFrameSequence != 0 && frameMeta.sequence > lastFrameSequence + 1)
+        {
+            droppedFrames += frameMeta.sequence - lastFrameSequence - 1;
+        }
+
+        // Draw into our own back buffer. The show thread keeps streaming the last finished frame while we work.
+        Mat &finalImg = outputBuffer.GetWriteBuffer();
 
         // Make sure frame is not corrupt.
         try
         {
-            // Acquire resource lock for read thread. NOTE: This line has been commented out to improve processing speed. VideoGet takes to long with the resources.
-            // shared_lock<shared_timed_mutex> guard(MutexGet);
+            // Get the newest complete camera frame. This never blocks the capture thread and the frame can't change underneath us.
+            Mat &frame = inputBuffer.GetReadBuffer();
 
             if (!frame.empty())
             {
-                // Acquire resource lock for show thread only after frame has been used.
-                unique_lock<shared_timed_mutex> guard(MutexShow);
-                // Copy frame to a new mat.
-                finalImg = frame.clone();
-                
-                // Reset tracking results array every iteration.
-                trackingResults.clear();
+                // Run the selected tracking mode on the frame and draw the results into the output frame.
+                bool isProcessed = ProcessFrame(frame, finalImg, targetCenterX, targetCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, trackingResults, classList, onnxModel);
 
-                // Driving mode.
-                if (!drivingMode)
+                // Filter the targets found, as of when the frame was captured. A skipped frame measured nothing, so the filters just keep predicting forward.
+                if (isProcessed)
+                {
+                    UpdateTargets(frameMeta.grabTime);
+                }
+
+                // Put FPS and the typical processing time on image. The text is formatted into a string that keeps its memory between frames.
+                TraceSpan stage("overlay");
+                PerformanceSnapshot performance = PerformanceCounter->GetSnapshot();
+                char overlayBuffer[64];
+                snprintf(overlayBuffer, sizeof(overlayBuffer), "Camera FPS: %d", VideoGetter.GetFPS());
+                overlayText.assign(overlayBuffer);
+                {
+                    LibraryAllocations libraryAllocations;
+                    putText(finalImg, overlayText, Point(420, finalImg.rows - 40), FONT_HERSHEY_DUPLEX, 0.65, Scalar(200, 200, 200), 1);
+                }
+                snprintf(overlayBuffer, sizeof(overlayBuffer), "Algorithm FPS: %d (%d ms)", int(round(performance.framesPerSec)), int(round(performance.p50)));
+                overlayText.assign(overlayBuffer);
                 {
-                    // Tracking mode. (TrackingMode enum)
-                    switch (trackingMode)
+                    LibraryAllocations libraryAllocations;
+                    putText(finalImg, overlayText, Point(420, finalImg.rows - 20), FONT_HERSHEY_DUPLEX, 0.65, Scalar(200, 200, 200), 1);
+                }
+
+                // If tuning mode is enabled, then output contrast or brightness images.
+                if (tuningMode)
+                {
+                    // Masks only cover the part of the frame that was searched. One made on a pyramid level is put together at that level and scaled back up.
+                    Size searchSize(searchRegion.width >> searchLevel, searchRegion.height >> searchLevel);
+                    Size searchMasksSize = (searchLevel > 0) ? Size(frame.cols >> searchLevel, frame.rows >> searchLevel) : frame.size();
+                    Rect searchMaskRegion = (searchLevel > 0) ? Rect(Point(0, 0), searchSize) : searchRegion;
+                    Mat &searchMasksImg = (searchLevel > 0) ? pyramidMaskImg : dilateImg;
+                    Mat &searchLabelsImg = (searchLevel > 0) ? pyramidLabelImg : labelImg;
+
+                    // Tape tracking never builds a full frame mask, so show every labeled pixel of the part searched instead.
+                    if (trackingMode == TAPE_TRACKING && searchLabelsImg.size() == searchMasksSize)
                     {
-                        /****************************************************
-                        *			Track trench target
-                        *****************************************************/
-                        case TRENCH_TRACKING:
+                        searchMasksImg.create(searchMasksSize, CV_8UC1);
+                        searchMasksImg.setTo(0);
+                        Mat searchMaskImg = searchMasksImg(searchMaskRegion);
+                        compare(searchLabelsImg(searchMaskRegion), 0, searchMaskImg, CMP_GT);
+                    }
+                    // Line tracking, and trench tracking with blobs, leave their mask packed.
+                    if ((trackingMode == LINE_TRACKING || (trackingMode == TRENCH_TRACKING && useRunLengthBlobs && !useTrenchColumns)) && dilateMask.GetWidth() == searchSize.width && dilateMask.GetHeight() == searchSize.height)
+                    {
+                        searchMasksImg.create(searchMasksSize, CV_8UC1);
+                        searchMasksImg.setTo(0);
+                        Mat searchMaskImg = searchMasksImg(searchMaskRegion);
+                        dilateMask.ToMat(searchMaskImg);
+                    }
+                    if (searchLevel > 0 && pyramidMaskImg.size() == searchMasksSize)
+                    {
+                        dilateImg.create(frame.size(), CV_8UC1);
+                        dilateImg.setTo(0);
+                        Mat searchMaskImg = dilateImg(searchRegion);
+                        resize(pyramidMaskImg(searchMaskRegion), searchMaskImg, searchRegion.size(), 0, 0, INTER_NEAREST);
+                    }
+                    // m_pContrastImg.copyTo(finalImg);
+                    dilateImg.copyTo(finalImg);
+                }
+
+                // Stamp when we finished and hand the frame's metadata to the main thread along with the tracking results.
+                frameMeta.searchRegion = searchRegion;
+                frameMeta.isFullScan = searchRegion == Rect(Point(0, 0), frame.size());
+                frameMeta.processEndTime = Now();
+                {
+                    lock_guard<mutex> guard(frameMetaMutex);
+                    lastFrameMeta = frameMeta;
+                }
+
+                // Swap the finished frame to the front so the show thread picks it up.
+                stage.Next("publish");
+                outputBuffer.Publish();
+                stage.End();
+
+                // Count the frame and how long it took us. Skipped frames are only counted by the change gate, so they don't inflate the processing rate or hide in the latencies.
+                if (isProcessed)
+                {
+                    PerformanceCounter->Increment();
+                    PerformanceCounter->RecordLatency((frameMeta.processEndTime - frameMeta.processStartTime) / 1000.0);
+                }
+            }
+        }
+        catch (const exception& e)
+        {
+            //SetIsStopping(true);
+            // Print error to console and show that an error has occured on the screen.
+            if (!finalImg.empty())
+            {
+                putText(finalImg, "Image Processing ERROR", Point(280, finalImg.rows - 440), FONT_HERSHEY_DUPLEX, 0.65, Scalar(0, 0, 250), 1);
+                frameMeta.processEndTime = Now();
+                outputBuffer.Publish();
+            }
+            cout << "\nWARNING: MAT corrupt or a runtime error has occured! Frame has been dropped." << "\n" << e.what() << endl;
+        }
+
+        // If the program stops shutdown the thread.
+        if (isStopping)
+        {
+            break;
+        }
+    }
+
+    // Clean-up.
+    isStopped = true;
+}
+
+/****************************************************************************
+        Description:	Runs the selected tracking mode on one frame and draws
+                        the results onto the output frame. This is the body
+                        of the processing loop, kept separate so it can be
+                        driven without the capture and show threads. A
+                        frame the change gate skips gets the last frame's
+                        drawing, and nothing new is measured.
+
+        Arguments: 		MAT&, MAT&, INT&, INT&, INT&, DOUBLE&, DOUBLE&, BOOL&, INT&, BOOL&, VECTOR<INT>&, VECTOR<DOUBLE>&, VECTOR<STRING>&, DNN::NET&
+
+        Returns: 		BOOL (false if the change gate skipped the frame)
+****************************************************************************/
+bool VideoProcess::ProcessFrame(Mat &frame, Mat &finalImg, int &targetCenterX, int &targetCenterY, int &centerLineTolerance, double &contourAreaMinLimit, double &contourAreaMaxLimit, bool &drivingMode, int &trackingMode, bool &takeShapshot, vector<int> &trackbarValues, vector<double> &trackingResults, vector<string> &classList, cv::dnn::Net &onnxModel)
+{
+    // Time each stage of the pipeline. Every Next() closes the last stage and starts the next one.
+    TraceSpan stage("changeGate");
+    uint64_t startTime = Now();
+
+    // Forget where the targets were whenever the mode changes, so a mode switched back to starts with a full scan, and forget what the last mode searched.
+    int activeTrackingMode = drivingMode ? -1 : trackingMode;
+    if (activeTrackingMode != lastTrackingMode)
+    {
+        trenchRegion.Reset();
+        lineRegion.Reset();
+        tapeRegion.Reset();
+        changeDetector.Reset();
+        fullFrameTime = 0.0;
+        lastTrackingMode = activeTrackingMode;
+    }
+
+    // Keep the last frame's results and drawing if nothing has changed since it was searched. The search region and level are left as they were, for the tuning display. Snapshots always get a new frame.
+    isChangeGated = useChangeGate.load(memory_order_relaxed) && !drivingMode && !takeShapshot;
+    if (isChangeGated)
+    {
+        if (SkipUnchangedFrame(frame, finalImg, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, trackbarValues))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        changeDetector.Reset();
+    }
+
+    // Copy frame into the output buffer. This reuses the buffer's memory when the size hasn't changed.
+    stage.Next("clone");
+    frame.copyTo(finalImg);
+    
+    // Reset tracking results array every iteration. Its memory is kept, so reserving once means it never grows.
+    trackingResults.clear();
+    trackingResults.reserve(MAX_TRACKING_RESULTS);
+    targetMeasurements.clear();
+
+    // Search the whole frame unless the mode predicts a region, or only part of it changed.
+    searchRegion = Rect(Point(0, 0), frame.size());
+    searchLevel = 0;
+    bool predictRegion = useRegionPrediction.load(memory_order_relaxed);
+    bool isNarrowed = false;
+
+    // Driving mode.
+    if (!drivingMode)
+    {
+        // Tracking mode. (TrackingMode enum)
+        switch (trackingMode)
+        {
+            /****************************************************
+            *			Track trench target
+            *****************************************************/
+            case TRENCH_TRACKING:
+            {
+                // Blur, filter out specific color in image, remove small blobs and "inflate" what's left, all in one pass over the frame. The HSV range is looked up straight from BGR, so there is no HSV image.
+                stage.Next("threshold");
+                trackbarLabeler.SetColorRange(Scalar(trackbarValues[0], trackbarValues[2], trackbarValues[4]), Scalar(trackbarValues[1], trackbarValues[3], trackbarValues[5]));
+
+                // Only search around where the walls were last found, unless it's time for a full scan. The mask stays the size of the frame and just the searched part of it is written.
+                if (predictRegion)
+                {
+                    searchRegion = trenchRegion.Predict(frame.size());
+                }
+                isNarrowed = LimitToChangedRegion(trenchRegion);
+
+                // Threshold a shrunk copy of the search region instead, if set to a pyramid level. Everything found is scaled back up to frame coordinates.
+                Mat searchImg = GetSearchImage(frame);
+                int scale = 1 << searchLevel;
+                Mat searchMaskImg;
+                if (searchLevel > 0)
+                {
+                    pyramidMaskImg.create(pyramidImg.size(), CV_8UC1);
+                    searchMaskImg = pyramidMaskImg(Rect(Point(0, 0), searchImg.size()));
+                }
+                else
+                {
+                    dilateImg.create(frame.size(), CV_8UC1);
+                    searchMaskImg = dilateImg(searchRegion);
+                }
+                Rect trenchBounds;
+
+                // Find the walls from how many pixels each column has and how tall its runs are, if asked to. Nothing is traced or sorted by hull.
+                if (useTrenchColumns.load(memory_order_relaxed))
+                {
+                    trackbarLabeler.FilterImage(searchImg, searchMaskImg);
+                    stage.Next("projectColumns");
+                    VisionKernels::ProjectColumns(searchMaskImg, trenchProjection);
+                    FindTrenchWalls(searchRegion.tl(), scale, contourAreaMinLimit, contourAreaMaxLimit);
+
+                    // Only continue if we have more than two walls, the same as the hull path.
+                    stage.Next("overlay");
+                    if (hullCandidates.size() > 2)
+                    {
+                        // Draw each wall from its top to its bottom.
+                        for (const HullCandidate &candidate : hullCandidates)
+                        {
+                            line(finalImg, Point(candidate.extremes[0], candidate.extremes[1]), Point(candidate.extremes[2], candidate.extremes[3]), Scalar(255, 255, 210), 1);
+                        }
+
+                        // Find the two walls and the center between them.
+                        trenchBounds = TrackTrenchCenter(finalImg, centerLineTolerance, targetCenterX, targetCenterY);
+                    }
+                    else
+                    {
+                        // No walls to track. Output zero.
+                        targetCenterX = 0;
+                        targetCenterY = -1;
+                    }
+                }
+                else
+                {
+                    // Find countours of image, or just measure its blobs. Blobs are read straight from the bit mask, so it's only unpacked for findContours.
+                    if (useRunLengthBlobs)
+                    {
+                        trackbarLabeler.FilterImage(searchImg, dilateMask);
+                        stage.Next("findContours");
+                        blobs.Find(dilateMask, searchRegion.tl(), scale);
+                    }
+                    else
+                    {
+                        trackbarLabeler.FilterImage(searchImg, searchMaskImg);
+                        stage.Next("findContours");
+                        contours.Find(searchMaskImg, searchRegion.tl(), scale);		////RETR_TREE //// TRY CHAIN_APPROX_SIMPLE		//// Not sure what this method of detection does, but it worked before: CHAIN_APPROX_TC89_KCOS
+                    }
+
+                    // Draw all contours in white.
+                    // drawContours(finalImg, contours, -1, Scalar(255, 255, 210), 1, LINE_4, hierarchy);
+
+                    // Only continue if we have more than two contours.
+                    if ((useRunLengthBlobs ? blobs.GetCount() : contours.GetCount()) >= 2)
+                    {
+                        // Remove contours whose 'rounded off' convexHull area doesn't meet the threshold. Most are ruled out by their box or their own area before a hull is built.
+                        stage.Next("hull/sort");
+                        hullCandidates.clear();
+                        for (int i = 0; i < (useRunLengthBlobs ? blobs.GetCount() : contours.GetCount()); i++)
                         {
-                            // Convert image from RGB to HSV.
-                            cvtColor(frame, HSVImg, COLOR_BGR2HSV);
-                            // Blur the image.
-                            blur(HSVImg, blurImg, Size(GREEN_BLUR_RADIUS, GREEN_BLUR_RADIUS));
-                            // Filter out specific color in image.
-                            inRange(blurImg, Scalar(trackbarValues[0], trackbarValues[2], trackbarValues[4]), Scalar(trackbarValues[1], trackbarValues[3], trackbarValues[5]), filterImg);
-                            // Remove small blobs.
-                            erode(filterImg, dilateImg, KERNEL);
-                            // "Inflate" image.
-                            dilate(dilateImg, dilateImg, KERNEL);
-
-                            // Find countours of image.
-                            findContours(dilateImg, contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);		////RETR_TREE //// TRY CHAIN_APPROX_SIMPLE		//// Not sure what this method of detection does, but it worked before: CHAIN_APPROX_TC89_KCOS
-
-                            // Draw all contours in white.
-                            // drawContours(finalImg, contours, -1, Scalar(255, 255, 210), 1, LINE_4, hierarchy);
-
-                            // Only continue if we have more than two contours.
-                            if (contours.size() >= 2)
+                            if (useRunLengthBlobs)
                             {
-                                // 'Round off' all contours with convexHull.
-                                vector<vector<Point>> hulls;
-                                for (vector<Point> contour : contours)
+                                // Blobs are measured by their pixels and already know their extremes.
+                                const Blob &blob = blobs.GetBlob(i);
+                                if (blob.area >= contourAreaMinLimit && blob.area <= contourAreaMaxLimit)
                                 {
-                                    vector<Point> hull;
-                                    convexHull(contour, hull);
-                                    hulls.emplace_back(hull);
+                                    hullCandidates.push_back({i, double(blob.area), Vec4i(blob.top.x, blob.top.y, blob.bottom.x, blob.bottom.y)});
                                 }
-                                
-                                // Sort contours from biggest to smallest.
-                                sort(hulls.begin(), hulls.end(), [](const vector<Point>& c1, const vector<Point>& c2) {	return fabs(contourArea(c1, false)) > fabs(contourArea(c2, false)); });
-                                
-                                // Remove contours whose area doesn't meet the threshold.
-                                vector<vector<Point>> filteredHulls;
-                                for (vector<Point> hull : hulls)
+                            }
+                            else if (contours.IsHullAreaInRange(i, contourAreaMinLimit, contourAreaMaxLimit))
+                            {
+                                // Store the upper and lower extremes of the hull contour. (x1, y1, x2, y2)
+                                const vector<Point> &hull = contours.GetHull(i);
+                                auto val = minmax_element(hull.begin(), hull.end(), [](Point const& a, Point const& b) { return a.y < b.y; });
+                                hullCandidates.push_back({i, contours.GetHullArea(i), Vec4i(val.first->x, val.first->y, val.second->x, val.second->y)});
+                            }
+                        }
+
+                        // Sort contours from biggest to smallest.
+                        sort(hullCandidates.begin(), hullCandidates.end(), [](const HullCandidate& c1, const HullCandidate& c2) { return c1.area > c2.area; });
+
+                        // Only continue if we have more than two contours.
+                        stage.Next("overlay");
+                        if (hullCandidates.size() > 2)
+                        {
+                            // Draw convex hull contours, or the boxes of the blobs.
+                            for (const HullCandidate &candidate : hullCandidates)
+                            {
+                                if (useRunLengthBlobs)
                                 {
-                                    double area = contourArea(hull);
-                                    if (area >= contourAreaMinLimit && area <= contourAreaMaxLimit)
-                                    {
-                                        filteredHulls.emplace_back(hull);
-                                    }
+                                    rectangle(finalImg, blobs.GetBlob(candidate.index).bounds, Scalar(255, 255, 210), 1);
                                 }
-
-                                // Only continue if we have more than two contours.
-                                if (filteredHulls.size() > 2)
+                                else
                                 {
-                                    // Draw convex hull contours.
-                                    polylines(finalImg, filteredHulls, true, Scalar(255, 255, 210), 1);
-
-                                    // Store the upper and lower extremes of each hull contour.
-                                    vector<vector<int>> hullExtremes;
-                                    for (vector<Point> hull : filteredHulls)
-                                    {
-                                        // Find and store the bounding rect. (Rect type contains x, y, height, width)
-                                        auto val = minmax_element(hull.begin(), hull.end(), [](Point const& a, Point const& b) { return a.y < b.y; });
-                                        vector<int> point;
-                                        point.emplace_back(val.first->x);
-                                        point.emplace_back(val.first->y);
-                                        point.emplace_back(val.second->x);
-                                        point.emplace_back(val.second->y);
-                                        hullExtremes.emplace_back(point);
-                                    }
-
-                                    // Now that we have the lines, find the tallest one.
-                                    int minLineLength = 50;
-                                    vector<int> tallestLine1 = {0, 0, 0, minLineLength};
-                                    for (vector<int> line : hullExtremes)
-                                    {
-                                        // Compare the y distance of the line to the currently stored biggest one.
-                                        if ((line[3] - line[1]) > (tallestLine1[3] - tallestLine1[1]))
-                                        {
-                                            tallestLine1.assign(line.begin(), line.end());
-                                        }
-                                    }
-
-                                    // Remove the line we just found.
-                                    hullExtremes.erase(remove(hullExtremes.begin(), hullExtremes.end(), tallestLine1));
-                                    // Find the next tallest line segment.
-                                    vector<int> tallestLine2 = {SCREEN_WIDTH, 0, SCREEN_WIDTH, minLineLength};
-                                    for (vector<int> line : hullExtremes)
-                                    {
-                                        // Compare the y distance of the line to the currently stored biggest one.
-                                        if ((line[3] - line[1]) > (tallestLine2[3] - tallestLine2[1]))
-                                        {
-                                            tallestLine2.assign(line.begin(), line.end());
-                                        }
-                                    }
-
-                                    // Find the center line.
-                                    vector<int> centerLine;
-                                    if (tallestLine1[0] < tallestLine2[0])
-                                    {
-                                        centerLine = {(tallestLine1[0] + ((tallestLine2[0] - tallestLine1[0]) / 2)), tallestLine1[1], (tallestLine1[2] + ((tallestLine2[2] - tallestLine1[2]) / 2)), tallestLine1[3]};
-                                    }
-                                    else
-                                    {
-                                        centerLine = {(tallestLine2[0] + ((tallestLine1[0] - tallestLine2[0]) / 2)), tallestLine1[1], (tallestLine2[2] + ((tallestLine1[2] - tallestLine2[2]) / 2)), tallestLine1[3]};
-                                    }
-
-                                    // Calculate the X center of the center line.
-                                    int lineCenterX = (((centerLine[0] - centerLine[2]) / 2) + centerLine[2]) - (SCREEN_WIDTH / 2);
-                                    // Calculate the width of the pipe channel.
-                                    int lineCenterY = fabs(((tallestLine1[0] - tallestLine1[2]) / 2) - ((tallestLine2[0] - tallestLine2[2]) / 2));
-                                    // If center line is not close to the center of the screen, then don't draw and output zero.
-                                    if (fabs(lineCenterX) < centerLineTolerance)
-                                    {
-                                        // Draw the two tallest line segments and the center line.
-                                        line(finalImg, Point(tallestLine2[0], tallestLine2[1]), Point(tallestLine2[2], tallestLine2[3]), Scalar(255, 0, 0), 3, LINE_4, 0);
-                                        line(finalImg, Point(tallestLine1[0], tallestLine1[1]), Point(tallestLine1[2], tallestLine1[3]), Scalar(255, 0, 0), 3, LINE_4, 0);
-                                        line(finalImg, Point(centerLine[0], centerLine[1]), Point(centerLine[2], centerLine[3]), Scalar(0, 200, 0), 3, LINE_4, 0);
-                                        
-                                        // Push position of tracked target.
-                                        targetCenterX = lineCenterX;
-                                        targetCenterY = lineCenterY;
-                                    }
-                                    else
-                                    {
-                                        // Push a default center values.
-                                        targetCenterX = 0;
-                                        targetCenterY = -1;
-                                    }
-
-                                    // // Store/convert the hulls contours into a Mat.
-                                    // Mat mEdgeImg = Mat::zeros(finalImg.size(), CV_8UC1);
-                                    // polylines(mEdgeImg, hulls, true, Scalar(255, 255, 255), 8);
-                                    // mEdgeImg.copyTo(dilateImg);
-                                    // // drawContours(mEdgeImg, hulls, -1, Scalar(255, 255, 255), 1, LINE_4);
-
-                                    // // Setup HoughLinesP function variables.
-                                    // double dRHO = 1;									// Distance resolution in pixels of the hough grid.
-                                    // double dTheta = PI / 30;							// Angular resolution in radians of the hough grid.
-                                    // int nThreshold = 30;								// Minimum number of votes.
-                                    // double dMinLineLength = 50;							// Minimum number of pixels making up a line.
-                                    // double dMaxLineGap = 50;							// Maximum gap in pixels between connectable line segments.
-                                    // // Use HoughLinesP algorithm to detect potential line segments.
-                                    // vector<Vec4i> lines;
-                                    // HoughLinesP(mEdgeImg, lines, dRHO, dTheta, nThreshold, dMinLineLength, dMaxLineGap);
-
-                                    // // Draw the detected lines.
-                                    // for (Vec4i line : lines)
-                                    // {
-                                    // 	// Draw line.
-                                    // 	line(finalImg, Point(line[0], line[1]), Point(line[2], line[3]), Scalar(0, 0, 255), 4, LINE_4, 0);
-                                    // }
-                                    
-                                    // Sort array based on coordinates (leftmost to rightmost) to make sure contours are adjacent.
-                                    // sort(vBiggestContours.begin(), vBiggestContours.end(), [](const vector<double>& points1, const vector<double>& points2) { return points1[0] < points2[0]; }); 		// Sorts using nCX location.	
+                                    polylines(finalImg, contours.GetHull(candidate.index), true, Scalar(255, 255, 210), 1);
                                 }
                             }
-                            else
+
+                            // Find the two walls and the center between them.
+                            trenchBounds = TrackTrenchCenter(finalImg, centerLineTolerance, targetCenterX, targetCenterY);
+                        }
+                    }
+                    else
+                    {
+                        // No contours to track. Output zero.
+                        targetCenterX = 0;
+                        targetCenterY = -1;
+                    }
+                }
+
+                // Keep searching near the walls while they're found.
+                if (trenchBounds.empty())
+                {
+                    trenchRegion.Miss();
+                }
+                else
+                {
+                    trenchRegion.Hit(trenchBounds);
+                    AddTargetMeasurement(0, Point2d(targetCenterX, targetCenterY));
+                }
+                break;
+            }    
+
+            /****************************************************
+            *			Track fish net line target
+            *****************************************************/
+            case LINE_TRACKING:
+            {
+                // Create instance variables.
+                int scanlineCount = lineScanlineCount.load(memory_order_relaxed);
+                verticalLinePoints.clear();
+                horizontalLinePoints.clear();
+                verticalLineBounds.clear();
+                horizontalLineBounds.clear();
+                trackbarLabeler.SetColorRange(Scalar(trackbarValues[0], trackbarValues[2], trackbarValues[4]), Scalar(trackbarValues[1], trackbarValues[3], trackbarValues[5]));
+
+                // Only search around where the line was last found, unless it's time for a full scan.
+                if (predictRegion)
+                {
+                    searchRegion = lineRegion.Predict(frame.size());
+                }
+                isNarrowed = LimitToChangedRegion(lineRegion);
+
+                // Look for the line both ways every frame. Only filter the frame around a few scanlines, if asked to.
+                if (scanlineCount > 0)
+                {
+                    stage.Next("scanlines");
+                    FindLineScanlines(frame, searchRegion, true, scanlineCount, contourAreaMinLimit, contourAreaMaxLimit);
+                    FindLineScanlines(frame, searchRegion, false, scanlineCount, contourAreaMinLimit, contourAreaMaxLimit);
+                }
+                else
+                {
+                    // Blur, filter out specific color in image, remove small blobs and "inflate" what's left, all in one pass over the frame. The HSV range is looked up straight from BGR, so there is no HSV image. The frame can be shrunk down a pyramid level first.
+                    stage.Next("threshold");
+                    trackbarLabeler.FilterImage(GetSearchImage(frame), dilateMask);
+
+                    // Measure the row and column strips together in one pass over the mask. The strips are still cut from the whole frame.
+                    stage.Next("strips");
+                    MeasureLineStrips(dilateMask, searchRegion.tl(), 1 << searchLevel, frame.size(), contourAreaMinLimit, contourAreaMaxLimit);
+                }
+
+                // Keep whichever way found more of the line. Ties keep the last way, so a diagonal line doesn't flicker between them.
+                if (verticalLinePoints.size() != horizontalLinePoints.size())
+                {
+                    lineIsVertical = verticalLinePoints.size() > horizontalLinePoints.size();
+                }
+                vector<Point> &linePoints = lineIsVertical ? verticalLinePoints : horizontalLinePoints;
+                vector<Rect> &lineBounds = lineIsVertical ? verticalLineBounds : horizontalLineBounds;
+
+                // Draw what each point was found from and its center onto image. OpenCV allocates inside circle for thick outlines.
+                stage.Next("overlay");
+                {
+                    LibraryAllocations libraryAllocations;
+                    for (int i = 0; i < int(linePoints.size()); i++)
+                    {
+                        rectangle(finalImg, lineBounds[i], Scalar(50, 200, 50), 3);
+                        circle(finalImg, linePoints[i], 4, Scalar(255, 255, 255), 5);
+                    }
+                }
+
+                // Draw a line between each circle.
+                for (int i = 1; i < int(linePoints.size()); i++)
+                {
+                    // Draw.
+                    line(finalImg, linePoints[i - 1], linePoints[i], Scalar(255, 0, 0), LINE_4);
+                }
+
+                // Keep searching near the line while it's found.
+                if (linePoints.empty())
+                {
+                    lineRegion.Miss();
+                }
+                else
+                {
+                    Rect lineTargetBounds = lineBounds[0];
+                    Point2d lineCenter(0.0, 0.0);
+                    for (int i = 0; i < int(linePoints.size()); i++)
+                    {
+                        lineTargetBounds |= lineBounds[i];
+                        lineCenter += Point2d(linePoints[i]);
+                    }
+                    lineRegion.Hit(lineTargetBounds);
+
+                    // Filter the middle of the line's points, keeping vertical and horizontal lines apart.
+                    AddTargetMeasurement(lineIsVertical ? 0 : 1, lineCenter / double(linePoints.size()));
+                }
+
+                // Send line tracking data to main thread if not empty.
+                if (!linePoints.empty())
+                {
+                    // Send whether line is vertical is horizontal.
+                    trackingResults.emplace_back(lineIsVertical);
+
+                    // Send data point data.
+                    for (Point point : linePoints)
+                    {
+                        // Append x, y data in pairs in sequence.
+                        trackingResults.emplace_back(point.x);
+                        trackingResults.emplace_back(point.y);
+                    }
+                }
+                break;
+            }
+
+            /****************************************************
+            *	Track dead and alive fish with YOLO neural network
+            *****************************************************/
+            case FISH_TRACKING:
+            {
+                // Get the frame width and length.
+                stage.Next("blobFromImage");
+                int frameWidth = frame.cols;
+                int frameHeight = frame.rows;
+
+                // The dnn module allocates inside all of its calls no matter what buffers it gets.
+                {
+                    LibraryAllocations libraryAllocations;
+
+                    // Resize to 640x640, normalize to [0,1] and swap red and blue channels. This creates a 4D blob from the image.
+                    cv::dnn::blobFromImage(frame, blobImg, 1.0 / 255.0, Size(DNN_MODEL_IMAGE_SIZE, DNN_MODEL_IMAGE_SIZE), Scalar(), true, false);
+                    // Set the model's current input image.
+                    onnxModel.setInput(blobImg);
+
+                    // Forward image through model layers and get the resulting predictions. This is the heavy comp shit.
+                    stage.Next("forward");
+                    if (outputLayerNames.empty())
+                    {
+                        outputLayerNames = onnxModel.getUnconnectedOutLayersNames();
+                    }
+                    onnxModel.forward(predictions, outputLayerNames);
+                    // const Mat &outputs = predictions[0];
+                }
+                
+                // Get image and model width and height ratios.
+                stage.Next("decode");
+                double widthFactor = double(frameWidth) / DNN_MODEL_IMAGE_SIZE;
+                double heightFactor = double(frameHeight) / DNN_MODEL_IMAGE_SIZE;
+                // Get class and detection data from output result.
+                float *data = (float*)predictions[0].data;
+                // Clear the buffers for storing data while looping through detections. They are reserved for every prediction, so they never grow.
+                classIDs.clear();
+                confidences.clear();
+                predictionBoxes.clear();
+                // Loop through each prediction. This array has 25,200 positions where each position is upto 85-length 1D array. 
+                // Each 1D array holds the data of one detection. The 4 first positions of this array are the xywh coordinates 
+                // of the bound box rectangle. The fifth position is the confidence level of that detection. The 6th up to 85th 
+                // elements are the scores of each class. For COCO with 80 classes outputs will be shape(n,85) with 
+                // 85 dimension = (x,y,w,h,object_conf, class0_conf, class1_conf, ...)
+                // I'm using ++i because it actually avoids a copy every iteration.
+                for (int i = 0; i < DNN_MAX_PREDICTIONS; ++i) {
+                    // Get the current prediction confidence.
+                    float confidence = data[4];
+
+                    // Check if the confidence is above a certain threashold.
+                    if (confidence >= DNN_MINIMUM_CONFIDENCE) {
+                        // Get just the class scores from the data array. Stupid pointer manipulation
+                        float *classesScores = data + 5;
+
+                        // Find the class id with the max score for each detection.
+                        int classID = int(max_element(classesScores, classesScores + classList.size()) - classesScores);
+                        double maxClassScore = classesScores[classID];
+                        if (maxClassScore > DNN_MINIMUM_CLASS_SCORE) {
+                            // Add confidence and class ID to vector arrays.
+                            confidences.push_back(confidence);
+                            classIDs.push_back(classID);
+
+                            // Get box data for detection.
+                            float x = data[0];
+                            float y = data[1];
+                            float w = data[2];
+                            float h = data[3];
+                            // Calculate four corner points.
+                            int left = int((x - 0.5 * w) * widthFactor);
+                            int top = int((y - 0.5 * h) * heightFactor);
+                            int width = int(w * widthFactor);
+                            int height = int(h * heightFactor);
+                            // Add CV rect to vector array.
+                            predictionBoxes.push_back(Rect(left, top, width, height));
+                        }
+                    }
+
+                    // Completely wrap offset data array by the total length of one row.
+                    data += classList.size() + 5;
+                }
+
+                // Remove duplicate detections/average them out.
+                stage.Next("NMSBoxes");
+                finalDetections.clear();
+                {
+                    LibraryAllocations libraryAllocations;
+                    cv::dnn::NMSBoxes(predictionBoxes, confidences, DNN_MINIMUM_CLASS_SCORE, DNN_NMS_THRESH, NMSResults);
+                }
+                for (int i = 0; i < NMSResults.size(); i++) {
+                    int idx = NMSResults[i];
+                    Detection result;
+                    result.classID = classIDs[idx];
+                    result.confidence = confidences[idx];
+                    result.box = predictionBoxes[idx];
+                    finalDetections.push_back(result);
+                }
+
+                // Loop through the detections and draw overlay onto final image.
+                stage.Next("overlay");
+                for (const Detection &detection : finalDetections)
+                {
+                    // Get detection info.
+                    int classID = detection.classID;
+                    float confidence = detection.confidence;
+                    Rect detectionBox = detection.box;
+                    Scalar color = DETECTION_COLORS[classID % DETECTION_COLORS.size()];
+
+                    // Draw detection
+                    rectangle(finalImg, detectionBox, color, 3);
+                    rectangle(finalImg, Point(detectionBox.x, detectionBox.y - 20), Point(detectionBox.x + detectionBox.width, detectionBox.y), color, FILLED);
+                    LibraryAllocations libraryAllocations;
+                    putText(finalImg, classList[classID], Point(detectionBox.x, detectionBox.y - 5), FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0, 0, 0));
+                }
+
+                // Filter the center of each class's most confident detection.
+                for (const Detection &detection : finalDetections)
+                {
+                    AddTargetMeasurement(detection.classID, (Point2d(detection.box.tl()) + Point2d(detection.box.br())) / 2.0, detection.confidence);
+                }
+
+                break;
+            }
+
+            /****************************************************
+            *			Track box tape targets
+            *****************************************************/
+            case TAPE_TRACKING:
+            { 
+                // Blur, label every pixel with the tape colors it matches and dilate them, all in one pass straight from BGR. (blue, yellow, green, purple, red, pink, orange)
+                // Only the part of the frame around where the tape was last found is labeled, unless it's time for a full scan. The label image stays the size of the frame.
+                stage.Next("threshold");
+                if (predictRegion)
+                {
+                    searchRegion = tapeRegion.Predict(frame.size());
+                }
+                isNarrowed = LimitToChangedRegion(tapeRegion);
+
+                // Label a shrunk copy of the search region instead, if set to a pyramid level. Its labels go in their own image, which starts at the region's corner.
+                Mat searchImg = GetSearchImage(frame);
+                int scale = 1 << searchLevel;
+                Mat &searchLabelsImg = (searchLevel > 0) ? pyramidLabelImg : labelImg;
+                Point labelOffset = (searchLevel > 0) ? Point(0, 0) : searchRegion.tl();
+                searchLabelsImg.create((searchLevel > 0) ? pyramidImg.size() : frame.size(), CV_8UC1);
+                Mat searchLabelImg = searchLabelsImg(Rect(labelOffset, searchImg.size()));
+                tapeLabeler.LabelImage(searchImg, searchLabelImg);
+
+                // Keep a copy of each color's stats, since refining a strip labels again and replaces the labeler's own.
+                tapeStats.assign(tapeLabeler.GetStats().begin(), tapeLabeler.GetStats().end());
+                const vector<LabelStats> &labelStats = tapeStats;
+
+                // Find countours of every tape color at the same time, each in just the area that color covers and offset back into frame coordinates. Colors that aren't in the frame get no contours.
+                stage.Next("findContours");
+                ThreadPool::Get().ParallelFor(int(labelStats.size()), [&](int index) {
+                    // Size every color's mask, not just the ones in this frame, so a color showing up later doesn't allocate.
+                    colorMaskImgs[index].create(searchLabelsImg.size(), CV_8UC1);
+                    colorContours[index].Clear();
+                    if (labelStats[index].pixelCount > 0)
+                    {
+                        Mat colorMaskImg = tapeLabeler.GetColorMask(searchLabelsImg, index, colorMaskImgs[index], labelOffset);
+                        colorContours[index].Find(colorMaskImg, labelStats[index].bounds.tl() * scale + searchRegion.tl(), scale);
+                    }
+                });
+
+                // Loop through the tape colors and find the biggest blob of each one that was seen.
+                tapeObjects.clear();
+                for (int index = 0; index < int(labelStats.size()); index++)
+                {
+                    // Skip colors that aren't in the frame.
+                    const vector<Scalar> &colorRange = colorRanges[index];
+                    if (colorContours[index].GetCount() == 0)
+                    {
+                        continue;
+                    }
+
+                    // Find the biggest contour whose area meets the limits.
+                    stage.Next("hull/sort");
+                    int biggestIndex = colorContours[index].GetBiggest(contourAreaMinLimit, contourAreaMaxLimit);
+
+                    // Check if we have detected one or more contours.
+                    if (biggestIndex >= 0)
+                    {
+                        // A strip found on a pyramid level is found again at full size, just inside its coarse box, so its corners are exact. The whole frame is never labeled at full size.
+                        const vector<Point>* tapePoints = &colorContours[index].GetPoints(biggestIndex);
+                        if (searchLevel > 0)
+                        {
+                            stage.Next("refine");
+                            const Rect &coarseBounds = colorContours[index].GetBounds(biggestIndex);
+                            Point padding(TAPE_REFINE_PADDING * scale, TAPE_REFINE_PADDING * scale);
+                            Rect refineRegion = Rect(coarseBounds.tl() - padding, coarseBounds.br() + padding) & Rect(Point(0, 0), frame.size());
+                            labelImg.create(frame.size(), CV_8UC1);
+                            Mat refineLabelImg = labelImg(refineRegion);
+                            tapeLabeler.LabelImage(frame(refineRegion), refineLabelImg);
+                            const vector<LabelStats> &refineStats = tapeLabeler.GetStats();
+                            refineContours.Clear();
+                            if (refineStats[index].pixelCount > 0)
+                            {
+                                Mat refineMask = tapeLabeler.GetColorMask(labelImg, index, refineMaskImg, refineRegion.tl());
+                                refineContours.Find(refineMask, refineStats[index].bounds.tl() + refineRegion.tl());
+                            }
+                            int refinedIndex = refineContours.GetBiggest(contourAreaMinLimit, contourAreaMaxLimit);
+                            if (refinedIndex >= 0)
                             {
-                                // No contours to track. Output zero.
-                                targetCenterX = 0;
-                                targetCenterY = -1;
+                                tapePoints = &refineContours.GetPoints(refinedIndex);
                             }
-                            break;
-                        }    
+                        }
+
+                        // Find the rotated bounding rect of only the biggest contour. OpenCV allocates inside minAreaRect for the hull.
+                        stage.Next("overlay");
+                        RotatedRect minRect;
+                        {
+                            LibraryAllocations libraryAllocations;
+                            minRect = minAreaRect(*tapePoints);
+                        }
+                        Point2f rectPoints[4];
+                        minRect.points(rectPoints);
+                        // Draw the rotated rect in the color of current color range.
+                        for (int i = 0; i < 4; i++)
+                        {
+                            line(finalImg, rectPoints[i], rectPoints[(i + 1) % 4], colorRange[2], LINE_4);
+                        }
+
+                        // Store the currently detected tape and its color index (into colors), so we can do calculations later.
+                        tapeObjects.push_back({index, minRect});
+                    }
+                }
+
+                // Sort the tapeObjects based on x position from left to right using comparator function.
+                stage.Next("hull/sort");
+                sort(tapeObjects.begin(), tapeObjects.end(), [](const TapeObject& t1, const TapeObject& t2) { return t1.rect.center.x < t2.rect.center.x; });
+
+                // Keep searching near the tape while any of it is found.
+                Rect tapeBounds;
+                for (const TapeObject &object : tapeObjects)
+                {
+                    tapeBounds |= object.rect.boundingRect();
+                    AddTargetMeasurement(object.colorIndex, Point2d(object.rect.center));
+                }
+                if (tapeBounds.empty())
+                {
+                    tapeRegion.Miss();
+                }
+                else
+                {
+                    tapeRegion.Hit(tapeBounds);
+                }
+
+                // Grab the current frame and crop the image down to just the side of the box.
+                stage.Next("overlay");
+                if (takeShapshot)
+                {
+                    // Combine all of the tape objects into one large contour.
+                    boundingContour.clear();
+                    for (const TapeObject &object : tapeObjects)
+                    {
+                        // Store the tape objects points
+                        Point2f points[4];
+                        object.rect.points(points);
+
+                        // Grab all points from the RotatedRect and add them to temporary contour.
+                        for (Point2f point : points)
+                            boundingContour.push_back(point);
+                    }
+
+                    if (boundingContour.size() >= 1)
+                    {
+                        // Find the convex hull of the new combined contour.
+                        Rect cropContour = boundingRect(boundingContour);
+                        // Finally, make sure the boundingContour is within frame, and then crop.
+                        Mat croppedImg = finalImg(cropContour);
+                        // Copy cropped image to finalImg.
+                        croppedImg.copyTo(finalImg);
+                    }
+                }
+
+                // This section of code is for the future.
+                // This is for tracking the chessboard.
+                // vector<Point2f> vImagePoints;
+                // vImagePoints.emplace_back(Point2f(0.0, 0.0));
+                // int targetPositionX = 0; 
+                // int targetPositionY = 0;
+                // solvePNPValues = SolveObjectPose(vImagePoints, ref(finalImg), ref(frame), targetPositionX, targetPositionY);
+                break;
+            }
+        }
+    }
+
+    // Outline the part of the frame that was searched, when it wasn't all of it.
+    bool isFullSearch = searchRegion == Rect(Point(0, 0), frame.size());
+    if (!isFullSearch)
+    {
+        rectangle(finalImg, searchRegion, Scalar(128, 128, 128), 1);
+    }
+
+    // Remember what was searched and what was drawn, for the change gate. Only full searches go into the typical frame time that skipped and narrowed frames are measured against.
+    if (isChangeGated)
+    {
+        stage.Next("changeGate");
+        changeDetector.MarkSearched(searchRegion);
+        finalImg.copyTo(lastFinalImg);
+        gatedFrameCount = isNarrowed ? gatedFrameCount + 1 : 0;
+
+        uint64_t frameTime = Now() - startTime;
+        gateSpentTime += frameTime;
+        if (isFullSearch)
+        {
+            fullFrameTime = (fullFrameTime > 0.0) ? fullFrameTime + CHANGE_TIME_SMOOTHING * (frameTime - fullFrameTime) : double(frameTime);
+        }
+        else if (isNarrowed && fullFrameTime > frameTime)
+        {
+            gateSavedTime += uint64_t(fullFrameTime - frameTime);
+        }
+    }
+
+    return true;
+}
+
+/****************************************************************************
+        Description:	The change gate. Settings that change what a mode
+                        finds make the whole frame stale, then the parts of
+                        the frame that changed since they were last searched
+                        are found. If none did, the last frame's drawing is
+                        copied out and the frame is skipped, so the last
+                        frame's tracking results and targets stand. Every
+                        CHANGE_MAX_GATED_FRAMES skipped or narrowed frames
+                        in a row, the whole frame is searched anyway, since
+                        a small target can move without changing its tile
+                        much.
+
+        Arguments: 		MAT&, MAT&, INT, DOUBLE, DOUBLE, VECTOR<INT>&
+
+        Returns: 		BOOL (true if the frame was skipped)
+****************************************************************************/
+bool VideoProcess::SkipUnchangedFrame(Mat &frame, Mat &finalImg, int centerLineTolerance, double contourAreaMinLimit, double contourAreaMaxLimit, vector<int> &trackbarValues)
+{
+    // Create instance variables.
+    uint64_t startTime = Now();
+    int scanlineCount = lineScanlineCount.load(memory_order_relaxed);
+    bool trenchColumns = useTrenchColumns.load(memory_order_relaxed);
+    int level = pyramidLevel.load(memory_order_relaxed);
+
+    // Start over if anything that changes the results was changed.
+    if (trackbarValues != gateTrackbarValues || centerLineTolerance != gateTolerance || contourAreaMinLimit != gateAreaMinLimit || contourAreaMaxLimit != gateAreaMaxLimit ||
+        scanlineCount != gateScanlineCount || trenchColumns != gateTrenchColumns || level != gatePyramidLevel)
+    {
+        changeDetector.Reset();
+        gateTrackbarValues.assign(trackbarValues.begin(), trackbarValues.end());
+        gateTolerance = centerLineTolerance;
+        gateAreaMinLimit = contourAreaMinLimit;
+        gateAreaMaxLimit = contourAreaMaxLimit;
+        gateScanlineCount = scanlineCount;
+        gateTrenchColumns = trenchColumns;
+        gatePyramidLevel = level;
+    }
+
+    // Find what changed since it was last searched.
+    changeDetector.Measure(frame);
+    changedRegion = changeDetector.GetChangedRegion();
+    gateCheckedFrames++;
+
+    // Nothing changed, so the last frame still holds.
+    if (changedRegion.empty() && gatedFrameCount < CHANGE_MAX_GATED_FRAMES && lastFinalImg.size() == frame.size())
+    {
+        lastFinalImg.copyTo(finalImg);
+        gatedFrameCount++;
+        gateSkippedFrames++;
+
+        uint64_t gateTime = Now() - startTime;
+        gateSpentTime += gateTime;
+        if (fullFrameTime > gateTime)
+        {
+            gateSavedTime += uint64_t(fullFrameTime - gateTime);
+        }
+        return true;
+    }
+
+    // Search it all if it's time to, otherwise a little past the tiles that changed.
+    if (changedRegion.empty() || gatedFrameCount >= CHANGE_MAX_GATED_FRAMES)
+    {
+        changedRegion = Rect(Point(0, 0), frame.size());
+    }
+    else
+    {
+        changedRegion = Rect(changedRegion.tl() - Point(CHANGE_REGION_PADDING, CHANGE_REGION_PADDING), changedRegion.br() + Point(CHANGE_REGION_PADDING, CHANGE_REGION_PADDING)) & Rect(Point(0, 0), frame.size());
+    }
+
+    return false;
+}
+
+/****************************************************************************
+        Description:	Shrinks the search region down to the part of the
+                        frame that changed, when the mode has no target.
+                        The rest was searched with nothing found, and
+                        hasn't changed since. A tracked target is still
+                        searched for around where it was, since it could
+                        be sitting in a part that hasn't changed.
+
+        Arguments: 		REGIONPREDICTOR&
+
+        Returns: 		BOOL (true if the search region was shrunk)
+****************************************************************************/
+bool VideoProcess::LimitToChangedRegion(RegionPredictor &predictor)
+{
+    if (!isChangeGated || predictor.HasTarget())
+    {
+        return false;
+    }
+
+    Rect narrowedRegion = searchRegion & changedRegion;
+    if (narrowedRegion == searchRegion)
+    {
+        return false;
+    }
+
+    searchRegion = narrowedRegion;
+    gateNarrowedFrames++;
+    return true;
+}
+
+/****************************************************************************
+        Description:	Gets the search region of the frame to threshold,
+                        shrunk down the pyramid level with area averaging
+                        if one is set. searchLevel is set to the level
+                        used, which is 0 if the region would come out
+                        smaller than PYRAMID_MIN_SIZE. At a level,
+                        searchRegion is grown to a multiple of its scale
+                        first, so nothing found drifts when it's scaled
+                        back up. The shrunk image is a view into
+                        pyramidImg, which stays the frame's size at that
+                        level, so a moving region never reallocates it.
+
+        Arguments: 		MAT&
+
+        Returns: 		MAT (a view of the frame or of pyramidImg)
+****************************************************************************/
+Mat VideoProcess::GetSearchImage(Mat &frame)
+{
+    // Create instance variables.
+    searchLevel = pyramidLevel.load(memory_order_relaxed);
+    int scale = 1 << searchLevel;
+    Size searchSize(searchRegion.width >> searchLevel, searchRegion.height >> searchLevel);
+
+    if (searchLevel == 0 || searchSize.width < PYRAMID_MIN_SIZE || searchSize.height < PYRAMID_MIN_SIZE)
+    {
+        searchLevel = 0;
+        return frame(searchRegion);
+    }
+
+    // Grow the region to a whole number of pyramid pixels, so it shrinks by exactly the scale everything is scaled back up by. It's moved back inside the frame if that pushes it past an edge.
+    int width = min((searchRegion.width + scale - 1) & ~(scale - 1), frame.cols & ~(scale - 1));
+    int height = min((searchRegion.height + scale - 1) & ~(scale - 1), frame.rows & ~(scale - 1));
+    searchRegion = Rect(min(searchRegion.x, frame.cols - width), min(searchRegion.y, frame.rows - height), width, height);
+    searchSize = Size(width / scale, height / scale);
+
+    // OpenCV can allocate inside resize for its tables.
+    pyramidImg.create(Size(frame.cols >> searchLevel, frame.rows >> searchLevel), frame.type());
+    Mat searchImg = pyramidImg(Rect(Point(0, 0), searchSize));
+    {
+        LibraryAllocations libraryAllocations;
+        resize(frame(searchRegion), searchImg, searchSize, 0, 0, INTER_AREA);
+    }
+
+    return searchImg;
+}
+
+/****************************************************************************
+        Description:	Finds the trench walls from trenchProjection. Each
+                        run of touching columns that have mask pixels is
+                        one wall candidate, its area the pixels in those
+                        columns. Its top and bottom are the top and bottom
+                        of the longest vertical runs in its columns, so a
+                        leaning wall gets a leaning line, like a hull's
+                        extremes.
+
+                        The offset is where the projected part of the
+                        frame starts, and is added to every wall. A mask
+                        shrunk down a pyramid level gives its scale, and
+                        the walls are measured in full size pixels.
+
+        Arguments: 		POINT, INT, DOUBLE, DOUBLE
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::FindTrenchWalls(Point offset, int scale, double contourAreaMinLimit, double contourAreaMaxLimit)
+{
+    // Create instance variables.
+    const vector<uint16_t> &counts = trenchProjection.counts;
+    const vector<uint16_t> &longestRuns = trenchProjection.longestRuns;
+    const vector<uint16_t> &longestEnds = trenchProjection.longestEnds;
+    int width = counts.size();
+    hullCandidates.clear();
+
+    for (int x = 0; x < width;)
+    {
+        // Skip empty columns.
+        if (counts[x] == 0)
+        {
+            x++;
+            continue;
+        }
+
+        // Gather the touching columns. Every column with a pixel has a run at least one long.
+        int first = x;
+        int area = 0;
+        Point top(x, INT_MAX);
+        Point bottom(x, -1);
+        for (; x < width && counts[x] > 0; x++)
+        {
+            int runTop = longestEnds[x] - longestRuns[x] + 1;
+            area += counts[x];
+            if (runTop < top.y)
+            {
+                top = Point(x, runTop);
+            }
+            if (longestEnds[x] > bottom.y)
+            {
+                bottom = Point(x, longestEnds[x]);
+            }
+        }
+
+        area *= scale * scale;
+        if (area >= contourAreaMinLimit && area <= contourAreaMaxLimit)
+        {
+            top = top * scale + offset;
+            bottom = bottom * scale + offset;
+            hullCandidates.push_back({first * scale + offset.x, double(area), Vec4i(top.x, top.y, bottom.x, bottom.y)});
+        }
+    }
+
+    // Sort walls from biggest to smallest, the same as the hulls.
+    sort(hullCandidates.begin(), hullCandidates.end(), [](const HullCandidate& c1, const HullCandidate& c2) { return c1.area > c2.area; });
+}
 
-                        /****************************************************
-                        *			Track fish net line target
-                        *****************************************************/
-                        case LINE_TRACKING:
-                        {
-                            // Create instance variables.
-                            int numberOfVerticalSplits = 8;
-                            int numberOfHorizontalSplits = 8;
-                            int splitSize = 0;
-                            int oppositeScreenRes = 0;
-                            static bool screenSplitToggle = false;
-                            vector<Point> linePoints;
-
-                            // Convert image from RGB to HSV.
-                            cvtColor(frame, HSVImg, COLOR_BGR2HSV);
-                            // Blur the image.
-                            blur(HSVImg, blurImg, Size(GREEN_BLUR_RADIUS, GREEN_BLUR_RADIUS));
-                            // Filter out specific color in image.
-                            inRange(blurImg, Scalar(trackbarValues[0], trackbarValues[2], trackbarValues[4]), Scalar(trackbarValues[1], trackbarValues[3], trackbarValues[5]), filterImg);
-                            // Remove small blobs.
-                            erode(filterImg, dilateImg, KERNEL);
-                            // "Inflate" image.
-                            dilate(dilateImg, dilateImg, KERNEL);
-                            
-                            // Determine whether we are looking at a vertical or horizontal line.
-                            vector<Mat> splitImages;
-                            if (screenSplitToggle)
-                            {
-                                // Set splitSize for vertical screen.
-                                splitSize = SCREEN_HEIGHT / numberOfVerticalSplits;
-                                oppositeScreenRes = SCREEN_WIDTH;
+/****************************************************************************
+        Description:	Picks the two tallest of the hullCandidates as the
+                        trench walls and finds the center line between
+                        them. targetCenterX is how far the center line is
+                        from the middle of the screen, and targetCenterY
+                        the width of the pipe channel, or 0 and -1 if the
+                        center isn't within centerLineTolerance.
 
-                                // Split image vertically into rectangles.
-                                for (int i = 1; i <= numberOfVerticalSplits; i++)
-                                {
-                                    // Create area template for cropping.
-                                    Rect ROI(0, (splitSize * (i - 1)), oppositeScreenRes, splitSize);
-                                    // Crop image.
-                                    splitImages.emplace_back(dilateImg(ROI));
-                                }
-                            }
-                            else
-                            {
-                                // Set splitSize for horizontal screen.
-                                splitSize = SCREEN_WIDTH / numberOfHorizontalSplits;
-                                oppositeScreenRes = SCREEN_HEIGHT;
+        Arguments: 		MAT&, INT&, INT&, INT&
 
-                                // Split image horizontally into rectangles.
-                                for (int i = 1; i <= numberOfHorizontalSplits; i++)
-                                {
-                                    // Create area template for cropping.
-                                    Rect ROI((splitSize * (i - 1)), 0, splitSize, oppositeScreenRes);
-                                    // Crop image.
-                                    splitImages.emplace_back(dilateImg(ROI));
-                                }
-                            }
+        Returns: 		RECT (around both walls, or empty if not tracked)
+****************************************************************************/
+Rect VideoProcess::TrackTrenchCenter(Mat &finalImg, int &centerLineTolerance, int &targetCenterX, int &targetCenterY)
+{
+    // Create instance variables.
+    Rect wallBounds;
 
-                            // Loop through split images, and find the biggest contours center point.
-                            for (int i = 0; i < splitImages.size(); i++)
-                            {
-                                // Find countours of image.
-                                findContours(splitImages[i], contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
-                                
-                                // 'Round off' all contours with convexHull.
-                                // vector<vector<Point>> hulls;
-                                // for (vector<Point> contour : contours)
-                                // {
-                                //     vector<Point> hull;
-                                //     convexHull(contour, hull);
-                                //     hulls.emplace_back(hull);
-                                // }
-
-                                // Find the biggest contour.
-                                int biggestArea = contourAreaMinLimit;
-                                vector<Point> biggestContour;
-                                for (vector<Point> contour : contours)
-                                {
-                                    // Get current contour area.
-                                    int area = contourArea(contour);
-                                    // If bigger than last one, store it.
-                                    if (area > biggestArea)
-                                    {
-                                        // Set new biggest area.
-                                        biggestArea = area;
-                                        // Store new biggest contour.
-                                        biggestContour = contour;
-                                    }
-                                }
+    // Now that we have the lines, find the tallest one.
+    int minLineLength = 50;
+    Vec4i tallestLine1(0, 0, 0, minLineLength);
+    for (const HullCandidate &candidate : hullCandidates)
+    {
+        // Compare the y distance of the line to the currently stored biggest one.
+        const Vec4i &line = candidate.extremes;
+        if ((line[3] - line[1]) > (tallestLine1[3] - tallestLine1[1]))
+        {
+            tallestLine1 = line;
+        }
+    }
 
-                                if (!biggestContour.empty())
-                                {
-                                    // Find the center point of biggest contour.
-                                    Moments moment = moments(biggestContour, true);
-                                    Point center(moment.m10 / moment.m00, moment.m01 / moment.m00);
-                                    
-                                    // Draw locations are different depending on whether we are splitting vertically or horizontally.
-                                    if (screenSplitToggle)
-                                    {
-                                        // Check if current circle is close enough to last point before appending.
-                                        if (linePoints.empty() || fabs(center.x - linePoints[linePoints.size() - 1].x) < contourAreaMaxLimit)
-                                        {
-                                            // Append center circle to array.
-                                            linePoints.emplace_back(Point(center.x, (center.y + (splitSize * i))));
-
-                                            // Draw contour outline and center onto image.
-                                            polylines(finalImg(Rect(0, (splitSize * i), oppositeScreenRes, splitSize)), biggestContour, true, Scalar(50, 200, 50), 3); 
-                                            circle(finalImg(Rect(0, (splitSize * i), oppositeScreenRes, splitSize)), center, 4, Scalar(255, 255, 255), 5);
-                                        }
-                                    }
-                                    else
-                                    {
-                                        // Check if current circle is close enough to last point before appending.
-                                        if (linePoints.empty() || fabs(center.y - linePoints[linePoints.size() - 1].y) < contourAreaMaxLimit)
-                                        {
-                                            // Append center circle to array.
-                                            linePoints.emplace_back(Point((center.x + (splitSize * i)), center.y));
-
-                                             // Draw contour outline and center onto image.
-                                            polylines(finalImg(Rect((splitSize * i), 0, splitSize, oppositeScreenRes)), biggestContour, true, Scalar(50, 200, 50), 3); 
-                                            circle(finalImg(Rect((splitSize * i), 0, splitSize, oppositeScreenRes)), center, 4, Scalar(255, 255, 255), 5);
-                                        }
-                                    }
-                                }
-                            }
+    // Find the next tallest line segment, skipping the one we just found.
+    Vec4i tallestLine2(SCREEN_WIDTH, 0, SCREEN_WIDTH, minLineLength);
+    for (const HullCandidate &candidate : hullCandidates)
+    {
+        // Compare the y distance of the line to the currently stored biggest one.
+        const Vec4i &line = candidate.extremes;
+        if (line != tallestLine1 && (line[3] - line[1]) > (tallestLine2[3] - tallestLine2[1]))
+        {
+            tallestLine2 = line;
+        }
+    }
 
-                            // Draw a line between each circle.
-                            for (int i = 1; i < linePoints.size(); i++)
-                            {
-                                // Draw.
-                                line(finalImg, linePoints[i - 1], linePoints[i], Scalar(255, 0, 0), LINE_4);
-                            }
+    // Find the center line.
+    Vec4i centerLine;
+    if (tallestLine1[0] < tallestLine2[0])
+    {
+        centerLine = Vec4i((tallestLine1[0] + ((tallestLine2[0] - tallestLine1[0]) / 2)), tallestLine1[1], (tallestLine1[2] + ((tallestLine2[2] - tallestLine1[2]) / 2)), tallestLine1[3]);
+    }
+    else
+    {
+        centerLine = Vec4i((tallestLine2[0] + ((tallestLine1[0] - tallestLine2[0]) / 2)), tallestLine1[1], (tallestLine2[2] + ((tallestLine1[2] - tallestLine2[2]) / 2)), tallestLine1[3]);
+    }
 
-                            // Send line tracking data to main thread if not empty.
-                            if (!linePoints.empty())
-                            {
-                                // Send whether line is vertical is horizontal.
-                                trackingResults.emplace_back(screenSplitToggle);
+    // Calculate the X center of the center line.
+    int lineCenterX = (((centerLine[0] - centerLine[2]) / 2) + centerLine[2]) - (SCREEN_WIDTH / 2);
+    // Calculate the width of the pipe channel.
+    int lineCenterY = fabs(((tallestLine1[0] - tallestLine1[2]) / 2) - ((tallestLine2[0] - tallestLine2[2]) / 2));
+    // If center line is not close to the center of the screen, then don't draw and output zero.
+    if (fabs(lineCenterX) < centerLineTolerance)
+    {
+        // Draw the two tallest line segments and the center line.
+        line(finalImg, Point(tallestLine2[0], tallestLine2[1]), Point(tallestLine2[2], tallestLine2[3]), Scalar(255, 0, 0), 3, LINE_4, 0);
+        line(finalImg, Point(tallestLine1[0], tallestLine1[1]), Point(tallestLine1[2], tallestLine1[3]), Scalar(255, 0, 0), 3, LINE_4, 0);
+        line(finalImg, Point(centerLine[0], centerLine[1]), Point(centerLine[2], centerLine[3]), Scalar(0, 200, 0), 3, LINE_4, 0);
+        
+        // Push position of tracked target.
+        targetCenterX = lineCenterX;
+        targetCenterY = lineCenterY;
+
+        // The box around both walls is where to look for them next frame. Their lines can be a single pixel wide.
+        Point wallsTopLeft(min({tallestLine1[0], tallestLine1[2], tallestLine2[0], tallestLine2[2]}), min({tallestLine1[1], tallestLine1[3], tallestLine2[1], tallestLine2[3]}));
+        Point wallsBottomRight(max({tallestLine1[0], tallestLine1[2], tallestLine2[0], tallestLine2[2]}), max({tallestLine1[1], tallestLine1[3], tallestLine2[1], tallestLine2[3]}));
+        wallBounds = Rect(wallsTopLeft, wallsBottomRight + Point(1, 1));
+    }
+    else
+    {
+        // Push a default center values.
+        targetCenterX = 0;
+        targetCenterY = -1;
+    }
 
-                                // Send data point data.
-                                for (Point point : linePoints)
-                                {
-                                    // Append x, y data in pairs in sequence.
-                                    trackingResults.emplace_back(point.x);
-                                    trackingResults.emplace_back(point.y);
-                                }
-                            }
+    // // Store/convert the hulls contours into a Mat.
+    // Mat mEdgeImg = Mat::zeros(finalImg.size(), CV_8UC1);
+    // polylines(mEdgeImg, hulls, true, Scalar(255, 255, 255), 8);
+    // mEdgeImg.copyTo(dilateImg);
+    // // drawContours(mEdgeImg, hulls, -1, Scalar(255, 255, 255), 1, LINE_4);
+
+    // // Setup HoughLinesP function variables.
+    // double dRHO = 1;									// Distance resolution in pixels of the hough grid.
+    // double dTheta = PI / 30;							// Angular resolution in radians of the hough grid.
+    // int nThreshold = 30;								// Minimum number of votes.
+    // double dMinLineLength = 50;							// Minimum number of pixels making up a line.
+    // double dMaxLineGap = 50;							// Maximum gap in pixels between connectable line segments.
+    // // Use HoughLinesP algorithm to detect potential line segments.
+    // vector<Vec4i> lines;
+    // HoughLinesP(mEdgeImg, lines, dRHO, dTheta, nThreshold, dMinLineLength, dMaxLineGap);
+
+    // // Draw the detected lines.
+    // for (Vec4i line : lines)
+    // {
+    // 	// Draw line.
+    // 	line(finalImg, Point(line[0], line[1]), Point(line[2], line[3]), Scalar(0, 0, 255), 4, LINE_4, 0);
+    // }
+    
+    // Sort array based on coordinates (leftmost to rightmost) to make sure contours are adjacent.
+    // sort(vBiggestContours.begin(), vBiggestContours.end(), [](const vector<double>& points1, const vector<double>& points2) { return points1[0] < points2[0]; }); 		// Sorts using nCX location.	
 
-                            // Flip-flop between vertical or horizontal splitting if our detected circles is low.
-                            if (linePoints.size() < 3)
-                            {
-                                screenSplitToggle = !screenSplitToggle;
-                            }
-                            break;
-                        }
+    return wallBounds;
+}
 
-                        /****************************************************
-                        *	Track dead and alive fish with YOLO neural network
-                        *****************************************************/
-                        case FISH_TRACKING:
-                        {
-                            // Calculate the frame width, length, and max size.
-                            int frameWidth = frame.cols;
-                            int frameHeight = frame.rows;
-                            int maxRes = MAX(frameWidth, frameHeight);
-                            // Make a new square mat with the masRes size.
-                            Mat resized = Mat::zeros(maxRes, maxRes, CV_8UC3);
-                            // Copy the camera image into the new resized mat.
-                            frame.copyTo(resized(Rect(0, 0, frameWidth, frameHeight)));
-                            // resize(frame, frame, Size(DNN_MODEL_IMAGE_SIZE, DNN_MODEL_IMAGE_SIZE));
-                            
-                            // Resize to 640x640, normalize to [0,1] and swap red and blue channels. This creates a 4D blob from the image.
-                            Mat result;
-                            cv::dnn::blobFromImage(frame, result, 1.0 / 255.0, Size(DNN_MODEL_IMAGE_SIZE, DNN_MODEL_IMAGE_SIZE), Scalar(), true, false);
-                            // Set the model's current input image.
-                            onnxModel.setInput(result);
-
-                            // Forward image through model layers and get the resulting predictions. This is the heavy comp shit.
-                            vector<Mat> predictions;
-                            onnxModel.forward(predictions, onnxModel.getUnconnectedOutLayersNames());
-                            // const Mat &outputs = predictions[0];
-                            
-                            // Get image and model width and height ratios.
-                            double widthFactor = double(frameWidth) / DNN_MODEL_IMAGE_SIZE;
-                            double heightFactor = double(frameHeight) / DNN_MODEL_IMAGE_SIZE;
-                            // Get class and detection data from output result.
-                            float *data = (float*)predictions[0].data;
-                            // Create instance variables for storing data while looping through detections.
-                            vector<int> classIDs;
-                            vector<float> confidences;
-                            vector<Rect> predictionBoxes;
-                            // Loop through each prediction. This array has 25,200 positions where each position is upto 85-length 1D array. 
-                            // Each 1D array holds the data of one detection. The 4 first positions of this array are the xywh coordinates 
-                            // of the bound box rectangle. The fifth position is the confidence level of that detection. The 6th up to 85th 
-                            // elements are the scores of each class. For COCO with 80 classes outputs will be shape(n,85) with 
-                            // 85 dimension = (x,y,w,h,object_conf, class0_conf, class1_conf, ...)
-                            // I'm using ++i because it actually avoids a copy every iteration.
-                            for (int i = 0; i < 25200; ++i) {
-                                // Get the current prediction confidence.
-                                float confidence = data[4];
-
-                                // Check if the confidence is above a certain threashold.
-                                if (confidence >= DNN_MINIMUM_CONFIDENCE) {
-                                    // Get just the class scores from the data array. Stupid pointer manipulation
-                                    float *classesScores = data + 5;
-                                    Mat scores(1, classList.size(), CV_32FC1, classesScores);
-
-                                    // Find the class id with the max score for each detection.
-                                    Point classID;
-                                    double maxClassScore = 0;
-                                    minMaxLoc(scores, 0, &maxClassScore, 0, &classID);
-                                    if (maxClassScore > DNN_MINIMUM_CLASS_SCORE) {
-                                        // Add confidence and class ID to vector arrays.
-                                        confidences.push_back(confidence);
-                                        classIDs.push_back(classID.x);
-
-                                        // Get box data for detection.
-                                        float x = data[0];
-                                        float y = data[1];
-                                        float w = data[2];
-                                        float h = data[3];
-                                        // Calculate four corner points.
-                                        int left = int((x - 0.5 * w) * widthFactor);
-                                        int top = int((y - 0.5 * h) * heightFactor);
-                                        int width = int(w * widthFactor);
-                                        int height = int(h * heightFactor);
-                                        // Add CV rect to vector array.
-                                        predictionBoxes.push_back(Rect(left, top, width, height));
-                                    }
-                                }
+/****************************************************************************
+        Description:	Cuts the mask into MAX_LINE_SPLITS row strips,
+                        which cross a vertical line, and as many column
+                        strips, which cross a horizontal one, and finds
+                        the center of the mask pixels in each from their
+                        moments. Both sets of strips are summed from the
+                        same runs in one pass over the mask, so no
+                        contours are traced at all.
+
+                        Strips with fewer pixels than the area limit are
+                        skipped, and points have to be within the max
+                        limit of the last point.
+
+                        The mask can be just part of the frame, starting
+                        at the offset, and shrunk down a pyramid level by
+                        the scale. Each of its rows then stands for scale
+                        rows of the frame. The strips are always cut from
+                        the whole frame, so they don't move with the part
+                        searched.
+
+        Arguments: 		CONST BITMASK&, POINT, INT, SIZE (of the whole frame), DOUBLE, DOUBLE
 
-                                // Completely wrap offset data array by the total length of one row.
-                                data += classList.size() + 5;
-                            }
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::MeasureLineStrips(const BitMask &mask, Point offset, int scale, Size frameSize, double contourAreaMinLimit, double contourAreaMaxLimit)
+{
+    // Create instance variables.
+    int width = mask.GetWidth();
+    int height = mask.GetHeight();
+    int rowStripSize = max(frameSize.height / MAX_LINE_SPLITS, 1);
+    int columnStripSize = max(frameSize.width / MAX_LINE_SPLITS, 1);
+    int columnsEnd = min(columnStripSize * MAX_LINE_SPLITS, frameSize.width);
+    LineStrip* rowStrips = &lineStrips[0];
+    LineStrip* columnStrips = &lineStrips[MAX_LINE_SPLITS];
+    fill(lineStrips.begin(), lineStrips.end(), LineStrip());
+    lineRuns.resize(width + 1);
+
+    // Adds the pixels [start, end) of row y to a strip. The x values of a run sum to (start + end - 1) * length / 2.
+    auto addRun = [](LineStrip &strip, int start, int end, int y)
+    {
+        int length = end - start;
+        strip.bounds = (strip.area > 0) ? (strip.bounds | Rect(start, y, length, 1)) : Rect(start, y, length, 1);
+        strip.area += length;
+        strip.sumX += int64_t(start + end - 1) * length / 2;
+        strip.sumY += int64_t(y) * length;
+    };
+
+    for (int y = 0; y < height; y++)
+    {
+        int runCount = BitMask::EncodeRuns(mask.GetRow(y), width, lineRuns.data());
+        for (int i = 0; i < runCount; i++)
+        {
+            int start = lineRuns[2 * i] * scale + offset.x;
+            int end = lineRuns[2 * i + 1] * scale + offset.x;
+            for (int frameY = y * scale + offset.y; frameY < (y + 1) * scale + offset.y; frameY++)
+            {
+                int rowStrip = frameY / rowStripSize;
+                if (rowStrip < MAX_LINE_SPLITS)
+                {
+                    addRun(rowStrips[rowStrip], start, end, frameY);
+                }
 
-                            // Remove duplicate detections/average them out.
-                            vector<int> NMSResults;
-                            vector<Detection> finalDetections;
-                            cv::dnn::NMSBoxes(predictionBoxes, confidences, DNN_MINIMUM_CLASS_SCORE, DNN_NMS_THRESH, NMSResults);
-                            for (int i = 0; i < NMSResults.size(); i++) {
-                                int idx = NMSResults[i];
-                                Detection result;
-                                result.classID = classIDs[idx];
-                                result.confidence = confidences[idx];
-                                result.box = predictionBoxes[idx];
-                                finalDetections.push_back(result);
-                            }
+                // Split the run where it crosses from one column strip to the next.
+                for (int x = start; x < min(end, columnsEnd);)
+                {
+                    int columnStrip = x / columnStripSize;
+                    int stripEnd = min(end, (columnStrip + 1) * columnStripSize);
+                    addRun(columnStrips[columnStrip], x, stripEnd, frameY);
+                    x = stripEnd;
+                }
+            }
+        }
+    }
 
-                            // Loop through the detections and draw overlay onto final image.
-                            for (Detection detection : finalDetections)
-                            {
-                                // Get detection info.
-                                int classID = detection.classID;
-                                float confidence = detection.confidence;
-                                Rect detectionBox = detection.box;
-                                Scalar color = DETECTION_COLORS[classID % DETECTION_COLORS.size()];
-
-                                // Draw detection
-                                rectangle(finalImg, detectionBox, color, 3);
-                                rectangle(finalImg, Point(detectionBox.x, detectionBox.y - 20), Point(detectionBox.x + detectionBox.width, detectionBox.y), color, FILLED);
-                                putText(finalImg, classList[classID].c_str(), Point(detectionBox.x, detectionBox.y - 5), FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0, 0, 0));
-                            }
+    // Turn each strip big enough into a point.
+    for (int i = 0; i < 2 * MAX_LINE_SPLITS; i++)
+    {
+        const LineStrip &strip = lineStrips[i];
+        if (strip.area > 0 && strip.area >= contourAreaMinLimit)
+        {
+            AddLinePoint(i < MAX_LINE_SPLITS, Point(double(strip.sumX) / strip.area, double(strip.sumY) / strip.area), strip.bounds, contourAreaMaxLimit);
+        }
+    }
+}
 
-                            break;
-                        }
+/****************************************************************************
+        Description:	Line tracking fast path. Rather than filter the
+                        whole frame and measure every strip, it puts one
+                        scanline through the middle of each strip and
+                        only filters the LINE_SCANLINE_REACH rows (or
+                        columns) on each side of it, which is all that
+                        reaches it through the blur, erode and dilate. So
+                        the scanline's mask is the same as that row of the
+                        full frame mask. The longest run on each scanline
+                        is the line.
+
+                        Runs are held to the strips' area limit spread
+                        over a strip, and points to the same distance
+                        from the last point.
+
+                        The scanlines are placed over the whole frame,
+                        but only the ones crossing the region are filtered,
+                        and only inside it.
+
+        Arguments: 		MAT&, RECT, BOOL (rows across a vertical line, or columns), INT, DOUBLE, DOUBLE
 
-                        /****************************************************
-                        *			Track box tape targets
-                        *****************************************************/
-                        case TAPE_TRACKING:
-                        { 
-                            // Convert image from RGB to HSV.
-                            cvtColor(frame, HSVImg, COLOR_BGR2HSV);
-                            // Blur the image.
-                            blur(HSVImg, blurImg, Size(GREEN_BLUR_RADIUS, GREEN_BLUR_RADIUS));
-
-                            // Loop through the scalar ranges in array and detect the colored tape for each one.
-                            map<string, RotatedRect> tapeObjects;
-                            for (vector<Scalar> colorRange : colorRanges)
-                            {
-                                // Create individual HSV ranges for each tape color. (blue, yellow, green, purple, red, pink, orange)
-                                inRange(blurImg, colorRange[0], colorRange[1], filterImg);                        
-                                // Remove small blobs.
-                                dilate(filterImg, dilateImg, KERNEL);
-                                // Find countours of image.
-                                findContours(dilateImg, contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);		////RETR_TREE //// TRY CHAIN_APPROX_SIMPLE		//// Not sure what this method of detection does, but it worked before: CHAIN_APPROX_TC89_KCOS
-
-                                // Filter out unwanted contours based on contour area.
-                                vector<vector<Point>> filteredContours;
-                                for (vector<Point> contour : contours)
-                                {
-                                    double area = contourArea(contour);
-                                    if (area >= contourAreaMinLimit && area <= contourAreaMaxLimit)
-                                    {
-                                        filteredContours.emplace_back(contour);
-                                    }
-                                }
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::FindLineScanlines(Mat &frame, Rect region, bool isVertical, int scanlineCount, double contourAreaMinLimit, double contourAreaMaxLimit)
+{
+    // Create instance variables. A vertical line is crossed by rows and a horizontal one by columns.
+    int lineLength = isVertical ? frame.rows : frame.cols;
+    int scanStart = isVertical ? region.x : region.y;
+    int scanLength = isVertical ? region.width : region.height;
+    int regionFirst = isVertical ? region.y : region.x;
+    int regionLast = regionFirst + (isVertical ? region.height : region.width);
+    scanlineCount = min(scanlineCount, min(MAX_LINE_SCANLINES, lineLength));
+    int bandSize = lineLength / scanlineCount;
+    double minRunLength = contourAreaMinLimit / bandSize;
+    scanlineWords.resize(GetMaskWordCount(scanLength));
+    lineRuns.resize(scanLength + 1);
+
+    for (int i = 0; i < scanlineCount; i++)
+    {
+        // Filter just the band around the scanline. Cropping only makes a view.
+        int position = bandSize * i + bandSize / 2;
+        if (position < regionFirst || position >= regionLast)
+        {
+            continue;
+        }
+        int first = max(position - LINE_SCANLINE_REACH, regionFirst);
+        int last = min(position + LINE_SCANLINE_REACH + 1, regionLast);
+        Rect band = isVertical ? Rect(scanStart, first, scanLength, last - first) : Rect(first, scanStart, last - first, scanLength);
+        trackbarLabeler.FilterImage(frame(band), scanlineMask);
+
+        // Run length encode the scanline. Columns are packed the same way rows are first.
+        const uint64_t* words = scanlineWords.data();
+        if (isVertical)
+        {
+            words = scanlineMask.GetRow(position - first);
+        }
+        else
+        {
+            scanlineMask.GetColumn(position - first, scanlineWords.data());
+        }
+        int runCount = BitMask::EncodeRuns(words, scanLength, lineRuns.data());
 
-                                // Check if we have detected one or more contours.
-                                if (filteredContours.size() >= 1)
-                                {
-                                    // Sort contours from biggest to smallest.
-                                    sort(filteredContours.begin(), filteredContours.end(), [](const vector<Point>& c1, const vector<Point>& c2) { return fabs(contourArea(c1, false)) > fabs(contourArea(c2, false)); });
-                                    
-                                    // Find the rotated bounding rect of only the biggest contour.
-                                    Mat boxPts;
-                                    RotatedRect minRect = minAreaRect(filteredContours[0]);
-                                    Point2f rectPoints[4];
-                                    minRect.points(rectPoints);
-                                    // Draw the rotated rect in the color of current color range.
-                                    for (int i = 0; i < 4; i++)
-                                    {
-                                        line(finalImg, rectPoints[i], rectPoints[(i + 1) % 4], colorRange[2], LINE_4);
-                                    }
-
-                                    // Find the index of the currently detected tape object and then lookup and store its color.
-                                    auto location = find(colorRanges.begin(), colorRanges.end(), colorRange);
-                                    int index = location - colorRanges.begin();
-                                    string color = colors[index];
-                                    // Store the currently detected tape and its color, so we can do calculations later.
-                                    tapeObjects[color] = minRect;
-                                }
-                            }
+        // Find the longest run.
+        int longestIndex = -1;
+        int longestLength = 0;
+        for (int j = 0; j < runCount; j++)
+        {
+            int length = lineRuns[2 * j + 1] - lineRuns[2 * j];
+            if (length >= minRunLength && length > longestLength)
+            {
+                longestIndex = j;
+                longestLength = length;
+            }
+        }
+        if (longestIndex < 0)
+        {
+            continue;
+        }
 
-                            // Sort the tapeObjects based on x position from left to right. 
-                            vector<pair<string, RotatedRect>> tapeObjectsSorted;
-                            // Copy key-value pair from map to vector of pairs.
-                            for (auto object : tapeObjects) 
-                            {
-                                tapeObjectsSorted.push_back(object);
-                            }
-                            // Sort left to right using comparator function.
-                            sort(tapeObjectsSorted.begin(), tapeObjectsSorted.end(), [](const pair<string, RotatedRect>& t1, const pair<string, RotatedRect>& t2) { return t1.second.center.x < t2.second.center.x; });
+        // The middle of the run is the line's center on this scanline.
+        int start = lineRuns[2 * longestIndex] + scanStart;
+        int end = lineRuns[2 * longestIndex + 1] - 1 + scanStart;
+        Point runStart = isVertical ? Point(start, position) : Point(position, start);
+        Point runEnd = isVertical ? Point(end, position) : Point(position, end);
+        AddLinePoint(isVertical, (runStart + runEnd) / 2, Rect(runStart, runEnd + Point(1, 1)), contourAreaMaxLimit);
+    }
+}
 
-                            // Grab the current frame and crop the image down to just the side of the box.
-                            if (takeShapshot)
-                            {
-                                // Combine all of the tape objects into one large contour.
-                                vector<Point2f> boundingContour;
-                                for (pair<string, RotatedRect> object : tapeObjects)
-                                {
-                                    // Store the tape objects points
-                                    Point2f points[4];
-                                    object.second.points(points);
+/****************************************************************************
+        Description:	Adds a point to the vertical or horizontal line, if
+                        it's close enough across the line to the last one.
 
-                                    // Grab all points from the RotatedRect and add them to temporary contour.
-                                    for (Point2f point : points)
-                                        boundingContour.push_back(point);
-                                }
+        Arguments: 		BOOL, POINT, RECT (what the point was found from), DOUBLE
 
-                                if (boundingContour.size() >= 1)
-                                {
-                                    // Find the convex hull of the new combined contour.
-                                    Rect cropContour = boundingRect(boundingContour);
-                                    // Finally, make sure the boundingContour is within frame, and then crop.
-                                    Mat croppedImg = finalImg(cropContour);
-                                    // Copy cropped image to finalImg.
-                                    croppedImg.copyTo(finalImg);
-                                }
-                            }
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::AddLinePoint(bool isVertical, Point center, Rect bounds, double contourAreaMaxLimit)
+{
+    // Create instance variables.
+    vector<Point> &linePoints = isVertical ? verticalLinePoints : horizontalLinePoints;
+    vector<Rect> &lineBounds = isVertical ? verticalLineBounds : horizontalLineBounds;
 
-                            // This section of code is for the future.
-                            // This is for tracking the chessboard.
-                            // vector<Point2f> vImagePoints;
-                            // vImagePoints.emplace_back(Point2f(0.0, 0.0));
-                            // int targetPositionX = 0; 
-                            // int targetPositionY = 0;
-                            // solvePNPValues = SolveObjectPose(vImagePoints, ref(finalImg), ref(frame), targetPositionX, targetPositionY);
-                            break;
-                        }
-                    }
-                }
+    // Check if current circle is close enough to last point before appending.
+    if (linePoints.empty() || (isVertical ? fabs(center.x - linePoints.back().x) : fabs(center.y - linePoints.back().y)) < contourAreaMaxLimit)
+    {
+        linePoints.emplace_back(center);
+        lineBounds.emplace_back(bounds);
+    }
+}
 
-                // Put FPS on image.
-                FPSCount = FPSCounter->FramesPerSec();
-                putText(finalImg, ("Camera FPS: " + to_string(VideoGetter.GetFPS())), Point(420, finalImg.rows - 40), FONT_HERSHEY_DUPLEX, 0.65, Scalar(200, 200, 200), 1);
-                putText(finalImg, ("Algorithm FPS: " + to_string(FPSCount)), Point(420, finalImg.rows - 20), FONT_HERSHEY_DUPLEX, 0.65, Scalar(200, 200, 200), 1);
+/****************************************************************************
+        Description:	Records where one of the mode's targets was found
+                        this frame, for UpdateTargets. Only the most
+                        confident measurement of each target is kept.
 
-                // If tuning mode is enabled, then output contrast or brightness images.
-                if (tuningMode)
-                {
-                    // m_pContrastImg.copyTo(finalImg);
-                    dilateImg.copyTo(finalImg);
-                }
+        Arguments: 		INT, POINT2D, DOUBLE
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::AddTargetMeasurement(int index, Point2d position, double confidence)
+{
+    if (index < 0)
+    {
+        return;
+    }
+    for (TargetMeasurement &measurement : targetMeasurements)
+    {
+        if (measurement.index == index)
+        {
+            if (confidence > measurement.confidence)
+            {
+                measurement.position = position;
+                measurement.confidence = confidence;
             }
+            return;
         }
-        catch (const exception& e)
+    }
+
+    targetMeasurements.push_back({index, position, confidence});
+}
+
+/****************************************************************************
+        Description:	Feeds the targets found by the last ProcessFrame
+                        to their Kalman filters, as measured at the
+                        frame's capture time. Every filter starts over
+                        when the tracking mode changes, since each mode's
+                        targets mean something different. Safe to call
+                        while another thread gets the estimates.
+
+        Arguments: 		UINT64_T (capture time, microseconds)
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::UpdateTargets(uint64_t captureTime)
+{
+    lock_guard<mutex> guard(targetMutex);
+
+    if (lastTrackingMode != filteredTrackingMode)
+    {
+        for (TargetTracker &tracker : targetTrackers)
         {
-            //SetIsStopping(true);
-            // Print error to console and show that an error has occured on the screen.
-            putText(finalImg, "Image Processing ERROR", Point(280, finalImg.rows - 440), FONT_HERSHEY_DUPLEX, 0.65, Scalar(0, 0, 250), 1);
-            cout << "\nWARNING: MAT corrupt or a runtime error has occured! Frame has been dropped." << "\n" << e.what() << endl;
+            tracker.Reset();
         }
+        filteredTrackingMode = lastTrackingMode;
+    }
 
-        // If the program stops shutdown the thread.
-        if (isStopping)
+    // Targets that weren't found are left to time out. A target seen for the first time gets a filter, so every class of a model can be tracked.
+    for (const TargetMeasurement &measurement : targetMeasurements)
+    {
+        if (measurement.index >= int(targetTrackers.size()))
         {
-            break;
+            targetTrackers.resize(measurement.index + 1);
         }
+        targetTrackers[measurement.index].Update(measurement.position, captureTime);
     }
+}
 
-    // Clean-up.
-    isStopped = true;
+/****************************************************************************
+        Description:	Predicts every tracked target forward to a time,
+                        usually when the results are published, so they
+                        make up for the time since the frame was grabbed.
+                        Each target adds TARGET_ESTIMATE_VALUES values:
+                        its index, x, y, x and y velocity (pixels per
+                        second), then the position, cross and velocity
+                        covariances of x and of y. Safe to call from
+                        another thread.
+
+        Arguments: 		UINT64_T (microseconds), VECTOR<DOUBLE>&
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::GetTargetEstimates(uint64_t time, vector<double> &estimates)
+{
+    lock_guard<mutex> guard(targetMutex);
+
+    estimates.clear();
+    for (int i = 0; i < int(targetTrackers.size()); i++)
+    {
+        TargetEstimate estimate = targetTrackers[i].Predict(time);
+        if (estimate.isValid)
+        {
+            estimates.insert(estimates.end(), {double(i), estimate.position.x, estimate.position.y, estimate.velocity.x, estimate.velocity.y,
+                estimate.covarianceX[0], estimate.covarianceX[1], estimate.covarianceX[2], estimate.covarianceY[0], estimate.covarianceY[1], estimate.covarianceY[2]});
+        }
+    }
 }
 
 /****************************************************************************
@@ -853,6 +1723,78 @@ void VideoProcess::SetIsStopping(bool isStopping)
     this->isStopping = isStopping;
 }
 
+/****************************************************************************
+        Description:	Sets how many scanlines line tracking samples, or
+                        0 to filter the whole frame into strips.
+
+        Arguments: 		INT
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::SetLineScanlines(int scanlineCount)
+{
+    lineScanlineCount.store(max(scanlineCount, 0), memory_order_relaxed);
+}
+
+/****************************************************************************
+        Description:	Sets whether trench tracking finds the walls from
+                        column projections instead of contour hulls. Safe
+                        to call from another thread.
+
+        Arguments: 		BOOL
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::SetTrenchColumns(bool enabled)
+{
+    useTrenchColumns.store(enabled, memory_order_relaxed);
+}
+
+/****************************************************************************
+        Description:	Sets whether the trench, line and tape modes only
+                        search near where their target was last found.
+                        Turned off, every frame is searched in full. Safe
+                        to call from another thread.
+
+        Arguments: 		BOOL
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::SetRegionPrediction(bool enabled)
+{
+    useRegionPrediction.store(enabled, memory_order_relaxed);
+}
+
+/****************************************************************************
+        Description:	Sets how many times the trench, line and tape modes
+                        halve the search region before thresholding it, up
+                        to MAX_PYRAMID_LEVEL. 0 thresholds at full size.
+                        Safe to call from another thread.
+
+        Arguments: 		INT
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::SetPyramidLevel(int level)
+{
+    pyramidLevel.store(min(max(level, 0), MAX_PYRAMID_LEVEL), memory_order_relaxed);
+}
+
+/****************************************************************************
+        Description:	Sets whether frames that haven't changed since they
+                        were last searched are skipped, and frames that
+                        changed in one place only searched there. Safe to
+                        call from another thread.
+
+        Arguments: 		BOOL
+
+        Returns: 		Nothing
+****************************************************************************/
+void VideoProcess::SetChangeGate(bool enabled)
+{
+    useChangeGate.store(enabled, memory_order_relaxed);
+}
+
 /****************************************************************************
         Description:	Gets if the thread has stopped.
 
@@ -874,5 +1816,79 @@ bool VideoProcess::GetIsStopped()
 ****************************************************************************/
 int VideoProcess::GetFPS()
 {
-    return FPSCount;
-}
\ No newline at end of file
+    return int(round(PerformanceCounter->GetFramesPerSec()));
+}
+
+/****************************************************************************
+        Description:	Gets the frame rate and processing latency of the
+                        thread.
+
+        Arguments: 		None
+
+        Returns: 		PERFORMANCESNAPSHOT
+****************************************************************************/
+PerformanceSnapshot VideoProcess::GetPerformance()
+{
+    return PerformanceCounter->GetSnapshot();
+}
+
+/****************************************************************************
+        Description:	Gets how many times the thread was ready for a new
+                        frame before the camera delivered one, and waited
+                        instead of reprocessing the old one.
+
+        Arguments: 		None
+
+        Returns: 		UINT64_T
+****************************************************************************/
+uint64_t VideoProcess::GetDuplicateFramesSkipped()
+{
+    return duplicateFramesSkipped;
+}
+
+/****************************************************************************
+        Description:	Gets how many camera frames were replaced by a newer
+                        one before the thread could process them.
+
+        Arguments: 		None
+
+        Returns: 		UINT64_T
+****************************************************************************/
+uint64_t VideoProcess::GetDroppedFrames()
+{
+    return droppedFrames;
+}
+
+/****************************************************************************
+        Description:	Gets the metadata of the last frame whose tracking
+                        results were handed to the main thread.
+
+        Arguments: 		None
+
+        Returns: 		FRAMEMETA
+****************************************************************************/
+FrameMeta VideoProcess::GetLastFrameMeta()
+{
+    lock_guard<mutex> guard(frameMetaMutex);
+    return lastFrameMeta;
+}
+
+/****************************************************************************
+        Description:	Gets how many frames the change gate skipped or
+                        narrowed, and the time it spent and saved. Safe
+                        to call from another thread.
+
+        Arguments: 		None
+
+        Returns: 		CHANGEGATESTATS
+****************************************************************************/
+ChangeGateStats VideoProcess::GetChangeGateStats()
+{
+    ChangeGateStats stats;
+    stats.checkedFrames = gateCheckedFrames;
+    stats.skippedFrames = gateSkippedFrames;
+    stats.narrowedFrames = gateNarrowedFrames;
+    stats.spentTime = gateSpentTime;
+    stats.savedTime = gateSavedTime;
+    return stats;
+}
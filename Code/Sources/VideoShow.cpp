@@ -21,7 +21,7 @@
 VideoShow::VideoShow()
 {
     // Create objects.
-    FPSCounter							= new FPS();
+    PerformanceCounter					= new PerformanceMeter();
 
     // Initialize member variables.
     isStopping							= false;
@@ -38,42 +38,56 @@ VideoShow::VideoShow()
 VideoShow::~VideoShow()
 {
     // Delete object pointers.
-    delete FPSCounter;
+    delete PerformanceCounter;
 
     // Set object pointers as nullptrs.
-    FPSCounter = nullptr;
+    PerformanceCounter = nullptr;
 }
 
 /****************************************************************************
         Description:	Method that gives the processed frame to CameraServer.
 
-        Arguments: 		MAT&, VECTOR<CVSOURCE>&, SHARED_TIMED_MUTEX&
+        Arguments: 		FRAMEBUFFER&, VECTOR<CVSOURCE>&
 
         Returns: 		Nothing
 ****************************************************************************/
-void VideoShow::ShowFrame(Mat &frame, vector<CvSource> &cameraSources, shared_timed_mutex &Mutex)
+void VideoShow::ShowFrame(FrameBuffer &frameBuffer, vector<CvSource> &cameraSources)
 {
     // Give other threads some time.
+    Tracer::SetThreadName("VideoShow");
     this_thread::sleep_for(std::chrono::milliseconds(1000));
 
     while (1)
     {
-        // Increment FPS counter.
-        FPSCounter->Increment();
-
         // Check to make sure frame is not corrupt.
         try
         {
             // Slow thread down to save bandwidth.
             this_thread::sleep_for(std::chrono::milliseconds(25));
 
-            // Acquire resource lock for thread.
-            shared_lock<shared_timed_mutex> guard(Mutex);
+            // Swap in the last fully processed frame if there is a newer one. This never waits on the processing thread.
+            bool isNewFrame = frameBuffer.Acquire();
+            Mat &frame = frameBuffer.GetReadBuffer();
 
             if (!frame.empty())
             {
-                // Output frame to camera stream.
+                // Output frame to camera stream, timing how long the stream takes it.
+                auto putStart = chrono::steady_clock::now();
+                TraceSpan putSpan("PutFrame");
                 cameraSources[0].PutFrame(frame);
+                putSpan.End();
+
+                // Only count new frames. Re-sending the same frame to keep the stream alive would otherwise report the re-send rate, and latency that grows with how stale the frame is.
+                if (isNewFrame)
+                {
+                    PerformanceCounter->Increment();
+                    PerformanceCounter->RecordLatency(chrono::duration<double, milli>(chrono::steady_clock::now() - putStart).count());
+
+                    // Remember which camera frame is on the stream, so the main thread can report stream latency.
+                    lock_guard<mutex> metaGuard(frameMetaMutex);
+                    lastFrameMeta = frameBuffer.GetReadMeta();
+                    lastFrameMeta.publishTime = Now();
+                }
             }
             else
             {
@@ -87,9 +101,6 @@ void VideoShow::ShowFrame(Mat &frame, vector<CvSource> &cameraSources, shared_ti
             cout << "WARNING: MAT corrupt. Frame has been dropped." << endl;
         }
 
-        // Calculate FPS.
-        FPSCount = FPSCounter->FramesPerSec();
-
         // If the program stops shutdown the thread.
         if (isStopping)
         {
@@ -134,6 +145,32 @@ bool VideoShow::GetIsStopped()
 ****************************************************************************/
 int VideoShow::GetFPS()
 {
-    return FPSCount;
+    return int(round(PerformanceCounter->GetFramesPerSec()));
+}
+
+/****************************************************************************
+        Description:	Gets the frame rate and stream latency of the thread.
+
+        Arguments: 		Nothing
+
+        Returns: 		PERFORMANCESNAPSHOT
+****************************************************************************/
+PerformanceSnapshot VideoShow::GetPerformance()
+{
+    return PerformanceCounter->GetSnapshot();
+}
+
+/****************************************************************************
+        Description:	Gets the metadata of the last frame put on the
+                        stream. Its publish time is when it was sent.
+
+        Arguments: 		Nothing
+
+        Returns: 		FRAMEMETA
+****************************************************************************/
+FrameMeta VideoShow::GetLastFrameMeta()
+{
+    lock_guard<mutex> guard(frameMetaMutex);
+    return lastFrameMeta;
 }
 ///////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,355 @@
+/****************************************************************************
+		Description:	Implements the VisionKernels Class and the scalar
+						reference kernels.
+
+		Classes:		VisionKernels
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/VisionKernels.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Scalar reference kernels. Every other kernel set
+							must match these byte for byte.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT (, INT)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void ScalarBoxBlur3x3Row(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width, int channels)
+{
+    int rowBytes = width * channels;
+    for (int i = 0; i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+}
+
+static void ScalarErodeCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        outputRow[x] = ErodeCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void ScalarDilateCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        outputRow[x] = DilateCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void ScalarDilateLabelsRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        outputRow[x] = DilateLabelsPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static int ScalarEncodeRowRuns(const uint8_t* row, int width, uint16_t* runs)
+{
+    int runCount = 0;
+    bool inRun = false;
+    for (int x = 0; x < width; x++)
+    {
+        if ((row[x] != 0) != inRun)
+        {
+            runs[2 * runCount + (inRun ? 1 : 0)] = uint16_t(x);
+            runCount += inRun ? 1 : 0;
+            inRun = !inRun;
+        }
+    }
+    return FinishRuns(width, inRun, runs, runCount);
+}
+
+/****************************************************************************
+			Description:	Scalar bit mask kernels, one word at a time.
+
+			Arguments: 		Packed and byte rows, INT (pixels in the row)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void ScalarPackMaskRow(const uint8_t* row, int width, uint64_t* words)
+{
+    for (int x = 0; x < width; x += MASK_WORD_PIXELS)
+    {
+        words[x / MASK_WORD_PIXELS] = PackMaskWord(row + x, min(width - x, MASK_WORD_PIXELS));
+    }
+}
+
+static void ScalarUnpackMaskRow(const uint64_t* words, int width, uint8_t* row)
+{
+    for (int x = 0; x < width; x += MASK_WORD_PIXELS)
+    {
+        UnpackMaskWord(words[x / MASK_WORD_PIXELS], row + x, min(width - x, MASK_WORD_PIXELS));
+    }
+}
+
+static void ScalarErodeBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    for (int i = 0; i < GetMaskWordCount(width); i++)
+    {
+        outputWords[i] = ErodeBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+static void ScalarDilateBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    for (int i = 0; i < GetMaskWordCount(width); i++)
+    {
+        outputWords[i] = DilateBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+/****************************************************************************
+			Description:	Scalar column projection, one pixel at a time.
+
+			Arguments: 		CONST UINT8_T*, INT, INT, UINT16_T* (x4)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void ScalarProjectColumnsRow(const uint8_t* row, int width, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds)
+{
+    for (int x = 0; x < width; x++)
+    {
+        ProjectColumnsPixel(row, x, y, counts, runLengths, longestRuns, longestEnds);
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the scalar reference kernels.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET*
+****************************************************************************/
+const KernelSet* GetScalarKernels()
+{
+    static const KernelSet kernels = {"scalar", ScalarBoxBlur3x3Row, ScalarErodeCrossRow, ScalarDilateCrossRow, ScalarDilateLabelsRow, ScalarEncodeRowRuns, ScalarPackMaskRow, ScalarUnpackMaskRow, ScalarErodeBitsRow, ScalarDilateBitsRow, ScalarProjectColumnsRow};
+    return &kernels;
+}
+
+
+/****************************************************************************
+			Description:	Gets the kernel set picked for this CPU.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET&
+****************************************************************************/
+const KernelSet& VisionKernels::Get()
+{
+    // Thread safe one time selection.
+    static const KernelSet* selected = Select();
+    return *selected;
+}
+
+/****************************************************************************
+			Description:	Gets every kernel set that was compiled in and
+							that this CPU can run, slowest first.
+
+			Arguments: 		None
+
+			Returns: 		VECTOR<CONST KERNELSET*>
+****************************************************************************/
+vector<const KernelSet*> VisionKernels::GetSupported()
+{
+    vector<const KernelSet*> supported = {GetScalarKernels()};
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (GetSSE4Kernels() != nullptr && __builtin_cpu_supports("sse4.1"))
+    {
+        supported.emplace_back(GetSSE4Kernels());
+    }
+    if (GetAVX2Kernels() != nullptr && __builtin_cpu_supports("avx2"))
+    {
+        supported.emplace_back(GetAVX2Kernels());
+    }
+#elif defined(__aarch64__)
+    // NEON is always there on 64-bit ARM.
+    if (GetNEONKernels() != nullptr)
+    {
+        supported.emplace_back(GetNEONKernels());
+    }
+#elif defined(__arm__) && defined(__linux__)
+    // 32-bit Raspberry Pi OS only reports NEON through the aux vector.
+    if (GetNEONKernels() != nullptr && (getauxval(AT_HWCAP) & HWCAP_NEON))
+    {
+        supported.emplace_back(GetNEONKernels());
+    }
+#endif
+
+    return supported;
+}
+
+/****************************************************************************
+			Description:	Picks the fastest supported kernel set, unless the
+							VISION_KERNELS environment variable names one.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET*
+****************************************************************************/
+const KernelSet* VisionKernels::Select()
+{
+    // Create instance variables.
+    vector<const KernelSet*> supported = GetSupported();
+    const KernelSet* selected = supported.back();
+
+    // Let the user force a kernel set for debugging.
+    const char* requested = getenv("VISION_KERNELS");
+    if (requested != nullptr)
+    {
+        bool isFound = false;
+        for (const KernelSet* kernels : supported)
+        {
+            if (strcmp(kernels->name, requested) == 0)
+            {
+                selected = kernels;
+                isFound = true;
+            }
+        }
+        if (!isFound)
+        {
+            cout << "WARNING: VISION_KERNELS=" << requested << " is not supported on this CPU." << endl;
+        }
+    }
+
+    cout << "Using " << selected->name << " vision kernels." << endl;
+    return selected;
+}
+
+/****************************************************************************
+			Description:	Blurs an 8-bit image with a normalized 3x3 box,
+							the same as blur(src, dst, Size(3, 3)).
+
+			Arguments: 		CONST MAT&, MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::BoxBlur3x3(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels)
+{
+    CV_Assert(sourceImg.depth() == CV_8U && sourceImg.data != destinationImg.data);
+
+    // Create instance variables.
+    int height = sourceImg.rows;
+    destinationImg.create(sourceImg.size(), sourceImg.type());
+
+    // Blur each row, reflecting the rows past the top and bottom edges.
+    for (int y = 0; y < height; y++)
+    {
+        int aboveY = (y > 0) ? y - 1 : min(1, height - 1);
+        int belowY = (y < height - 1) ? y + 1 : max(height - 2, 0);
+        kernels.BoxBlur3x3Row(sourceImg.ptr<uint8_t>(aboveY), sourceImg.ptr<uint8_t>(y), sourceImg.ptr<uint8_t>(belowY), destinationImg.ptr<uint8_t>(y), sourceImg.cols, sourceImg.channels());
+    }
+}
+
+/****************************************************************************
+			Description:	Erodes a CV_8UC1 image with a 3x3 cross, the same
+							as erode with the 3x3 MORPH_ELLIPSE kernel.
+
+			Arguments: 		CONST MAT&, MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::ErodeCross(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels)
+{
+    RunMorphology(sourceImg, destinationImg, kernels.ErodeCrossRow);
+}
+
+/****************************************************************************
+			Description:	Dilates a CV_8UC1 image with a 3x3 cross, the same
+							as dilate with the 3x3 MORPH_ELLIPSE kernel.
+
+			Arguments: 		CONST MAT&, MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::DilateCross(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels)
+{
+    RunMorphology(sourceImg, destinationImg, kernels.DilateCrossRow);
+}
+
+/****************************************************************************
+			Description:	Dilates a CV_8UC1 image of label bits with a 3x3
+							cross, ORing the bits so every label grows by
+							itself.
+
+			Arguments: 		CONST MAT&, MAT&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::DilateLabels(const Mat &sourceImg, Mat &destinationImg, const KernelSet &kernels)
+{
+    RunMorphology(sourceImg, destinationImg, kernels.DilateLabelsRow);
+}
+
+/****************************************************************************
+			Description:	Measures every column of a CV_8UC1 mask in one
+							pass, top to bottom. The arrays only grow, so
+							the same size mask doesn't allocate.
+
+			Arguments: 		CONST MAT&, COLUMNPROJECTION&, CONST KERNELSET&
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::ProjectColumns(const Mat &maskImg, ColumnProjection &projection, const KernelSet &kernels)
+{
+    CV_Assert(maskImg.type() == CV_8UC1);
+
+    // Create instance variables.
+    int width = maskImg.cols;
+    projection.counts.assign(width, 0);
+    projection.runLengths.assign(width, 0);
+    projection.longestRuns.assign(width, 0);
+    projection.longestEnds.assign(width, 0);
+
+    for (int y = 0; y < maskImg.rows; y++)
+    {
+        kernels.ProjectColumnsRow(maskImg.ptr<uint8_t>(y), width, y, projection.counts.data(), projection.runLengths.data(), projection.longestRuns.data(), projection.longestEnds.data());
+    }
+}
+
+/****************************************************************************
+			Description:	Runs a 3x3 cross row kernel over a whole CV_8UC1
+							image. Missing neighbours past the edges are
+							replaced by the row itself, which can't change a
+							min, max or OR.
+
+			Arguments: 		CONST MAT&, MAT&, ROW KERNEL
+
+			Returns: 		Nothing
+****************************************************************************/
+void VisionKernels::RunMorphology(const Mat &sourceImg, Mat &destinationImg, void (*rowKernel)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int))
+{
+    CV_Assert(sourceImg.type() == CV_8UC1 && sourceImg.data != destinationImg.data);
+
+    // Create instance variables.
+    int height = sourceImg.rows;
+    destinationImg.create(sourceImg.size(), CV_8UC1);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* row = sourceImg.ptr<uint8_t>(y);
+        const uint8_t* aboveRow = (y > 0) ? sourceImg.ptr<uint8_t>(y - 1) : row;
+        const uint8_t* belowRow = (y < height - 1) ? sourceImg.ptr<uint8_t>(y + 1) : row;
+        rowKernel(aboveRow, row, belowRow, destinationImg.ptr<uint8_t>(y), sourceImg.cols);
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
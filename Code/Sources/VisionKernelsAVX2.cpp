@@ -0,0 +1,362 @@
+/****************************************************************************
+		Description:	Implements the AVX2 vision kernels. This file is
+						built with -mavx2 on x86 and is empty anywhere
+						else.
+
+		Classes:		None
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/VisionKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Adds 32 bytes to a pair of 16-bit accumulators.
+
+			Arguments: 		CONST UINT8_T*, __M256I&, __M256I&
+
+			Returns: 		Nothing
+****************************************************************************/
+static inline void AccumulateBytes(const uint8_t* bytes, __m256i &low, __m256i &high)
+{
+    low = _mm256_add_epi16(low, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)bytes)));
+    high = _mm256_add_epi16(high, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(bytes + 16))));
+}
+
+/****************************************************************************
+			Description:	AVX2 3x3 box blur. 32 bytes at a time, with the
+							sums kept in 16 bits and divided by 9 with
+							OpenCV's (sum + 4) * 7282 >> 16.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2BoxBlur3x3Row(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width, int channels)
+{
+    // Create instance variables.
+    int rowBytes = width * channels;
+    int i = 0;
+    const __m256i rounding = _mm256_set1_epi16(4);
+    const __m256i reciprocal = _mm256_set1_epi16(7282);
+
+    // The first pixel reflects, so do it one byte at a time.
+    for (; i < channels && i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+
+    // Everything with both neighbours inside the row.
+    for (; i + 32 + channels <= rowBytes; i += 32)
+    {
+        __m256i low = rounding;
+        __m256i high = rounding;
+        const uint8_t* rows[3] = {aboveRow, row, belowRow};
+        for (const uint8_t* source : rows)
+        {
+            AccumulateBytes(source + i - channels, low, high);
+            AccumulateBytes(source + i, low, high);
+            AccumulateBytes(source + i + channels, low, high);
+        }
+        low = _mm256_mulhi_epu16(low, reciprocal);
+        high = _mm256_mulhi_epu16(high, reciprocal);
+
+        // packus works within each 128-bit lane, so put the 64-bit blocks back in order.
+        __m256i packed = _mm256_packus_epi16(low, high);
+        _mm256_storeu_si256((__m256i*)(outputRow + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    // The tail and the last pixel.
+    for (; i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+}
+
+/****************************************************************************
+			Description:	AVX2 3x3 cross erode, dilate and label dilate.
+							32 pixels at a time with the first and last pixel
+							done in scalar.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2ErodeCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = ErodeCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 33 <= width; x += 32)
+    {
+        __m256i value = _mm256_min_epu8(_mm256_loadu_si256((const __m256i*)(row + x - 1)), _mm256_loadu_si256((const __m256i*)(row + x)));
+        value = _mm256_min_epu8(value, _mm256_loadu_si256((const __m256i*)(row + x + 1)));
+        value = _mm256_min_epu8(value, _mm256_loadu_si256((const __m256i*)(aboveRow + x)));
+        value = _mm256_min_epu8(value, _mm256_loadu_si256((const __m256i*)(belowRow + x)));
+        _mm256_storeu_si256((__m256i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = ErodeCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void AVX2DilateCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 33 <= width; x += 32)
+    {
+        __m256i value = _mm256_max_epu8(_mm256_loadu_si256((const __m256i*)(row + x - 1)), _mm256_loadu_si256((const __m256i*)(row + x)));
+        value = _mm256_max_epu8(value, _mm256_loadu_si256((const __m256i*)(row + x + 1)));
+        value = _mm256_max_epu8(value, _mm256_loadu_si256((const __m256i*)(aboveRow + x)));
+        value = _mm256_max_epu8(value, _mm256_loadu_si256((const __m256i*)(belowRow + x)));
+        _mm256_storeu_si256((__m256i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void AVX2DilateLabelsRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateLabelsPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 33 <= width; x += 32)
+    {
+        __m256i value = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(row + x - 1)), _mm256_loadu_si256((const __m256i*)(row + x)));
+        value = _mm256_or_si256(value, _mm256_loadu_si256((const __m256i*)(row + x + 1)));
+        value = _mm256_or_si256(value, _mm256_loadu_si256((const __m256i*)(aboveRow + x)));
+        value = _mm256_or_si256(value, _mm256_loadu_si256((const __m256i*)(belowRow + x)));
+        _mm256_storeu_si256((__m256i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateLabelsPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+/****************************************************************************
+			Description:	AVX2 run length encoding. Turns 32 pixels at a
+							time into a bit mask and skips chunks with no
+							run starting or ending in them.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT16_T*
+
+			Returns: 		INT (runs found)
+****************************************************************************/
+static int AVX2EncodeRowRuns(const uint8_t* row, int width, uint16_t* runs)
+{
+    // Create instance variables.
+    int runCount = 0;
+    bool inRun = false;
+    int x = 0;
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (; x + 32 <= width; x += 32)
+    {
+        uint32_t bits = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row + x)), zero)));
+        // Most chunks are all background, or all inside one run.
+        if (bits != (inRun ? 0xFFFFFFFFu : 0u))
+        {
+            AppendRunBits(bits, 32, x, inRun, runs, runCount);
+        }
+    }
+    if (x < width)
+    {
+        AppendRunBits(GetMaskBits(row + x, width - x), width - x, x, inRun, runs, runCount);
+    }
+
+    return FinishRuns(width, inRun, runs, runCount);
+}
+
+/****************************************************************************
+			Description:	AVX2 mask packing. Each word is two 32 pixel
+							movemasks.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT64_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2PackMaskRow(const uint8_t* row, int width, uint64_t* words)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (; x + MASK_WORD_PIXELS <= width; x += MASK_WORD_PIXELS)
+    {
+        uint64_t low = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row + x)), zero)));
+        uint64_t high = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row + x + 32)), zero)));
+        words[x / MASK_WORD_PIXELS] = low | (high << 32);
+    }
+    if (x < width)
+    {
+        words[x / MASK_WORD_PIXELS] = PackMaskWord(row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	AVX2 mask unpacking. 32 bits at a time are spread
+							over their bytes and compared against each byte's
+							bit. The shuffle stays within each 128-bit lane,
+							so the high lane picks from bytes 2 and 3.
+
+			Arguments: 		CONST UINT64_T*, INT, UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2UnpackMaskRow(const uint64_t* words, int width, uint8_t* row)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bitValues = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    for (; x + 32 <= width; x += 32)
+    {
+        int bits = int(uint32_t(words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS)));
+        __m256i value = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(bits), spread), bitValues);
+        _mm256_storeu_si256((__m256i*)(row + x), _mm256_cmpeq_epi8(value, bitValues));
+    }
+    if (x < width)
+    {
+        UnpackMaskWord(words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS), row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	AVX2 bit mask erode and dilate. Four words (256
+							pixels) at a time, with the first and last word
+							done in scalar.
+
+			Arguments: 		CONST UINT64_T* (x3), UINT64_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2ErodeBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = ErodeBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 5 <= wordCount; i += 4)
+    {
+        __m256i word = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i left = _mm256_or_si256(_mm256_slli_epi64(word, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i*)(words + i - 1)), 63));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(word, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i*)(words + i + 1)), 63));
+        __m256i value = _mm256_and_si256(_mm256_and_si256(word, left), right);
+        value = _mm256_and_si256(value, _mm256_loadu_si256((const __m256i*)(aboveWords + i)));
+        value = _mm256_and_si256(value, _mm256_loadu_si256((const __m256i*)(belowWords + i)));
+        _mm256_storeu_si256((__m256i*)(outputWords + i), value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = ErodeBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+static void AVX2DilateBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = DilateBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 5 <= wordCount; i += 4)
+    {
+        __m256i word = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i left = _mm256_or_si256(_mm256_slli_epi64(word, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i*)(words + i - 1)), 63));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(word, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i*)(words + i + 1)), 63));
+        __m256i value = _mm256_or_si256(_mm256_or_si256(word, left), right);
+        value = _mm256_or_si256(value, _mm256_loadu_si256((const __m256i*)(aboveWords + i)));
+        value = _mm256_or_si256(value, _mm256_loadu_si256((const __m256i*)(belowWords + i)));
+        _mm256_storeu_si256((__m256i*)(outputWords + i), value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = DilateBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+/****************************************************************************
+			Description:	AVX2 column projection. 16 columns at a time in
+							16-bit lanes, with set pixels widened to 0xFFFF
+							so they can be subtracted and masked with.
+
+			Arguments: 		CONST UINT8_T*, INT, INT, UINT16_T* (x4)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void AVX2ProjectColumnsRow(const uint8_t* row, int width, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i rowY = _mm256_set1_epi16(short(y));
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i isSet = _mm256_cmpgt_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x))), zero);
+        __m256i run = _mm256_and_si256(_mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(runLengths + x)), one), isSet);
+        __m256i longest = _mm256_loadu_si256((const __m256i*)(longestRuns + x));
+        __m256i isLonger = _mm256_cmpgt_epi16(run, longest);
+        _mm256_storeu_si256((__m256i*)(counts + x), _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)(counts + x)), isSet));
+        _mm256_storeu_si256((__m256i*)(runLengths + x), run);
+        _mm256_storeu_si256((__m256i*)(longestRuns + x), _mm256_max_epu16(run, longest));
+        _mm256_storeu_si256((__m256i*)(longestEnds + x), _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i*)(longestEnds + x)), rowY, isLonger));
+    }
+    for (; x < width; x++)
+    {
+        ProjectColumnsPixel(row, x, y, counts, runLengths, longestRuns, longestEnds);
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the AVX2.1 kernels.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET*
+****************************************************************************/
+const KernelSet* GetAVX2Kernels()
+{
+    static const KernelSet kernels = {"avx2", AVX2BoxBlur3x3Row, AVX2ErodeCrossRow, AVX2DilateCrossRow, AVX2DilateLabelsRow, AVX2EncodeRowRuns, AVX2PackMaskRow, AVX2UnpackMaskRow, AVX2ErodeBitsRow, AVX2DilateBitsRow, AVX2ProjectColumnsRow};
+    return &kernels;
+}
+
+#else
+const KernelSet* GetAVX2Kernels()
+{
+    return nullptr;
+}
+#endif
+///////////////////////////////////////////////////////////////////////////////
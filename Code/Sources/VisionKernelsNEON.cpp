@@ -0,0 +1,394 @@
+/****************************************************************************
+		Description:	Implements the NEON vision kernels. This file is
+						built with -mfpu=neon on 32-bit ARM, needs no flags
+						on 64-bit ARM, and is empty anywhere else.
+
+		Classes:		None
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/VisionKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+
+// Declare constants.
+static const uint8_t MASK_BIT_WEIGHTS[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Adds 16 bytes to a pair of 16-bit accumulators.
+
+			Arguments: 		CONST UINT8_T*, UINT16X8_T&, UINT16X8_T&
+
+			Returns: 		Nothing
+****************************************************************************/
+static inline void AccumulateBytes(const uint8_t* bytes, uint16x8_t &low, uint16x8_t &high)
+{
+    uint8x16_t values = vld1q_u8(bytes);
+    low = vaddw_u8(low, vget_low_u8(values));
+    high = vaddw_u8(high, vget_high_u8(values));
+}
+
+/****************************************************************************
+			Description:	Divides eight 16-bit sums by 9 with OpenCV's
+							(sum + 4) * 7282 >> 16 and narrows them to bytes.
+							The rounding term is already in the sums.
+
+			Arguments: 		UINT16X8_T
+
+			Returns: 		UINT8X8_T
+****************************************************************************/
+static inline uint8x8_t DivideByNine(uint16x8_t sums)
+{
+    const uint16x4_t reciprocal = vdup_n_u16(7282);
+    uint16x4_t low = vshrn_n_u32(vmull_u16(vget_low_u16(sums), reciprocal), 16);
+    uint16x4_t high = vshrn_n_u32(vmull_u16(vget_high_u16(sums), reciprocal), 16);
+    return vmovn_u16(vcombine_u16(low, high));
+}
+
+/****************************************************************************
+			Description:	NEON 3x3 box blur. 16 bytes at a time, with the
+							sums kept in 16 bits.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONBoxBlur3x3Row(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width, int channels)
+{
+    // Create instance variables.
+    int rowBytes = width * channels;
+    int i = 0;
+    const uint16x8_t rounding = vdupq_n_u16(4);
+
+    // The first pixel reflects, so do it one byte at a time.
+    for (; i < channels && i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+
+    // Everything with both neighbours inside the row.
+    for (; i + 16 + channels <= rowBytes; i += 16)
+    {
+        uint16x8_t low = rounding;
+        uint16x8_t high = rounding;
+        const uint8_t* rows[3] = {aboveRow, row, belowRow};
+        for (const uint8_t* source : rows)
+        {
+            AccumulateBytes(source + i - channels, low, high);
+            AccumulateBytes(source + i, low, high);
+            AccumulateBytes(source + i + channels, low, high);
+        }
+        vst1q_u8(outputRow + i, vcombine_u8(DivideByNine(low), DivideByNine(high)));
+    }
+
+    // The tail and the last pixel.
+    for (; i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+}
+
+/****************************************************************************
+			Description:	NEON 3x3 cross erode, dilate and label dilate.
+							16 pixels at a time with the first and last pixel
+							done in scalar.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONErodeCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = ErodeCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        uint8x16_t value = vminq_u8(vld1q_u8(row + x - 1), vld1q_u8(row + x));
+        value = vminq_u8(value, vld1q_u8(row + x + 1));
+        value = vminq_u8(value, vld1q_u8(aboveRow + x));
+        value = vminq_u8(value, vld1q_u8(belowRow + x));
+        vst1q_u8(outputRow + x, value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = ErodeCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void NEONDilateCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        uint8x16_t value = vmaxq_u8(vld1q_u8(row + x - 1), vld1q_u8(row + x));
+        value = vmaxq_u8(value, vld1q_u8(row + x + 1));
+        value = vmaxq_u8(value, vld1q_u8(aboveRow + x));
+        value = vmaxq_u8(value, vld1q_u8(belowRow + x));
+        vst1q_u8(outputRow + x, value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void NEONDilateLabelsRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateLabelsPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        uint8x16_t value = vorrq_u8(vld1q_u8(row + x - 1), vld1q_u8(row + x));
+        value = vorrq_u8(value, vld1q_u8(row + x + 1));
+        value = vorrq_u8(value, vld1q_u8(aboveRow + x));
+        value = vorrq_u8(value, vld1q_u8(belowRow + x));
+        vst1q_u8(outputRow + x, value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateLabelsPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+/****************************************************************************
+			Description:	Turns 16 mask pixels into 16 bits, bit 0 being the
+							leftmost. NEON has no movemask, so each set byte
+							keeps its bit's weight and the bytes of each half
+							are added up.
+
+			Arguments: 		CONST UINT8_T*, UINT8X16_T (MASK_BIT_WEIGHTS)
+
+			Returns: 		UINT32_T
+****************************************************************************/
+static inline uint32_t GetNEONMaskBits(const uint8_t* row, uint8x16_t weights)
+{
+    uint8x16_t value = vld1q_u8(row);
+    uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(vtstq_u8(value, value), weights))));
+    return uint32_t(vgetq_lane_u64(sums, 0)) | (uint32_t(vgetq_lane_u64(sums, 1)) << 8);
+}
+
+/****************************************************************************
+			Description:	NEON run length encoding. Turns 16 pixels at a
+							time into a bit mask and skips chunks with no
+							run starting or ending in them.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT16_T*
+
+			Returns: 		INT (runs found)
+****************************************************************************/
+static int NEONEncodeRowRuns(const uint8_t* row, int width, uint16_t* runs)
+{
+    // Create instance variables.
+    int runCount = 0;
+    bool inRun = false;
+    int x = 0;
+    const uint8x16_t weights = vld1q_u8(MASK_BIT_WEIGHTS);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        uint32_t bits = GetNEONMaskBits(row + x, weights);
+        // Most chunks are all background, or all inside one run.
+        if (bits != (inRun ? 0xFFFFu : 0u))
+        {
+            AppendRunBits(bits, 16, x, inRun, runs, runCount);
+        }
+    }
+    if (x < width)
+    {
+        AppendRunBits(GetMaskBits(row + x, width - x), width - x, x, inRun, runs, runCount);
+    }
+
+    return FinishRuns(width, inRun, runs, runCount);
+}
+
+/****************************************************************************
+			Description:	NEON mask packing. Each word is four 16 pixel
+							chunks.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT64_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONPackMaskRow(const uint8_t* row, int width, uint64_t* words)
+{
+    // Create instance variables.
+    int x = 0;
+    const uint8x16_t weights = vld1q_u8(MASK_BIT_WEIGHTS);
+
+    for (; x + MASK_WORD_PIXELS <= width; x += MASK_WORD_PIXELS)
+    {
+        uint64_t word = 0;
+        for (int i = 0; i < MASK_WORD_PIXELS; i += 16)
+        {
+            word |= uint64_t(GetNEONMaskBits(row + x + i, weights)) << i;
+        }
+        words[x / MASK_WORD_PIXELS] = word;
+    }
+    if (x < width)
+    {
+        words[x / MASK_WORD_PIXELS] = PackMaskWord(row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	NEON mask unpacking. Each byte of 16 bits is
+							copied over 8 lanes and tested against each
+							lane's bit.
+
+			Arguments: 		CONST UINT64_T*, INT, UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONUnpackMaskRow(const uint64_t* words, int width, uint8_t* row)
+{
+    // Create instance variables.
+    int x = 0;
+    const uint8x16_t weights = vld1q_u8(MASK_BIT_WEIGHTS);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        uint32_t bits = uint32_t(words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS));
+        uint8x16_t value = vcombine_u8(vdup_n_u8(uint8_t(bits)), vdup_n_u8(uint8_t(bits >> 8)));
+        vst1q_u8(row + x, vtstq_u8(value, weights));
+    }
+    if (x < width)
+    {
+        UnpackMaskWord(words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS), row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	NEON bit mask erode and dilate. Two words (128
+							pixels) at a time, with the first and last word
+							done in scalar.
+
+			Arguments: 		CONST UINT64_T* (x3), UINT64_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONErodeBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = ErodeBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 3 <= wordCount; i += 2)
+    {
+        uint64x2_t word = vld1q_u64(words + i);
+        uint64x2_t left = vorrq_u64(vshlq_n_u64(word, 1), vshrq_n_u64(vld1q_u64(words + i - 1), 63));
+        uint64x2_t right = vorrq_u64(vshrq_n_u64(word, 1), vshlq_n_u64(vld1q_u64(words + i + 1), 63));
+        uint64x2_t value = vandq_u64(vandq_u64(word, left), right);
+        value = vandq_u64(value, vld1q_u64(aboveWords + i));
+        value = vandq_u64(value, vld1q_u64(belowWords + i));
+        vst1q_u64(outputWords + i, value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = ErodeBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+static void NEONDilateBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = DilateBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 3 <= wordCount; i += 2)
+    {
+        uint64x2_t word = vld1q_u64(words + i);
+        uint64x2_t left = vorrq_u64(vshlq_n_u64(word, 1), vshrq_n_u64(vld1q_u64(words + i - 1), 63));
+        uint64x2_t right = vorrq_u64(vshrq_n_u64(word, 1), vshlq_n_u64(vld1q_u64(words + i + 1), 63));
+        uint64x2_t value = vorrq_u64(vorrq_u64(word, left), right);
+        value = vorrq_u64(value, vld1q_u64(aboveWords + i));
+        value = vorrq_u64(value, vld1q_u64(belowWords + i));
+        vst1q_u64(outputWords + i, value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = DilateBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+/****************************************************************************
+			Description:	NEON column projection. 8 columns at a time in
+							16-bit lanes, with set pixels widened to 0xFFFF
+							so they can be subtracted and masked with.
+
+			Arguments: 		CONST UINT8_T*, INT, INT, UINT16_T* (x4)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void NEONProjectColumnsRow(const uint8_t* row, int width, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds)
+{
+    // Create instance variables.
+    int x = 0;
+    const uint16x8_t zero = vdupq_n_u16(0);
+    const uint16x8_t one = vdupq_n_u16(1);
+    const uint16x8_t rowY = vdupq_n_u16(uint16_t(y));
+
+    for (; x + 8 <= width; x += 8)
+    {
+        uint16x8_t isSet = vcgtq_u16(vmovl_u8(vld1_u8(row + x)), zero);
+        uint16x8_t run = vandq_u16(vaddq_u16(vld1q_u16(runLengths + x), one), isSet);
+        uint16x8_t longest = vld1q_u16(longestRuns + x);
+        uint16x8_t isLonger = vcgtq_u16(run, longest);
+        vst1q_u16(counts + x, vsubq_u16(vld1q_u16(counts + x), isSet));
+        vst1q_u16(runLengths + x, run);
+        vst1q_u16(longestRuns + x, vmaxq_u16(run, longest));
+        vst1q_u16(longestEnds + x, vbslq_u16(isLonger, rowY, vld1q_u16(longestEnds + x)));
+    }
+    for (; x < width; x++)
+    {
+        ProjectColumnsPixel(row, x, y, counts, runLengths, longestRuns, longestEnds);
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the NEON kernels.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET*
+****************************************************************************/
+const KernelSet* GetNEONKernels()
+{
+    static const KernelSet kernels = {"neon", NEONBoxBlur3x3Row, NEONErodeCrossRow, NEONDilateCrossRow, NEONDilateLabelsRow, NEONEncodeRowRuns, NEONPackMaskRow, NEONUnpackMaskRow, NEONErodeBitsRow, NEONDilateBitsRow, NEONProjectColumnsRow};
+    return &kernels;
+}
+
+#else
+const KernelSet* GetNEONKernels()
+{
+    return nullptr;
+}
+#endif
+///////////////////////////////////////////////////////////////////////////////
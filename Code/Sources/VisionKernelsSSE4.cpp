@@ -0,0 +1,363 @@
+/****************************************************************************
+		Description:	Implements the SSE4.1 vision kernels. This file is
+						built with -msse4.1 on x86 and is empty anywhere
+						else.
+
+		Classes:		None
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics
+****************************************************************************/
+#include "../Headers/VisionKernels.h"
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+///////////////////////////////////////////////////////////////////////////////
+
+
+/****************************************************************************
+			Description:	Adds 16 bytes to a pair of 16-bit accumulators.
+
+			Arguments: 		CONST UINT8_T*, __M128I&, __M128I&
+
+			Returns: 		Nothing
+****************************************************************************/
+static inline void AccumulateBytes(const uint8_t* bytes, __m128i &low, __m128i &high)
+{
+    __m128i values = _mm_loadu_si128((const __m128i*)bytes);
+    low = _mm_add_epi16(low, _mm_cvtepu8_epi16(values));
+    high = _mm_add_epi16(high, _mm_unpackhi_epi8(values, _mm_setzero_si128()));
+}
+
+/****************************************************************************
+			Description:	SSE4.1 3x3 box blur. 16 bytes at a time, with the
+							sums kept in 16 bits and divided by 9 with
+							OpenCV's (sum + 4) * 7282 >> 16.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4BoxBlur3x3Row(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width, int channels)
+{
+    // Create instance variables.
+    int rowBytes = width * channels;
+    int i = 0;
+    const __m128i rounding = _mm_set1_epi16(4);
+    const __m128i reciprocal = _mm_set1_epi16(7282);
+
+    // The first pixel reflects, so do it one byte at a time.
+    for (; i < channels && i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+
+    // Everything with both neighbours inside the row.
+    for (; i + 16 + channels <= rowBytes; i += 16)
+    {
+        __m128i low = rounding;
+        __m128i high = rounding;
+        const uint8_t* rows[3] = {aboveRow, row, belowRow};
+        for (const uint8_t* source : rows)
+        {
+            AccumulateBytes(source + i - channels, low, high);
+            AccumulateBytes(source + i, low, high);
+            AccumulateBytes(source + i + channels, low, high);
+        }
+        low = _mm_mulhi_epu16(low, reciprocal);
+        high = _mm_mulhi_epu16(high, reciprocal);
+        _mm_storeu_si128((__m128i*)(outputRow + i), _mm_packus_epi16(low, high));
+    }
+
+    // The tail and the last pixel.
+    for (; i < rowBytes; i++)
+    {
+        outputRow[i] = BoxBlur3x3Pixel(aboveRow, row, belowRow, i, rowBytes, channels);
+    }
+}
+
+/****************************************************************************
+			Description:	SSE4.1 3x3 cross erode, dilate and label dilate.
+							16 pixels at a time with the first and last pixel
+							done in scalar.
+
+			Arguments: 		CONST UINT8_T* (x3), UINT8_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4ErodeCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = ErodeCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        __m128i value = _mm_min_epu8(_mm_loadu_si128((const __m128i*)(row + x - 1)), _mm_loadu_si128((const __m128i*)(row + x)));
+        value = _mm_min_epu8(value, _mm_loadu_si128((const __m128i*)(row + x + 1)));
+        value = _mm_min_epu8(value, _mm_loadu_si128((const __m128i*)(aboveRow + x)));
+        value = _mm_min_epu8(value, _mm_loadu_si128((const __m128i*)(belowRow + x)));
+        _mm_storeu_si128((__m128i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = ErodeCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void SSE4DilateCrossRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateCrossPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        __m128i value = _mm_max_epu8(_mm_loadu_si128((const __m128i*)(row + x - 1)), _mm_loadu_si128((const __m128i*)(row + x)));
+        value = _mm_max_epu8(value, _mm_loadu_si128((const __m128i*)(row + x + 1)));
+        value = _mm_max_epu8(value, _mm_loadu_si128((const __m128i*)(aboveRow + x)));
+        value = _mm_max_epu8(value, _mm_loadu_si128((const __m128i*)(belowRow + x)));
+        _mm_storeu_si128((__m128i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateCrossPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+static void SSE4DilateLabelsRow(const uint8_t* aboveRow, const uint8_t* row, const uint8_t* belowRow, uint8_t* outputRow, int width)
+{
+    // The first pixel has no left neighbour.
+    int x = 1;
+    if (width > 0)
+    {
+        outputRow[0] = DilateLabelsPixel(aboveRow, row, belowRow, 0, width);
+    }
+    for (; x + 17 <= width; x += 16)
+    {
+        __m128i value = _mm_or_si128(_mm_loadu_si128((const __m128i*)(row + x - 1)), _mm_loadu_si128((const __m128i*)(row + x)));
+        value = _mm_or_si128(value, _mm_loadu_si128((const __m128i*)(row + x + 1)));
+        value = _mm_or_si128(value, _mm_loadu_si128((const __m128i*)(aboveRow + x)));
+        value = _mm_or_si128(value, _mm_loadu_si128((const __m128i*)(belowRow + x)));
+        _mm_storeu_si128((__m128i*)(outputRow + x), value);
+    }
+    for (; x < width; x++)
+    {
+        outputRow[x] = DilateLabelsPixel(aboveRow, row, belowRow, x, width);
+    }
+}
+
+/****************************************************************************
+			Description:	SSE4.1 run length encoding. Turns 16 pixels at a
+							time into a bit mask and skips chunks with no
+							run starting or ending in them.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT16_T*
+
+			Returns: 		INT (runs found)
+****************************************************************************/
+static int SSE4EncodeRowRuns(const uint8_t* row, int width, uint16_t* runs)
+{
+    // Create instance variables.
+    int runCount = 0;
+    bool inRun = false;
+    int x = 0;
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + 16 <= width; x += 16)
+    {
+        uint32_t bits = ~uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + x)), zero))) & 0xFFFFu;
+        // Most chunks are all background, or all inside one run.
+        if (bits != (inRun ? 0xFFFFu : 0u))
+        {
+            AppendRunBits(bits, 16, x, inRun, runs, runCount);
+        }
+    }
+    if (x < width)
+    {
+        AppendRunBits(GetMaskBits(row + x, width - x), width - x, x, inRun, runs, runCount);
+    }
+
+    return FinishRuns(width, inRun, runs, runCount);
+}
+
+/****************************************************************************
+			Description:	SSE4.1 mask packing. Each word is four 16 pixel
+							movemasks.
+
+			Arguments: 		CONST UINT8_T*, INT, UINT64_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4PackMaskRow(const uint8_t* row, int width, uint64_t* words)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + MASK_WORD_PIXELS <= width; x += MASK_WORD_PIXELS)
+    {
+        uint64_t word = 0;
+        for (int i = 0; i < MASK_WORD_PIXELS; i += 16)
+        {
+            uint64_t bits = ~uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + x + i)), zero))) & 0xFFFFu;
+            word |= bits << i;
+        }
+        words[x / MASK_WORD_PIXELS] = word;
+    }
+    if (x < width)
+    {
+        words[x / MASK_WORD_PIXELS] = PackMaskWord(row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	SSE4.1 mask unpacking. 16 bits at a time are
+							spread over their bytes and compared against each
+							byte's bit.
+
+			Arguments: 		CONST UINT64_T*, INT, UINT8_T*
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4UnpackMaskRow(const uint64_t* words, int width, uint8_t* row)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i bitValues = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        int bits = int((words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS)) & 0xFFFFu);
+        __m128i value = _mm_and_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(bits), spread), bitValues);
+        _mm_storeu_si128((__m128i*)(row + x), _mm_cmpeq_epi8(value, bitValues));
+    }
+    if (x < width)
+    {
+        UnpackMaskWord(words[x / MASK_WORD_PIXELS] >> (x % MASK_WORD_PIXELS), row + x, width - x);
+    }
+}
+
+/****************************************************************************
+			Description:	SSE4.1 bit mask erode and dilate. Two words (128
+							pixels) at a time, with the first and last word
+							done in scalar.
+
+			Arguments: 		CONST UINT64_T* (x3), UINT64_T*, INT
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4ErodeBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = ErodeBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 3 <= wordCount; i += 2)
+    {
+        __m128i word = _mm_loadu_si128((const __m128i*)(words + i));
+        __m128i left = _mm_or_si128(_mm_slli_epi64(word, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i*)(words + i - 1)), 63));
+        __m128i right = _mm_or_si128(_mm_srli_epi64(word, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i*)(words + i + 1)), 63));
+        __m128i value = _mm_and_si128(_mm_and_si128(word, left), right);
+        value = _mm_and_si128(value, _mm_loadu_si128((const __m128i*)(aboveWords + i)));
+        value = _mm_and_si128(value, _mm_loadu_si128((const __m128i*)(belowWords + i)));
+        _mm_storeu_si128((__m128i*)(outputWords + i), value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = ErodeBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+static void SSE4DilateBitsRow(const uint64_t* aboveWords, const uint64_t* words, const uint64_t* belowWords, uint64_t* outputWords, int width)
+{
+    // Create instance variables.
+    int wordCount = GetMaskWordCount(width);
+    int i = 1;
+
+    // The first word has no left neighbour.
+    if (wordCount > 0)
+    {
+        outputWords[0] = DilateBitsWord(aboveWords, words, belowWords, 0, width);
+    }
+    for (; i + 3 <= wordCount; i += 2)
+    {
+        __m128i word = _mm_loadu_si128((const __m128i*)(words + i));
+        __m128i left = _mm_or_si128(_mm_slli_epi64(word, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i*)(words + i - 1)), 63));
+        __m128i right = _mm_or_si128(_mm_srli_epi64(word, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i*)(words + i + 1)), 63));
+        __m128i value = _mm_or_si128(_mm_or_si128(word, left), right);
+        value = _mm_or_si128(value, _mm_loadu_si128((const __m128i*)(aboveWords + i)));
+        value = _mm_or_si128(value, _mm_loadu_si128((const __m128i*)(belowWords + i)));
+        _mm_storeu_si128((__m128i*)(outputWords + i), value);
+    }
+    for (; i < wordCount; i++)
+    {
+        outputWords[i] = DilateBitsWord(aboveWords, words, belowWords, i, width);
+    }
+}
+
+/****************************************************************************
+			Description:	SSE4.1 column projection. 8 columns at a time in
+							16-bit lanes, with set pixels widened to 0xFFFF
+							so they can be subtracted and masked with.
+
+			Arguments: 		CONST UINT8_T*, INT, INT, UINT16_T* (x4)
+
+			Returns: 		Nothing
+****************************************************************************/
+static void SSE4ProjectColumnsRow(const uint8_t* row, int width, int y, uint16_t* counts, uint16_t* runLengths, uint16_t* longestRuns, uint16_t* longestEnds)
+{
+    // Create instance variables.
+    int x = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i rowY = _mm_set1_epi16(short(y));
+
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i isSet = _mm_cmpgt_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(row + x))), zero);
+        __m128i run = _mm_and_si128(_mm_add_epi16(_mm_loadu_si128((const __m128i*)(runLengths + x)), one), isSet);
+        __m128i longest = _mm_loadu_si128((const __m128i*)(longestRuns + x));
+        __m128i isLonger = _mm_cmpgt_epi16(run, longest);
+        _mm_storeu_si128((__m128i*)(counts + x), _mm_sub_epi16(_mm_loadu_si128((const __m128i*)(counts + x)), isSet));
+        _mm_storeu_si128((__m128i*)(runLengths + x), run);
+        _mm_storeu_si128((__m128i*)(longestRuns + x), _mm_max_epu16(run, longest));
+        _mm_storeu_si128((__m128i*)(longestEnds + x), _mm_blendv_epi8(_mm_loadu_si128((const __m128i*)(longestEnds + x)), rowY, isLonger));
+    }
+    for (; x < width; x++)
+    {
+        ProjectColumnsPixel(row, x, y, counts, runLengths, longestRuns, longestEnds);
+    }
+}
+
+/****************************************************************************
+			Description:	Gets the SSE4.1 kernels.
+
+			Arguments: 		None
+
+			Returns: 		CONST KERNELSET*
+****************************************************************************/
+const KernelSet* GetSSE4Kernels()
+{
+    static const KernelSet kernels = {"sse4", SSE4BoxBlur3x3Row, SSE4ErodeCrossRow, SSE4DilateCrossRow, SSE4DilateLabelsRow, SSE4EncodeRowRuns, SSE4PackMaskRow, SSE4UnpackMaskRow, SSE4ErodeBitsRow, SSE4DilateBitsRow, SSE4ProjectColumnsRow};
+    return &kernels;
+}
+
+#else
+const KernelSet* GetSSE4Kernels()
+{
+    return nullptr;
+}
+#endif
+///////////////////////////////////////////////////////////////////////////////
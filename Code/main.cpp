@@ -11,9 +11,14 @@
 #include <vector>
 #include <math.h>
 
+#include "Headers/FrameBuffer.h"
+#include "Headers/FrameSource.h"
+#include "Headers/CameraSource.h"
 #include "Headers/VideoGet.h"
 #include "Headers/VideoProcess.h"
 #include "Headers/VideoShow.h"
+#include "Headers/Tracer.h"
+#include "Headers/MatPool.h"
 #include "Headers/rapidjson/filereadstream.h"
 #include "Headers/rapidjson/filewritestream.h"
 #include "Headers/rapidjson/writer.h"
@@ -29,6 +34,7 @@
 #include <wpi/json.h>
 #include <wpi/raw_istream.h>
 #include <wpi/raw_ostream.h>
+#include <wpi/timestamp.h>
 #include <cameraserver/CameraServer.h>
 
 using namespace cv;
@@ -86,11 +92,18 @@ using namespace rapidjson;
 static const char* configFile = "/boot/frc.json";
 static const char* VisionTuningFilePath = "/home/pi/2022-Vision/Code/trackbar_values.json";
 static const string YoloModelOnnxFilePath = "/home/pi/2022-Vision/YOLO_Models/COCO_v5n_Test/";
+static const string TraceFilePath = "/home/pi/2022-Vision/vision_trace.json";
 
 // Create namespace variables, stucts, and objects.
 unsigned int team;
 bool server = false;
 
+// Frame source options. (set from the command line)
+int frameSourceType = FrameSource::CAMERA_SOURCE;
+string frameSourcePath = "";
+bool frameSourcePaced = true;
+bool frameSourceLooping = true;
+
 // Create json interactable object.
 Document visionTuningJSON;
 
@@ -344,6 +357,8 @@ void GetJSONValues(auto &NetworkTable, int selectionState)
 	int smx = object["SMX"].GetInt();
 	int vmn = object["VMN"].GetInt();
 	int vmx = object["VMX"].GetInt();
+	// Older files don't have a pyramid level, so those modes search at full size.
+	int pyramidLevel = object.HasMember("PyramidLevel") ? object["PyramidLevel"].GetInt() : 0;
 
 	// Update network tables with the values from the JSON document object.
 	NetworkTable->PutNumber("Contour Area Min Limit", contourAreaMinLimit);
@@ -354,6 +369,7 @@ void GetJSONValues(auto &NetworkTable, int selectionState)
 	NetworkTable->PutNumber("SMX", smx);
 	NetworkTable->PutNumber("VMN", vmn);
 	NetworkTable->PutNumber("VMX", vmx);
+	NetworkTable->PutNumber("Pyramid Level", pyramidLevel);
 }
 
 /****************************************************************************
@@ -399,6 +415,7 @@ void PutJSONValues(auto &NetworkTable, int selectionState)
 	int smx = NetworkTable->GetNumber("SMX", 0);
 	int vmn = NetworkTable->GetNumber("VMN", 0);
 	int vmx = NetworkTable->GetNumber("VMX", 0);
+	int pyramidLevel = NetworkTable->GetNumber("Pyramid Level", 0);
 
 	// Update network tables with the values from the JSON document object.
 	object["ContourAreaMinLimit"].SetInt(contourAreaMinLimit);
@@ -409,12 +426,76 @@ void PutJSONValues(auto &NetworkTable, int selectionState)
 	object["SMX"].SetInt(smx);
 	object["VMN"].SetInt(vmn);
 	object["VMX"].SetInt(vmx);
+	if (!object.HasMember("PyramidLevel"))
+	{
+		object.AddMember("PyramidLevel", pyramidLevel, visionTuningJSON.GetAllocator());
+	}
+	object["PyramidLevel"].SetInt(pyramidLevel);
 }
 
 
+/****************************************************************************
+		Description:	Parses a --source argument into a frame source type
+						and path. Accepted values are camera, synthetic,
+						file:<video file>, and images:<directory>.
+
+		Arguments: 		CONST STRING&
+
+		Returns: 		BOOL
+****************************************************************************/
+bool ParseFrameSource(const string &source)
+{
+	// Split the source type from its path.
+	size_t separator = source.find(':');
+	string type = source.substr(0, separator);
+	string path = (separator == string::npos) ? "" : source.substr(separator + 1);
+
+	// Match the source type.
+	if (type == "camera")
+	{
+		frameSourceType = FrameSource::CAMERA_SOURCE;
+	}
+	else if (type == "synthetic")
+	{
+		frameSourceType = FrameSource::SYNTHETIC_SOURCE;
+	}
+	else if (type == "file" && !path.empty())
+	{
+		frameSourceType = FrameSource::VIDEO_FILE_SOURCE;
+	}
+	else if (type == "images" && !path.empty())
+	{
+		frameSourceType = FrameSource::IMAGE_DIRECTORY_SOURCE;
+	}
+	else
+	{
+		cout << "ERROR: Unknown frame source '" << source << "'. Use camera, synthetic, file:<path>, or images:<directory>." << endl;
+		return false;
+	}
+
+	frameSourcePath = path;
+	return true;
+}
+
+/****************************************************************************
+		Description:	Packs a thread's performance snapshot into an array
+						for NetworkTables. The order is fps, p50, p95, p99,
+						max (milliseconds), then the total frame count.
+
+		Arguments: 		PERFORMANCESNAPSHOT
+
+		Returns: 		VECTOR<DOUBLE>
+****************************************************************************/
+vector<double> GetPerformanceArray(PerformanceSnapshot performance)
+{
+	return {performance.framesPerSec, performance.p50, performance.p95, performance.p99, performance.max, double(performance.frames)};
+}
+
 /****************************************************************************
     Description:	Main method
 
+	Usage:			VISION [config file] [--source camera|synthetic|file:<path>|images:<directory>] [--unpaced] [--no-loop]
+
     Arguments: 		None
 
     Returns: 		Nothing
@@ -424,10 +505,31 @@ int main(int argc, char* argv[])
 	/************************************************************************** 
 	  			Read Configurations
 	 * ************************************************************************/
-	// Set web dashboard config path if given as argument.
-	if (argc >= 2) 
+	// Set web dashboard config path and frame source options if given as arguments.
+	for (int i = 1; i < argc; i++)
 	{
-		configFile = argv[1];
+		string argument = argv[i];
+		if (argument == "--source" && i + 1 < argc)
+		{
+			if (!ParseFrameSource(argv[++i]))
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		else if (argument == "--unpaced")
+		{
+			// Play files as fast as they can be read instead of in real time.
+			frameSourcePaced = false;
+		}
+		else if (argument == "--no-loop")
+		{
+			// Stop the program at the end of the file instead of rewinding.
+			frameSourceLooping = false;
+		}
+		else
+		{
+			configFile = argv[i];
+		}
 	}
 
 	// Read dashboard config.
@@ -475,6 +577,7 @@ int main(int argc, char* argv[])
 	this_thread::sleep_for(std::chrono::milliseconds(500));
 	// Populate NetworkTables.
 	NetworkTable->PutBoolean("Write JSON", false);
+	NetworkTable->PutBoolean("Write Trace", false);
 	NetworkTable->PutBoolean("Restart Program", false);
 	NetworkTable->PutBoolean("Camera Source", false);
 	NetworkTable->PutBoolean("Tuning Mode", false);
@@ -489,6 +592,11 @@ int main(int argc, char* argv[])
 	NetworkTable->PutNumber("Contour Area Min Limit", 1211);
 	NetworkTable->PutNumber("Contour Area Max Limit", 2000);
 	NetworkTable->PutNumber("Center Line Tolerance", 50);
+	NetworkTable->PutNumber("Line Scanlines", 0);
+	NetworkTable->PutBoolean("Trench Columns", false);
+	NetworkTable->PutBoolean("Predict Search Region", true);
+	NetworkTable->PutNumber("Pyramid Level", 0);
+	NetworkTable->PutBoolean("Skip Static Frames", false);
 	NetworkTable->PutNumber("HMN", 48);
 	NetworkTable->PutNumber("HMX", 104);
 	NetworkTable->PutNumber("SMN", 0);
@@ -496,6 +604,7 @@ int main(int argc, char* argv[])
 	NetworkTable->PutNumber("VMN", 0);
 	NetworkTable->PutNumber("VMX", 0);
 	NetworkTable->PutNumberArray("Tracking Results", vector<double> {});
+	NetworkTable->PutNumberArray("Target Estimates", vector<double> {});
 
 	/**************************************************************************
 	 			Start Cameras
@@ -506,22 +615,27 @@ int main(int argc, char* argv[])
 	}
 
 	/**************************************************************************
-	 			Start Image Processing on Camera 0
+	 			Start Image Processing on Camera 0 or the Chosen Frame Source
 	 * ************************************************************************/
-	if (cameraSinks.size() >= 1) 
+	if (cameraSinks.size() >= 1 || frameSourceType != FrameSource::CAMERA_SOURCE) 
 	{
+		// Make sure there is a stream to show processed frames on, even if no cameras are plugged in.
+		if (cameraSources.empty())
+		{
+			cameraSources.emplace_back(CameraServer::PutVideo("VirtualProcessed", 640, 480));
+		}
+
+		// Recycle frame-sized Mat buffers instead of going back to malloc for every one the threads create.
+		Mat::setDefaultAllocator(&MatPool::Get());
+
 		// Create object pointers for threads.
 		VideoGet VideoGetter;
 		VideoProcess VideoProcessor;
 		VideoShow VideoShower;
 
-		// Preallocate image objects.
-		Mat	frame(480, 640, CV_8U, 1);
-		Mat finalImg(480, 640, CV_8U, 1);
-
-		// Create a global instance of mutex to protect it.
-		shared_timed_mutex MutexGet;
-		shared_timed_mutex MutexShow;
+		// Preallocate image objects. Camera and processed frames are handed between threads through lock-free triple buffers.
+		FrameBuffer frameBuffer;
+		FrameBuffer finalImgBuffer;
 
 		// Vision options and values.
 		int targetCenterX = 0;
@@ -530,6 +644,7 @@ int main(int argc, char* argv[])
 		double contourAreaMinLimit = 0;
 		double contourAreaMaxLimit = 0;
 		bool writeJSON = false;
+		bool writeTrace = false;
 		bool stopProgam = false;
 		bool cameraSourceIndex = false;
 		bool tuningMode = false;
@@ -541,6 +656,7 @@ int main(int argc, char* argv[])
 		int selectionState = LINE;
 		vector<int> trackbarValues {1, 255, 1, 255, 1, 255};
 		vector<double> trackingResults {};
+		vector<double> targetEstimates {};
 		vector<double> solvePNPValues {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
 
 		// Start loading yolo model.
@@ -557,10 +673,21 @@ int main(int argc, char* argv[])
 		}
 		cout << "DNN class list loaded successfully." << endl;
 
+		// Create the frame source.
+		FrameSource* frameSource = nullptr;
+		if (frameSourceType == FrameSource::CAMERA_SOURCE)
+		{
+			frameSource = new CameraSource(cameraSinks, cameraSourceIndex);
+		}
+		else
+		{
+			frameSource = FrameSource::Create(frameSourceType, frameSourcePath, frameSourcePaced, frameSourceLooping);
+		}
+
 		// Start classes multi-threading.
-		thread VideoGetThread(&VideoGet::StartCapture, &VideoGetter, ref(frame), ref(cameraSourceIndex), ref(drivingMode), ref(cameraSinks), ref(MutexGet));
-		thread VideoProcessThread(&VideoProcess::Process, &VideoProcessor, ref(frame), ref(finalImg), ref(targetCenterX), ref(targetCenterY), ref(centerLineTolerance), ref(contourAreaMinLimit), ref(contourAreaMaxLimit), ref(tuningMode), ref(drivingMode), ref(trackingMode), ref(takeShapshot), ref(enableSolvePNP), ref(trackbarValues), ref(trackingResults), ref(solvePNPValues), ref(classList), ref(onnxModel), ref(VideoGetter), ref(MutexGet), ref(MutexShow));
-		thread VideoShowerThread(&VideoShow::ShowFrame, &VideoShower, ref(finalImg), ref(cameraSources), ref(MutexShow));
+		thread VideoGetThread(&VideoGet::StartCapture, &VideoGetter, ref(*frameSource), ref(frameBuffer));
+		thread VideoProcessThread(&VideoProcess::Process, &VideoProcessor, ref(frameBuffer), ref(finalImgBuffer), ref(targetCenterX), ref(targetCenterY), ref(centerLineTolerance), ref(contourAreaMinLimit), ref(contourAreaMaxLimit), ref(tuningMode), ref(drivingMode), ref(trackingMode), ref(takeShapshot), ref(enableSolvePNP), ref(trackbarValues), ref(trackingResults), ref(solvePNPValues), ref(classList), ref(onnxModel), ref(VideoGetter));
+		thread VideoShowerThread(&VideoShow::ShowFrame, &VideoShower, ref(finalImgBuffer), ref(cameraSources));
 		
 		while (1)
 		{
@@ -571,6 +698,7 @@ int main(int argc, char* argv[])
 				{
 					// Get NetworkTables data.
 					writeJSON = NetworkTable->GetBoolean("Write JSON", false);
+					writeTrace = NetworkTable->GetBoolean("Write Trace", false);
 					stopProgam = NetworkTable->GetBoolean("Restart Program", false);
 					cameraSourceIndex = NetworkTable->GetBoolean("Camera Source", false);
 					tuningMode = NetworkTable->GetBoolean("Tuning Mode", false);
@@ -819,6 +947,16 @@ int main(int argc, char* argv[])
 					centerLineTolerance = NetworkTable->GetNumber("Center Line Tolerance", 50);
 					contourAreaMinLimit = NetworkTable->GetNumber("Contour Area Min Limit", 1211.0);
 					contourAreaMaxLimit = NetworkTable->GetNumber("Contour Area Max Limit", 2000);
+					// Line tracking samples this many scanlines instead of filtering the whole frame. 0 turns it off.
+					VideoProcessor.SetLineScanlines(int(NetworkTable->GetNumber("Line Scanlines", 0)));
+					// Trench tracking finds the walls from column projections instead of contour hulls.
+					VideoProcessor.SetTrenchColumns(NetworkTable->GetBoolean("Trench Columns", false));
+					// The trench, line and tape modes only search near their last target, with a full scan after a miss.
+					VideoProcessor.SetRegionPrediction(NetworkTable->GetBoolean("Predict Search Region", true));
+					// The color modes threshold the frame halved this many times, and are saved with each mode's tuning values.
+					VideoProcessor.SetPyramidLevel(int(NetworkTable->GetNumber("Pyramid Level", 0)));
+					// Frames that haven't changed keep the last results, and frames that changed in one place are only searched there.
+					VideoProcessor.SetChangeGate(NetworkTable->GetBoolean("Skip Static Frames", false));
 					trackbarValues[0] = int(NetworkTable->GetNumber("HMN", 1));
 					trackbarValues[1] = int(NetworkTable->GetNumber("HMX", 255));
 					trackbarValues[2] = int(NetworkTable->GetNumber("SMN", 1));
@@ -829,6 +967,41 @@ int main(int argc, char* argv[])
 					// Put NetworkTables data.
 					NetworkTable->PutNumber("Target Center X", (targetCenterX + int(NetworkTable->GetNumber("X Setpoint Offset", 0))));
 					NetworkTable->PutNumber("Target Width", targetCenterY);
+					NetworkTable->PutNumber("Duplicate Frames Skipped", VideoProcessor.GetDuplicateFramesSkipped());
+					NetworkTable->PutNumber("Dropped Frames", VideoProcessor.GetDroppedFrames());
+
+					// Publish when the frame behind these results was captured and how long it took to get here. (milliseconds)
+					FrameMeta resultMeta = VideoProcessor.GetLastFrameMeta();
+					resultMeta.publishTime = Now();
+					if (resultMeta.sequence != 0)
+					{
+						NetworkTable->PutNumber("Frame Sequence", resultMeta.sequence);
+						NetworkTable->PutNumber("Frame Capture Time", resultMeta.grabTime);
+						NetworkTable->PutNumber("Queue Latency", (double(resultMeta.processStartTime) - double(resultMeta.grabTime)) / 1000.0);
+						NetworkTable->PutNumber("Processing Latency", (double(resultMeta.processEndTime) - double(resultMeta.processStartTime)) / 1000.0);
+						NetworkTable->PutNumber("Glass To NT Latency", (double(resultMeta.publishTime) - double(resultMeta.grabTime)) / 1000.0);
+						// Publish where the results were searched for, and whether that was the whole frame.
+						NetworkTable->PutNumberArray("Search Region", vector<double> {double(resultMeta.searchRegion.x), double(resultMeta.searchRegion.y), double(resultMeta.searchRegion.width), double(resultMeta.searchRegion.height)});
+						NetworkTable->PutBoolean("Full Scan", resultMeta.isFullScan);
+					}
+					// Publish the filtered targets predicted forward to now, so the controller doesn't act on where they were when the frame was grabbed.
+					VideoProcessor.GetTargetEstimates(resultMeta.publishTime, targetEstimates);
+					NetworkTable->PutNumberArray("Target Estimates", targetEstimates);
+					FrameMeta streamMeta = VideoShower.GetLastFrameMeta();
+					if (streamMeta.sequence != 0)
+					{
+						NetworkTable->PutNumber("Stream Latency", (double(streamMeta.publishTime) - double(streamMeta.grabTime)) / 1000.0);
+					}
+					NetworkTable->PutNumberArray("Capture Performance", GetPerformanceArray(VideoGetter.GetPerformance()));
+					NetworkTable->PutNumberArray("Processing Performance", GetPerformanceArray(VideoProcessor.GetPerformance()));
+					NetworkTable->PutNumberArray("Stream Performance", GetPerformanceArray(VideoShower.GetPerformance()));
+					MatPoolStats poolStats = MatPool::Get().GetStats();
+					NetworkTable->PutNumberArray("Mat Pool", vector<double> {double(poolStats.hits), double(poolStats.misses), poolStats.cachedBytes / 1048576.0});
+					// Publish how often the change gate skipped or narrowed a frame, and how much processing time it saved. (checked, skipped, narrowed, skip %, CPU saved %)
+					ChangeGateStats gateStats = VideoProcessor.GetChangeGateStats();
+					double gateTotalTime = double(gateStats.spentTime) + double(gateStats.savedTime);
+					NetworkTable->PutNumberArray("Change Gate", vector<double> {double(gateStats.checkedFrames), double(gateStats.skippedFrames), double(gateStats.narrowedFrames),
+						(gateStats.checkedFrames > 0) ? (100.0 * gateStats.skippedFrames / gateStats.checkedFrames) : 0.0, (gateTotalTime > 0.0) ? (100.0 * gateStats.savedTime / gateTotalTime) : 0.0});
 					if (!trackingResults.empty())
 					{
 						NetworkTable->PutBoolean("Line Is Vertical", trackingResults[0]);
@@ -866,6 +1039,15 @@ int main(int argc, char* argv[])
 						NetworkTable->PutBoolean("Write JSON", false);
 					}
 					
+					// Dump the last few seconds of per-stage timings if button is selected. Open the file in ui.perfetto.dev or chrome://tracing.
+					if (writeTrace)
+					{
+						Tracer::WriteChromeTrace(TraceFilePath);
+
+						// Unselect toggle button after writing is done.
+						NetworkTable->PutBoolean("Write Trace", false);
+					}
+
 					// Sleep.
 					this_thread::sleep_for(std::chrono::milliseconds(20));
 
@@ -894,6 +1076,10 @@ int main(int argc, char* argv[])
 		VideoProcessThread.join();
 		VideoShowerThread.join();
 
+		// Release the frame source.
+		delete frameSource;
+		frameSource = nullptr;
+
 		// Close opened file stream.
 		fcloseall();
 
@@ -0,0 +1,1363 @@
+/****************************************************************************
+		Description:	Headless benchmark for the vision pipeline. Runs each
+						tracking mode over the example videos without cameras,
+						cameraserver or NetworkTables, and reports frames per
+						second and per-frame latency percentiles. Also
+						checks that no frame allocates once warmed up.
+
+		Project:		MATE 2022
+
+		Copyright 2021 MST Design Team - Underwater Robotics.
+****************************************************************************/
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <math.h>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+
+#include "Headers/FrameBuffer.h"
+#include "Headers/FrameSource.h"
+#include "Headers/VideoProcess.h"
+#include "Headers/BlobExtractor.h"
+#include "Headers/BitMask.h"
+#include "Headers/Tracer.h"
+#include "Headers/AllocationCounter.h"
+#include "Headers/MatPool.h"
+#include "Headers/rapidjson/document.h"
+#include "Headers/rapidjson/filereadstream.h"
+#include "Headers/rapidjson/filewritestream.h"
+#include "Headers/rapidjson/prettywriter.h"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/opencv.hpp>
+
+using namespace cv;
+using namespace std;
+using namespace rapidjson;
+
+// Declare constants.
+static const vector<string> BENCH_VIDEOS = {"vid0.mp4", "vid1.mp4", "vid2.mp4", "vid3.mp4", "vid4mapping.mp4"};
+static const int BENCH_WARMUP_FRAMES = 5;
+static const int KERNEL_CHECK_ITERATIONS = 100;
+
+// Create structs.
+struct BenchMode
+{
+	string name;
+	string tuningName;			// Mode in trackbar_values.json to take the tuning from.
+	int trackingMode;
+	int lineScanlines;			// Scanlines for line tracking, or 0 to use strips.
+	bool trenchColumns;			// Find the trench walls from column projections instead of hulls.
+};
+
+struct BenchResult
+{
+	string name;
+	int frames;
+	double framesPerSec;
+	double p50;
+	double p95;
+	double p99;
+	double max;
+	uint64_t allocations;
+	int allocatingFrames;
+	double libraryAllocationsPerFrame;
+	double poolHitPercent;
+};
+
+// Declare benchmark options. (set from the command line)
+string rootPath = ".";
+string outputPath = "bench_results.json";
+string baselinePath = "";
+string tracePath = "";
+double tolerancePercent = 10.0;
+int maxFramesPerVideo = 0;
+bool saveBaseline = false;
+bool checkKernels = false;
+int frameBufferCheckSeconds = 0;
+bool fullFrameSearch = false;
+int pyramidLevelOverride = -1;
+bool changeGate = false;
+vector<BenchMode> benchModes = {{"TRENCH", "TRENCH", VideoProcess::TRENCH_TRACKING, 0, false}, {"TRENCH_COLS", "TRENCH", VideoProcess::TRENCH_TRACKING, 0, true}, {"LINE", "LINE", VideoProcess::LINE_TRACKING, 0, false},
+	{"LINE_SCAN", "LINE", VideoProcess::LINE_TRACKING, MAX_LINE_SPLITS, false}, {"FISH", "FISH", VideoProcess::FISH_TRACKING, 0, false}, {"TAPE", "TAPE", VideoProcess::TAPE_TRACKING, 0, false}};
+
+/****************************************************************************
+		Description:	Replaces the global operator new so every heap
+						allocation in the program is counted, including the
+						ones OpenCV makes with new.
+
+		Arguments: 		SIZE_T
+
+		Returns: 		VOID*
+****************************************************************************/
+void* operator new(size_t size)
+{
+	AllocationCounter::Count();
+	void* memory = malloc(size == 0 ? 1 : size);
+	if (memory == nullptr)
+	{
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+/****************************************************************************
+        Counts Mat buffers. OpenCV gets those from its own fastMalloc and
+        not operator new, so they need a MatAllocator of their own. The
+        actual work is left to the MatPool, same as in VISION.
+****************************************************************************/
+class CountingMatAllocator : public MatAllocator
+{
+public:
+	UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const override
+	{
+		// Wrapping user memory in a Mat doesn't allocate a buffer.
+		if (data == nullptr)
+		{
+			AllocationCounter::Count();
+		}
+		return MatPool::Get().allocate(dims, sizes, type, data, step, flags, usageFlags);
+	}
+
+	bool allocate(UMatData* data, AccessFlag accessFlags, UMatUsageFlags usageFlags) const override
+	{
+		return MatPool::Get().allocate(data, accessFlags, usageFlags);
+	}
+
+	void deallocate(UMatData* data) const override
+	{
+		MatPool::Get().deallocate(data);
+	}
+};
+
+/****************************************************************************
+		Description:	Reads and parses a JSON file.
+
+		Arguments: 		CONST STRING&, DOCUMENT&
+
+		Returns: 		BOOL
+****************************************************************************/
+bool ReadJSONFile(const string &path, Document &document)
+{
+	// Open file.
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// Parse file.
+	char readBuffer[65536];
+	FileReadStream readFileStream(file, readBuffer, sizeof(readBuffer));
+	document.ParseStream(readFileStream);
+	fclose(file);
+
+	return !document.HasParseError() && document.IsObject();
+}
+
+/****************************************************************************
+		Description:	Gets a percentile from a sorted list of latencies
+						using the nearest rank method.
+
+		Arguments: 		CONST VECTOR<DOUBLE>&, DOUBLE
+
+		Returns: 		DOUBLE
+****************************************************************************/
+double Percentile(const vector<double> &sortedLatencies, double percentile)
+{
+	// Nothing to report.
+	if (sortedLatencies.empty())
+	{
+		return 0.0;
+	}
+
+	// Find the nearest rank.
+	int rank = int(ceil((percentile / 100.0) * sortedLatencies.size())) - 1;
+	rank = max(0, min(rank, int(sortedLatencies.size()) - 1));
+	return sortedLatencies[rank];
+}
+
+/****************************************************************************
+		Description:	Times a call, averaged over KERNEL_CHECK_ITERATIONS
+						runs.
+
+		Arguments: 		FUNCTION
+
+		Returns: 		DOUBLE (milliseconds per call)
+****************************************************************************/
+template<class Function> double TimeCall(Function call)
+{
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+	for (int i = 0; i < KERNEL_CHECK_ITERATIONS; i++)
+	{
+		call();
+	}
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count() / KERNEL_CHECK_ITERATIONS;
+}
+
+/****************************************************************************
+		Description:	Dilates every label bit separately with OpenCV, which
+						is what VisionKernels::DilateLabels has to match.
+
+		Arguments: 		CONST MAT&, MAT&
+
+		Returns: 		Nothing
+****************************************************************************/
+void DilateLabelsWithOpenCV(const Mat &labelImg, Mat &dilatedImg)
+{
+	Mat bitImg;
+	dilatedImg = Mat::zeros(labelImg.size(), CV_8UC1);
+	for (int bit = 1; bit < 256; bit <<= 1)
+	{
+		bitwise_and(labelImg, Scalar(bit), bitImg);
+		dilate(bitImg, bitImg, KERNEL);
+		bitwise_or(dilatedImg, bitImg, dilatedImg);
+	}
+}
+
+/****************************************************************************
+		Description:	Checks every kernel set this CPU supports against
+						OpenCV on a 640x480 test frame and times both.
+
+		Arguments: 		None
+
+		Returns: 		BOOL (true if every kernel was bit-exact)
+****************************************************************************/
+bool CheckKernels()
+{
+	// Make a noisy color frame, a binary mask with small blobs, and a sparse label image.
+	Mat BGRImg(480, 640, CV_8UC3);
+	Mat noiseImg(480, 640, CV_8UC1);
+	Mat maskImg;
+	Mat labelImg;
+	randu(BGRImg, Scalar::all(0), Scalar::all(256));
+	randu(noiseImg, Scalar::all(0), Scalar::all(256));
+	threshold(noiseImg, maskImg, 200, 255, THRESH_BINARY);
+	randu(noiseImg, Scalar::all(0), Scalar::all(256));
+	bitwise_and(noiseImg, maskImg, labelImg);
+
+	// Get the OpenCV results and timings.
+	Mat blurReference, erodeReference, dilateReference, labelsReference;
+	double openCVTimes[4];
+	openCVTimes[0] = TimeCall([&]() { blur(BGRImg, blurReference, Size(GREEN_BLUR_RADIUS, GREEN_BLUR_RADIUS)); });
+	openCVTimes[1] = TimeCall([&]() { erode(maskImg, erodeReference, KERNEL); });
+	openCVTimes[2] = TimeCall([&]() { dilate(maskImg, dilateReference, KERNEL); });
+	openCVTimes[3] = TimeCall([&]() { DilateLabelsWithOpenCV(labelImg, labelsReference); });
+
+	Mat openReference;
+	double openCVOpenTime = TimeCall([&]() { morphologyEx(maskImg, openReference, MORPH_OPEN, KERNEL); });
+	int maskPixels = countNonZero(maskImg);
+
+	// OpenCV can only sum the columns, so the longest vertical runs are checked against a plain loop.
+	Mat maskOnesImg = maskImg / 255;
+	Mat countsReference;
+	double openCVProjectTime = TimeCall([&]() { reduce(maskOnesImg, countsReference, 0, REDUCE_SUM, CV_32S); });
+	vector<int> longestRunsReference(maskImg.cols, 0);
+	vector<int> longestEndsReference(maskImg.cols, 0);
+	for (int x = 0; x < maskImg.cols; x++)
+	{
+		int run = 0;
+		for (int y = 0; y < maskImg.rows; y++)
+		{
+			run = (maskImg.at<uint8_t>(y, x) != 0) ? run + 1 : 0;
+			if (run > longestRunsReference[x])
+			{
+				longestRunsReference[x] = run;
+				longestEndsReference[x] = y;
+			}
+		}
+	}
+
+	printf("%-8s %10s %10s %10s %10s %10s %10s %10s %10s\n", "KERNELS", "BLUR MS", "ERODE MS", "DILATE MS", "LABELS MS", "BIT ERODE", "BIT DILATE", "BIT OPEN", "PROJECT");
+	printf("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", "opencv", openCVTimes[0], openCVTimes[1], openCVTimes[2], openCVTimes[3], openCVTimes[1], openCVTimes[2], openCVOpenTime, openCVProjectTime);
+
+	// Run every kernel set and compare.
+	bool isExact = true;
+	for (const KernelSet* kernels : VisionKernels::GetSupported())
+	{
+		Mat blurImg, erodeImg, dilateImg, labelsImg;
+		double times[8];
+		times[0] = TimeCall([&]() { VisionKernels::BoxBlur3x3(BGRImg, blurImg, *kernels); });
+		times[1] = TimeCall([&]() { VisionKernels::ErodeCross(maskImg, erodeImg, *kernels); });
+		times[2] = TimeCall([&]() { VisionKernels::DilateCross(maskImg, dilateImg, *kernels); });
+		times[3] = TimeCall([&]() { VisionKernels::DilateLabels(labelImg, labelsImg, *kernels); });
+
+		// The bit mask versions are timed without packing or unpacking.
+		BitMask mask, erodeMask, dilateMask, openMask;
+		Mat erodeBitsImg, dilateBitsImg, openBitsImg;
+		mask.FromMat(maskImg, *kernels);
+		times[4] = TimeCall([&]() { mask.Erode(erodeMask, *kernels); });
+		times[5] = TimeCall([&]() { mask.Dilate(dilateMask, *kernels); });
+		times[6] = TimeCall([&]() { mask.Open(openMask, *kernels); });
+		erodeMask.ToMat(erodeBitsImg, *kernels);
+		dilateMask.ToMat(dilateBitsImg, *kernels);
+		openMask.ToMat(openBitsImg, *kernels);
+
+		// Column projection.
+		ColumnProjection projection;
+		times[7] = TimeCall([&]() { VisionKernels::ProjectColumns(maskImg, projection, *kernels); });
+		bool isProjectionExact = true;
+		for (int x = 0; x < maskImg.cols; x++)
+		{
+			isProjectionExact &= projection.counts[x] == countsReference.at<int>(0, x) && projection.longestRuns[x] == longestRunsReference[x] && projection.longestEnds[x] == longestEndsReference[x];
+		}
+		printf("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", kernels->name, times[0], times[1], times[2], times[3], times[4], times[5], times[6], times[7]);
+
+		// Any differing byte is a failure.
+		bool matches[9] = {norm(blurImg, blurReference, NORM_INF) == 0, norm(erodeImg, erodeReference, NORM_INF) == 0, norm(dilateImg, dilateReference, NORM_INF) == 0, norm(labelsImg, labelsReference, NORM_INF) == 0,
+			norm(erodeBitsImg, erodeReference, NORM_INF) == 0, norm(dilateBitsImg, dilateReference, NORM_INF) == 0, norm(openBitsImg, openReference, NORM_INF) == 0, mask.CountPixels() == maskPixels, isProjectionExact};
+		const char* names[9] = {"blur", "erode", "dilate", "labels", "bit erode", "bit dilate", "bit open", "bit count", "projection"};
+		for (int i = 0; i < 9; i++)
+		{
+			if (!matches[i])
+			{
+				cout << "MISMATCH: " << kernels->name << " " << names[i] << " differs from OpenCV." << endl;
+				isExact = false;
+			}
+		}
+	}
+
+	return isExact;
+}
+
+/****************************************************************************
+		Description:	Checks the streamed ColorLabeler::FilterImage against
+						the same chain run a whole image per stage, and
+						prints the time and memory traffic of each.
+
+		Arguments: 		None
+
+		Returns: 		BOOL (true if the masks were identical)
+****************************************************************************/
+bool CheckPipeline()
+{
+	// Create instance variables. Each stage of the separate chain reads and writes a full image: blur 3+3, mask 3+1, erode 1+1 and dilate 1+1 bytes per pixel. The streamed chain only reads the frame and writes the mask, which packed is one bit per pixel.
+	const vector<Size> frameSizes = {Size(SCREEN_WIDTH, SCREEN_HEIGHT), Size(1280, 720)};
+	const double separateBytesPerPixel = 14.0;
+	const double streamedBytesPerPixel = 4.0;
+	const double packedBytesPerPixel = 3.125;
+	ColorLabeler labeler;
+	labeler.SetColorRange(Scalar(0, 0, 64), Scalar(90, 255, 255));
+	bool isExact = true;
+
+	printf("%-10s %-9s %10s %12s %10s\n", "FRAME", "PIPELINE", "MS", "MB/FRAME", "GB/S");
+	for (const Size &frameSize : frameSizes)
+	{
+		// Make a noisy color frame.
+		Mat BGRImg(frameSize, CV_8UC3);
+		randu(BGRImg, Scalar::all(0), Scalar::all(256));
+		double megabytes = frameSize.area() / 1e6;
+		string frameName = to_string(frameSize.width) + "x" + to_string(frameSize.height);
+
+		// Run every stage over the whole image.
+		Mat blurImg, filterImg, erodeImg, separateImg;
+		double separateTime = TimeCall([&]() {
+			VisionKernels::BoxBlur3x3(BGRImg, blurImg);
+			labeler.MaskImage(blurImg, filterImg);
+			VisionKernels::ErodeCross(filterImg, erodeImg);
+			VisionKernels::DilateCross(erodeImg, separateImg);
+		});
+
+		// Stream the stages a row at a time.
+		Mat streamedImg;
+		double streamedTime = TimeCall([&]() { labeler.FilterImage(BGRImg, streamedImg); });
+
+		// Stream them into a bit mask.
+		BitMask packedMask;
+		Mat packedImg;
+		double packedTime = TimeCall([&]() { labeler.FilterImage(BGRImg, packedMask); });
+		packedMask.ToMat(packedImg);
+
+		printf("%-10s %-9s %10.3f %12.2f %10.2f\n", frameName.c_str(), "separate", separateTime, megabytes * separateBytesPerPixel, megabytes * separateBytesPerPixel / separateTime);
+		printf("%-10s %-9s %10.3f %12.2f %10.2f\n", frameName.c_str(), "streamed", streamedTime, megabytes * streamedBytesPerPixel, megabytes * streamedBytesPerPixel / streamedTime);
+		printf("%-10s %-9s %10.3f %12.2f %10.2f\n", frameName.c_str(), "packed", packedTime, megabytes * packedBytesPerPixel, megabytes * packedBytesPerPixel / packedTime);
+
+		// Any differing byte is a failure.
+		if (norm(streamedImg, separateImg, NORM_INF) != 0)
+		{
+			cout << "MISMATCH: streamed " << frameName << " mask differs from the separate stages." << endl;
+			isExact = false;
+		}
+		if (norm(packedImg, separateImg, NORM_INF) != 0)
+		{
+			cout << "MISMATCH: packed " << frameName << " mask differs from the separate stages." << endl;
+			isExact = false;
+		}
+	}
+
+	return isExact;
+}
+
+/****************************************************************************
+		Description:	Gets the stats of every blob as sortable rows of
+						top, left, width, height, area and centroid.
+
+		Arguments: 		BLOBEXTRACTOR&
+
+		Returns: 		VECTOR<ARRAY<DOUBLE, 7>>
+****************************************************************************/
+vector<array<double, 7>> GetSortedBlobStats(BlobExtractor &extractor)
+{
+	vector<array<double, 7>> rows;
+	for (int i = 0; i < extractor.GetCount(); i++)
+	{
+		const Blob &blob = extractor.GetBlob(i);
+		rows.push_back({double(blob.bounds.y), double(blob.bounds.x), double(blob.bounds.width), double(blob.bounds.height), double(blob.area), blob.centroid.x, blob.centroid.y});
+	}
+	sort(rows.begin(), rows.end());
+	return rows;
+}
+
+/****************************************************************************
+		Description:	Checks BlobExtractor with every kernel set against
+						connectedComponentsWithStats, and times it against
+						the findContours + contourArea + moments it can
+						replace.
+
+		Arguments: 		None
+
+		Returns: 		BOOL (true if every blob matched)
+****************************************************************************/
+bool CheckBlobs()
+{
+	// Make a sparse mask like the trench and tape modes see: two walls, a strip of tape and a line. The noisy mask is the worst case.
+	Mat sparseImg = Mat::zeros(SCREEN_HEIGHT, SCREEN_WIDTH, CV_8UC1);
+	rectangle(sparseImg, Rect(90, 40, 40, 400), Scalar(255), FILLED);
+	rectangle(sparseImg, Rect(500, 60, 45, 380), Scalar(255), FILLED);
+	ellipse(sparseImg, Point(320, 120), Size(60, 15), 30.0, 0.0, 360.0, Scalar(255), FILLED);
+	line(sparseImg, Point(200, 300), Point(420, 260), Scalar(255), 12);
+	Mat noiseImg(SCREEN_HEIGHT, SCREEN_WIDTH, CV_8UC1);
+	Mat noisyImg;
+	randu(noiseImg, Scalar::all(0), Scalar::all(256));
+	threshold(noiseImg, noisyImg, 200, 255, THRESH_BINARY);
+	const vector<pair<string, Mat>> masks = {{"sparse", sparseImg}, {"noisy", noisyImg}};
+	bool isExact = true;
+
+	printf("%-8s %-12s %10s %8s\n", "MASK", "BLOBS FROM", "MS", "BLOBS");
+	for (const pair<string, Mat> &mask : masks)
+	{
+		// What the modes do with contours now.
+		vector<vector<Point>> contours;
+		double contourTime = TimeCall([&]() {
+			findContours(mask.second, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+			for (const vector<Point> &contour : contours)
+			{
+				contourArea(contour);
+				moments(contour, true);
+			}
+		});
+		printf("%-8s %-12s %10.3f %8d\n", mask.first.c_str(), "contours", contourTime, int(contours.size()));
+
+		// OpenCV's labeling, which measures blobs the same way.
+		Mat labels, stats, centroids;
+		int componentCount = 0;
+		double componentTime = TimeCall([&]() { componentCount = connectedComponentsWithStats(mask.second, labels, stats, centroids, 8, CV_32S); });
+		printf("%-8s %-12s %10.3f %8d\n", mask.first.c_str(), "components", componentTime, componentCount - 1);
+
+		// Component 0 is the background. Labels aren't numbered in the same order, so compare sorted stats.
+		vector<array<double, 7>> referenceRows;
+		for (int i = 1; i < componentCount; i++)
+		{
+			referenceRows.push_back({double(stats.at<int>(i, CC_STAT_TOP)), double(stats.at<int>(i, CC_STAT_LEFT)), double(stats.at<int>(i, CC_STAT_WIDTH)), double(stats.at<int>(i, CC_STAT_HEIGHT)), double(stats.at<int>(i, CC_STAT_AREA)), centroids.at<double>(i, 0), centroids.at<double>(i, 1)});
+		}
+		sort(referenceRows.begin(), referenceRows.end());
+		auto checkBlobs = [&](BlobExtractor &extractor, const string &name) {
+			vector<array<double, 7>> rows = GetSortedBlobStats(extractor);
+			bool matches = rows.size() == referenceRows.size();
+			for (int i = 0; matches && i < int(rows.size()); i++)
+			{
+				for (int j = 0; j < 7; j++)
+				{
+					matches = matches && fabs(rows[i][j] - referenceRows[i][j]) < 1e-6;
+				}
+			}
+			if (!matches)
+			{
+				cout << "MISMATCH: " << name << " blobs of the " << mask.first << " mask differ from connectedComponentsWithStats." << endl;
+				isExact = false;
+			}
+		};
+
+		// Run length encode with every kernel set.
+		for (const KernelSet* kernels : VisionKernels::GetSupported())
+		{
+			BlobExtractor extractor;
+			double runTime = TimeCall([&]() { extractor.Find(mask.second, Point(), *kernels); });
+			printf("%-8s %-12s %10.3f %8d\n", mask.first.c_str(), (string("runs ") + kernels->name).c_str(), runTime, extractor.GetCount());
+			checkBlobs(extractor, kernels->name);
+		}
+
+		// Read the runs straight off a bit mask.
+		BitMask packedMask;
+		BlobExtractor extractor;
+		packedMask.FromMat(mask.second);
+		double packedTime = TimeCall([&]() { extractor.Find(packedMask); });
+		printf("%-8s %-12s %10.3f %8d\n", mask.first.c_str(), "runs bits", packedTime, extractor.GetCount());
+		checkBlobs(extractor, "bit mask");
+	}
+
+	return isExact;
+}
+
+/****************************************************************************
+		Description:	Measures how often the ColorLabeler's BGR table
+						disagrees with converting to HSV and range testing
+						every pixel, which is what it replaces. The table
+						classifies each 4x4x4 cell of BGR values by its
+						center, so only pixels in cells that straddle a
+						range edge can differ. Noise is the worst case,
+						since every cell is equally likely.
+
+		Arguments: 		None
+
+		Returns: 		Nothing
+****************************************************************************/
+void MeasureColorTable()
+{
+	// Create instance variables. Two tape ranges and a wide trench range.
+	const vector<vector<Scalar>> colorRanges = {{Scalar(91, 219, 118), Scalar(255, 255, 157)}, {Scalar(0, 228, 90), Scalar(68, 255, 163)}, {Scalar(48, 0, 0), Scalar(104, 128, 255)}};
+	Mat BGRImg(SCREEN_HEIGHT, SCREEN_WIDTH, CV_8UC3);
+	Mat HSVImg, rangeImg, referenceImg, maskImg, differentImg;
+	randu(BGRImg, Scalar::all(0), Scalar::all(256));
+	cvtColor(BGRImg, HSVImg, COLOR_BGR2HSV);
+
+	printf("%-8s %12s %12s\n", "COLORS", "MATCHED", "MISMATCH%");
+	for (int i = 0; i < int(colorRanges.size()); i++)
+	{
+		// One range at a time through both.
+		ColorLabeler labeler;
+		labeler.SetColorRange(colorRanges[i][0], colorRanges[i][1]);
+		labeler.MaskImage(BGRImg, maskImg);
+		inRange(HSVImg, colorRanges[i][0], colorRanges[i][1], referenceImg);
+
+		compare(maskImg, referenceImg, differentImg, CMP_NE);
+		int referenceCount = countNonZero(referenceImg);
+		int differentCount = countNonZero(differentImg);
+		printf("range %-2d %12d %12.3f\n", i, referenceCount, 100.0 * differentCount / (BGRImg.rows * BGRImg.cols));
+	}
+}
+
+/****************************************************************************
+		Description:	Fills a frame with a pattern made from its sequence
+						number, so a frame with part of another frame in
+						it can be told apart. Every byte changes from one
+						sequence to the next.
+
+		Arguments: 		MAT&, UINT64_T
+
+		Returns: 		Nothing
+****************************************************************************/
+void FillSequencePattern(Mat &frame, uint64_t sequence)
+{
+	for (int y = 0; y < frame.rows; y++)
+	{
+		uint8_t* row = frame.ptr<uint8_t>(y);
+		uint8_t start = uint8_t(sequence * 131 + y * 7);
+		for (int x = 0; x < frame.cols * frame.channels(); x++)
+		{
+			row[x] = uint8_t(start + x);
+		}
+	}
+}
+
+/****************************************************************************
+		Description:	Checks a frame against the pattern
+						FillSequencePattern makes for a sequence number.
+
+		Arguments: 		CONST MAT&, UINT64_T
+
+		Returns: 		BOOL (true if every byte matches)
+****************************************************************************/
+bool CheckSequencePattern(const Mat &frame, uint64_t sequence)
+{
+	for (int y = 0; y < frame.rows; y++)
+	{
+		const uint8_t* row = frame.ptr<uint8_t>(y);
+		uint8_t start = uint8_t(sequence * 131 + y * 7);
+		for (int x = 0; x < frame.cols * frame.channels(); x++)
+		{
+			if (row[x] != uint8_t(start + x))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/****************************************************************************
+		Description:	Stress tests the FrameBuffer handoff. A producer
+						thread publishes 640x480 BGR frames as fast as it
+						can, each filled with a pattern from its sequence
+						number, while a consumer thread acquires them and
+						checks every byte against the sequence in the
+						frame's metadata, and that the sequence only ever
+						goes up. Prints how many frames were checked and
+						the p50/p99 time from Publish to Acquire.
+
+		Arguments: 		INT (seconds to run for)
+
+		Returns: 		BOOL (true if no frame was torn or out of order)
+****************************************************************************/
+bool CheckFrameBuffer(int seconds)
+{
+	// Create instance variables.
+	FrameBuffer buffer;
+	atomic<bool> isProducing(true);
+	uint64_t publishedFrames = 0;
+	uint64_t checkedFrames = 0;
+	uint64_t tornFrames = 0;
+	uint64_t reorderedFrames = 0;
+	vector<double> latencies;
+	latencies.reserve(1000000);
+
+	// Publish frames until the time is up. The publish time goes in grabTime, right before the handoff.
+	thread producer([&]() {
+		chrono::steady_clock::time_point endTime = chrono::steady_clock::now() + chrono::seconds(seconds);
+		uint64_t sequence = 0;
+		while (chrono::steady_clock::now() < endTime)
+		{
+			Mat &frame = buffer.GetWriteBuffer();
+			FrameMeta &frameMeta = buffer.GetWriteMeta();
+			frame.create(SCREEN_HEIGHT, SCREEN_WIDTH, CV_8UC3);
+			FillSequencePattern(frame, ++sequence);
+			frameMeta.sequence = sequence;
+			frameMeta.grabTime = Now();
+			buffer.Publish();
+		}
+		publishedFrames = sequence;
+		isProducing = false;
+	});
+
+	// Check every frame handed over, until the producer is done and nothing is left.
+	thread consumer([&]() {
+		uint64_t lastSequence = 0;
+		while (isProducing || buffer.WaitForFrame(0))
+		{
+			if (!buffer.WaitForFrame(10) || !buffer.Acquire())
+			{
+				continue;
+			}
+			uint64_t acquireTime = Now();
+			const FrameMeta &frameMeta = buffer.GetReadMeta();
+			latencies.emplace_back((acquireTime - frameMeta.grabTime) / 1000.0);
+			if (frameMeta.sequence <= lastSequence)
+			{
+				reorderedFrames++;
+			}
+			if (!CheckSequencePattern(buffer.GetReadBuffer(), frameMeta.sequence))
+			{
+				tornFrames++;
+			}
+			lastSequence = frameMeta.sequence;
+			checkedFrames++;
+		}
+	});
+	producer.join();
+	consumer.join();
+
+	// Summarize.
+	sort(latencies.begin(), latencies.end());
+	printf("%-12s %10s %10s %8s %10s %10s %10s\n", "FRAMEBUFFER", "PUBLISHED", "CHECKED", "TORN", "REORDERED", "P50 MS", "P99 MS");
+	printf("%-12s %10llu %10llu %8llu %10llu %10.3f %10.3f\n", "640x480x3", (unsigned long long)publishedFrames, (unsigned long long)checkedFrames, (unsigned long long)tornFrames, (unsigned long long)reorderedFrames, Percentile(latencies, 50.0), Percentile(latencies, 99.0));
+
+	return checkedFrames > 0 && tornFrames == 0 && reorderedFrames == 0;
+}
+
+/****************************************************************************
+		Description:	Runs one tracking mode over every example video and
+						times each call to ProcessFrame. Video decoding is
+						not included in the timings.
+
+		Arguments: 		BENCHMODE&, VIDEOPROCESS&, DOCUMENT&, VECTOR<STRING>&, DNN::NET&
+
+		Returns: 		BENCHRESULT
+****************************************************************************/
+BenchResult RunMode(const BenchMode &mode, VideoProcess &VideoProcessor, Document &visionTuningJSON, vector<string> &classList, cv::dnn::Net &onnxModel)
+{
+	// Create instance variables.
+	BenchResult result = {mode.name, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0.0, 0.0};
+	vector<double> latencies;
+	uint64_t libraryAllocations = 0;
+	MatPoolStats startPoolStats = MatPool::Get().GetStats();
+	Mat frame;
+	Mat finalImg;
+	FrameMeta frameMeta;
+
+	// Pipeline inputs, matching the defaults from main.
+	int targetCenterX = 0;
+	int targetCenterY = 0;
+	int centerLineTolerance = 50;
+	double contourAreaMinLimit = 0;
+	double contourAreaMaxLimit = 0;
+	bool drivingMode = false;
+	bool takeShapshot = false;
+	int trackingMode = mode.trackingMode;
+	vector<int> trackbarValues {1, 255, 1, 255, 1, 255};
+	vector<double> trackingResults {};
+	int pyramidLevel = 0;
+
+	// Use the saved tuning values for this mode.
+	if (visionTuningJSON.HasMember(mode.tuningName.c_str()))
+	{
+		const rapidjson::Value& object = visionTuningJSON[mode.tuningName.c_str()];
+		contourAreaMinLimit = object["ContourAreaMinLimit"].GetInt();
+		contourAreaMaxLimit = object["ContourAreaMaxLimit"].GetInt();
+		trackbarValues = {object["HMN"].GetInt(), object["HMX"].GetInt(), object["SMN"].GetInt(), object["SMX"].GetInt(), object["VMN"].GetInt(), object["VMX"].GetInt()};
+		pyramidLevel = object.HasMember("PyramidLevel") ? object["PyramidLevel"].GetInt() : 0;
+	}
+	VideoProcessor.SetPyramidLevel((pyramidLevelOverride >= 0) ? pyramidLevelOverride : pyramidLevel);
+	VideoProcessor.SetLineScanlines(mode.lineScanlines);
+	VideoProcessor.SetTrenchColumns(mode.trenchColumns);
+	VideoProcessor.SetRegionPrediction(!fullFrameSearch);
+	VideoProcessor.SetChangeGate(changeGate);
+
+	// Run every video through the pipeline as fast as possible.
+	for (string video : BENCH_VIDEOS)
+	{
+		VideoFileSource source(rootPath + "/Example_Videos/" + video, false, false);
+		int framesRead = 0;
+		while (source.GrabFrame(frame, frameMeta) && (maxFramesPerVideo <= 0 || framesRead < maxFramesPerVideo))
+		{
+			// Time the frame and count what it allocates.
+			uint64_t startAllocations = AllocationCounter::GetCount();
+			uint64_t startLibraryAllocations = AllocationCounter::GetLibraryCount();
+			chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+			if (VideoProcessor.ProcessFrame(frame, finalImg, targetCenterX, targetCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, trackingResults, classList, onnxModel))
+			{
+				VideoProcessor.UpdateTargets(frameMeta.grabTime);
+			}
+			chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - startTime;
+			uint64_t frameAllocations = AllocationCounter::GetCount() - startAllocations;
+			uint64_t frameLibraryAllocations = AllocationCounter::GetLibraryCount() - startLibraryAllocations;
+
+			// Skip the first few frames of each video so one-time allocations don't skew the results.
+			if (framesRead >= BENCH_WARMUP_FRAMES)
+			{
+				latencies.emplace_back(elapsed.count());
+				result.allocations += frameAllocations;
+				result.allocatingFrames += (frameAllocations > 0) ? 1 : 0;
+				libraryAllocations += frameLibraryAllocations;
+			}
+			framesRead++;
+		}
+	}
+
+	// Summarize.
+	sort(latencies.begin(), latencies.end());
+	double totalTime = 0.0;
+	for (double latency : latencies)
+	{
+		totalTime += latency;
+	}
+	result.frames = latencies.size();
+	result.framesPerSec = (totalTime > 0.0) ? (latencies.size() * 1000.0 / totalTime) : 0.0;
+	result.p50 = Percentile(latencies, 50.0);
+	result.p95 = Percentile(latencies, 95.0);
+	result.p99 = Percentile(latencies, 99.0);
+	result.max = latencies.empty() ? 0.0 : latencies.back();
+	result.libraryAllocationsPerFrame = latencies.empty() ? 0.0 : double(libraryAllocations) / latencies.size();
+	MatPoolStats poolStats = MatPool::Get().GetStats();
+	uint64_t poolHits = poolStats.hits - startPoolStats.hits;
+	uint64_t poolRequests = poolHits + poolStats.misses - startPoolStats.misses;
+	result.poolHitPercent = (poolRequests > 0) ? (100.0 * poolHits / poolRequests) : 100.0;
+
+	return result;
+}
+
+/****************************************************************************
+		Description:	Finds how far a point is from a tracked line, across
+						the line. The line's points are joined up in order
+						and read off at the point's position along it.
+
+		Arguments: 		CONST VECTOR<DOUBLE>& (LINE_TRACKING results), POINT2D, DOUBLE&
+
+		Returns: 		BOOL (false if the point is past either end of the line)
+****************************************************************************/
+bool GetLineOffset(const vector<double> &lineResults, Point2d point, double &offset)
+{
+	// Vertical lines run down the rows, so they are read off by y and measured across in x.
+	bool isVertical = lineResults[0] != 0.0;
+	double along = isVertical ? point.y : point.x;
+	double across = isVertical ? point.x : point.y;
+
+	for (size_t i = 3; i + 1 < lineResults.size(); i += 2)
+	{
+		double startAlong = isVertical ? lineResults[i - 1] : lineResults[i - 2];
+		double startAcross = isVertical ? lineResults[i - 2] : lineResults[i - 1];
+		double endAlong = isVertical ? lineResults[i + 1] : lineResults[i];
+		double endAcross = isVertical ? lineResults[i] : lineResults[i + 1];
+		if (along >= startAlong && along <= endAlong && endAlong > startAlong)
+		{
+			double lineAcross = startAcross + (endAcross - startAcross) * (along - startAlong) / (endAlong - startAlong);
+			offset = fabs(across - lineAcross);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/****************************************************************************
+		Description:	Runs line tracking with strips and with scanlines
+						side by side on every frame, and reports how often
+						they agree and how far each scanline point is from
+						the strips' line.
+
+		Arguments: 		DOCUMENT&, VECTOR<STRING>&, DNN::NET&
+
+		Returns: 		Nothing
+****************************************************************************/
+void CompareLineScanlines(Document &visionTuningJSON, vector<string> &classList, cv::dnn::Net &onnxModel)
+{
+	// Create instance variables. Each needs its own processor, since each flips between vertical and horizontal on its own.
+	VideoProcess stripProcessor;
+	VideoProcess scanlineProcessor;
+	vector<double> offsets;
+	int frames = 0;
+	int sameDetection = 0;
+	int sameOrientation = 0;
+	int bothFound = 0;
+	Mat frame;
+	Mat stripImg;
+	Mat scanlineImg;
+	FrameMeta frameMeta;
+	scanlineProcessor.SetLineScanlines(MAX_LINE_SPLITS);
+
+	// Search every frame in full, so both see the same pixels.
+	stripProcessor.SetRegionPrediction(false);
+	scanlineProcessor.SetRegionPrediction(false);
+	stripProcessor.SetChangeGate(false);
+	scanlineProcessor.SetChangeGate(false);
+
+	// Pipeline inputs, matching RunMode.
+	int targetCenterX = 0;
+	int targetCenterY = 0;
+	int centerLineTolerance = 50;
+	double contourAreaMinLimit = 0;
+	double contourAreaMaxLimit = 0;
+	bool drivingMode = false;
+	bool takeShapshot = false;
+	int trackingMode = VideoProcess::LINE_TRACKING;
+	vector<int> trackbarValues {1, 255, 1, 255, 1, 255};
+	vector<double> stripResults {};
+	vector<double> scanlineResults {};
+	if (visionTuningJSON.HasMember("LINE"))
+	{
+		const rapidjson::Value& object = visionTuningJSON["LINE"];
+		contourAreaMinLimit = object["ContourAreaMinLimit"].GetInt();
+		contourAreaMaxLimit = object["ContourAreaMaxLimit"].GetInt();
+		trackbarValues = {object["HMN"].GetInt(), object["HMX"].GetInt(), object["SMN"].GetInt(), object["SMX"].GetInt(), object["VMN"].GetInt(), object["VMX"].GetInt()};
+	}
+
+	// Give both paths the same frames.
+	for (string video : BENCH_VIDEOS)
+	{
+		VideoFileSource source(rootPath + "/Example_Videos/" + video, false, false);
+		int framesRead = 0;
+		while (source.GrabFrame(frame, frameMeta) && (maxFramesPerVideo <= 0 || framesRead < maxFramesPerVideo))
+		{
+			stripProcessor.ProcessFrame(frame, stripImg, targetCenterX, targetCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, stripResults, classList, onnxModel);
+			scanlineProcessor.ProcessFrame(frame, scanlineImg, targetCenterX, targetCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, scanlineResults, classList, onnxModel);
+			frames++;
+			framesRead++;
+
+			// Only lines seen the same way can be compared point by point.
+			sameDetection += (stripResults.empty() == scanlineResults.empty()) ? 1 : 0;
+			if (stripResults.empty() || scanlineResults.empty())
+			{
+				continue;
+			}
+			bothFound++;
+			if (stripResults[0] != scanlineResults[0])
+			{
+				continue;
+			}
+			sameOrientation++;
+			for (size_t i = 1; i + 1 < scanlineResults.size(); i += 2)
+			{
+				double offset = 0.0;
+				if (GetLineOffset(stripResults, Point2d(scanlineResults[i], scanlineResults[i + 1]), offset))
+				{
+					offsets.emplace_back(offset);
+				}
+			}
+		}
+	}
+
+	// Summarize.
+	sort(offsets.begin(), offsets.end());
+	double totalOffset = 0.0;
+	for (double offset : offsets)
+	{
+		totalOffset += offset;
+	}
+	printf("\nLINE_SCAN vs LINE over %d frames: same detection %.1f%%, same orientation %.1f%% of %d found by both\n", frames, (frames > 0) ? (100.0 * sameDetection / frames) : 0.0, (bothFound > 0) ? (100.0 * sameOrientation / bothFound) : 0.0, bothFound);
+	printf("Scanline points off the strip line: %zu points, mean %.2f px, p95 %.2f px, max %.2f px\n", offsets.size(), offsets.empty() ? 0.0 : totalOffset / offsets.size(), Percentile(offsets, 95.0), offsets.empty() ? 0.0 : offsets.back());
+}
+
+/****************************************************************************
+		Description:	Runs trench tracking with contour hulls and with
+						column projections side by side on every frame, and
+						reports how often they agree and how far apart
+						their targets are.
+
+		Arguments: 		DOCUMENT&, VECTOR<STRING>&, DNN::NET&
+
+		Returns: 		Nothing
+****************************************************************************/
+void CompareTrenchDetectors(Document &visionTuningJSON, vector<string> &classList, cv::dnn::Net &onnxModel)
+{
+	// Create instance variables.
+	VideoProcess hullProcessor;
+	VideoProcess columnProcessor;
+	vector<double> offsetsX;
+	vector<double> offsetsY;
+	int frames = 0;
+	int sameDetection = 0;
+	Mat frame;
+	Mat hullImg;
+	Mat columnImg;
+	FrameMeta frameMeta;
+	columnProcessor.SetTrenchColumns(true);
+
+	// Search every frame in full, so both see the same pixels.
+	hullProcessor.SetRegionPrediction(false);
+	columnProcessor.SetRegionPrediction(false);
+	hullProcessor.SetChangeGate(false);
+	columnProcessor.SetChangeGate(false);
+
+	// Pipeline inputs, matching RunMode.
+	int centerLineTolerance = 50;
+	double contourAreaMinLimit = 0;
+	double contourAreaMaxLimit = 0;
+	bool drivingMode = false;
+	bool takeShapshot = false;
+	int trackingMode = VideoProcess::TRENCH_TRACKING;
+	vector<int> trackbarValues {1, 255, 1, 255, 1, 255};
+	vector<double> trackingResults {};
+	if (visionTuningJSON.HasMember("TRENCH"))
+	{
+		const rapidjson::Value& object = visionTuningJSON["TRENCH"];
+		contourAreaMinLimit = object["ContourAreaMinLimit"].GetInt();
+		contourAreaMaxLimit = object["ContourAreaMaxLimit"].GetInt();
+		trackbarValues = {object["HMN"].GetInt(), object["HMX"].GetInt(), object["SMN"].GetInt(), object["SMX"].GetInt(), object["VMN"].GetInt(), object["VMX"].GetInt()};
+	}
+
+	// Give both detectors the same frames. The hull path leaves the target alone on some frames, so start each from nothing found.
+	for (string video : BENCH_VIDEOS)
+	{
+		VideoFileSource source(rootPath + "/Example_Videos/" + video, false, false);
+		int framesRead = 0;
+		while (source.GrabFrame(frame, frameMeta) && (maxFramesPerVideo <= 0 || framesRead < maxFramesPerVideo))
+		{
+			int hullCenterX = 0;
+			int hullCenterY = -1;
+			int columnCenterX = 0;
+			int columnCenterY = -1;
+			hullProcessor.ProcessFrame(frame, hullImg, hullCenterX, hullCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, trackingResults, classList, onnxModel);
+			columnProcessor.ProcessFrame(frame, columnImg, columnCenterX, columnCenterY, centerLineTolerance, contourAreaMinLimit, contourAreaMaxLimit, drivingMode, trackingMode, takeShapshot, trackbarValues, trackingResults, classList, onnxModel);
+			frames++;
+			framesRead++;
+
+			// Only targets both found can be compared.
+			bool hullFound = hullCenterY != -1;
+			bool columnFound = columnCenterY != -1;
+			sameDetection += (hullFound == columnFound) ? 1 : 0;
+			if (hullFound && columnFound)
+			{
+				offsetsX.emplace_back(abs(hullCenterX - columnCenterX));
+				offsetsY.emplace_back(abs(hullCenterY - columnCenterY));
+			}
+		}
+	}
+
+	// Summarize.
+	sort(offsetsX.begin(), offsetsX.end());
+	sort(offsetsY.begin(), offsetsY.end());
+	double totalX = 0.0;
+	double totalY = 0.0;
+	for (size_t i = 0; i < offsetsX.size(); i++)
+	{
+		totalX += offsetsX[i];
+		totalY += offsetsY[i];
+	}
+	printf("\nTRENCH_COLS vs TRENCH over %d frames: same detection %.1f%%, %zu found by both\n", frames, (frames > 0) ? (100.0 * sameDetection / frames) : 0.0, offsetsX.size());
+	printf("Target X difference: mean %.2f px, p95 %.2f px. Channel width difference: mean %.2f px, p95 %.2f px\n", offsetsX.empty() ? 0.0 : totalX / offsetsX.size(), Percentile(offsetsX, 95.0), offsetsY.empty() ? 0.0 : totalY / offsetsY.size(), Percentile(offsetsY, 95.0));
+}
+
+/****************************************************************************
+		Description:	Writes the results as JSON.
+
+		Arguments: 		CONST STRING&, CONST VECTOR<BENCHRESULT>&
+
+		Returns: 		BOOL
+****************************************************************************/
+bool WriteResults(const string &path, const vector<BenchResult> &results)
+{
+	// Open file.
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// Write one object per mode.
+	char writeBuffer[65536];
+	FileWriteStream writeFileStream(file, writeBuffer, sizeof(writeBuffer));
+	PrettyWriter<FileWriteStream> writer(writeFileStream);
+	writer.StartObject();
+	writer.Key("modes");
+	writer.StartObject();
+	for (const BenchResult &result : results)
+	{
+		writer.Key(result.name.c_str());
+		writer.StartObject();
+		writer.Key("frames");
+		writer.Int(result.frames);
+		writer.Key("fps");
+		writer.Double(result.framesPerSec);
+		writer.Key("p50_ms");
+		writer.Double(result.p50);
+		writer.Key("p95_ms");
+		writer.Double(result.p95);
+		writer.Key("p99_ms");
+		writer.Double(result.p99);
+		writer.Key("max_ms");
+		writer.Double(result.max);
+		writer.Key("allocations");
+		writer.Uint64(result.allocations);
+		writer.Key("library_allocations_per_frame");
+		writer.Double(result.libraryAllocationsPerFrame);
+		writer.Key("pool_hit_percent");
+		writer.Double(result.poolHitPercent);
+		writer.EndObject();
+	}
+	writer.EndObject();
+	writer.EndObject();
+	writeFileStream.Flush();
+	fclose(file);
+
+	return true;
+}
+
+/****************************************************************************
+		Description:	Compares the results against a baseline file. A mode
+						regresses if its frame rate drops, or its p95 latency
+						grows, by more than the tolerance.
+
+		Arguments: 		CONST VECTOR<BENCHRESULT>&, DOCUMENT&
+
+		Returns: 		BOOL (true if nothing regressed)
+****************************************************************************/
+bool CompareToBaseline(const vector<BenchResult> &results, Document &baseline)
+{
+	// Create instance variables.
+	bool passed = true;
+	double tolerance = tolerancePercent / 100.0;
+
+	// Check every mode that has a baseline.
+	for (const BenchResult &result : results)
+	{
+		if (!baseline.HasMember("modes") || !baseline["modes"].HasMember(result.name.c_str()))
+		{
+			cout << result.name << ": no baseline, skipping comparison." << endl;
+			continue;
+		}
+
+		const rapidjson::Value& object = baseline["modes"][result.name.c_str()];
+		double baselineFPS = object["fps"].GetDouble();
+		double baselineP95 = object["p95_ms"].GetDouble();
+		if (result.framesPerSec < baselineFPS * (1.0 - tolerance))
+		{
+			cout << "REGRESSION: " << result.name << " fps " << result.framesPerSec << " vs baseline " << baselineFPS << endl;
+			passed = false;
+		}
+		if (result.p95 > baselineP95 * (1.0 + tolerance))
+		{
+			cout << "REGRESSION: " << result.name << " p95 " << result.p95 << " ms vs baseline " << baselineP95 << " ms" << endl;
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+/****************************************************************************
+    Description:	Main method
+
+	Usage:			vision_bench [--root <repo dir>] [--modes TRENCH,TRENCH_COLS,LINE,LINE_SCAN,FISH,TAPE] [--max-frames <n>]
+								 [--output <file>] [--baseline <file>] [--tolerance <percent>] [--save-baseline]
+								 [--trace <file>] [--check-kernels] [--check-framebuffer <seconds>] [--full-frame] [--pyramid <level>] [--change-gate]
+
+    Returns: 		0 if nothing regressed, 1 on a regression, an allocation
+					after warm-up, or an error
+****************************************************************************/
+int main(int argc, char* argv[])
+{
+	// Read options.
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if (argument == "--root" && i + 1 < argc)
+		{
+			rootPath = argv[++i];
+		}
+		else if (argument == "--modes" && i + 1 < argc)
+		{
+			// Keep only the listed modes. Names are matched whole, so LINE doesn't pick up LINE_SCAN.
+			string list = "," + string(argv[++i]) + ",";
+			vector<BenchMode> selectedModes;
+			for (BenchMode mode : benchModes)
+			{
+				if (list.find("," + mode.name + ",") != string::npos)
+				{
+					selectedModes.emplace_back(mode);
+				}
+			}
+			benchModes = selectedModes;
+		}
+		else if (argument == "--max-frames" && i + 1 < argc)
+		{
+			maxFramesPerVideo = atoi(argv[++i]);
+		}
+		else if (argument == "--output" && i + 1 < argc)
+		{
+			outputPath = argv[++i];
+		}
+		else if (argument == "--baseline" && i + 1 < argc)
+		{
+			baselinePath = argv[++i];
+		}
+		else if (argument == "--tolerance" && i + 1 < argc)
+		{
+			tolerancePercent = atof(argv[++i]);
+		}
+		else if (argument == "--save-baseline")
+		{
+			saveBaseline = true;
+		}
+		else if (argument == "--trace" && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+		}
+		else if (argument == "--check-kernels")
+		{
+			checkKernels = true;
+		}
+		else if (argument == "--check-framebuffer" && i + 1 < argc)
+		{
+			frameBufferCheckSeconds = atoi(argv[++i]);
+		}
+		else if (argument == "--full-frame")
+		{
+			// Search the whole of every frame, to compare against only searching near the last target.
+			fullFrameSearch = true;
+		}
+		else if (argument == "--pyramid" && i + 1 < argc)
+		{
+			// Use this pyramid level for every mode instead of each mode's saved one.
+			pyramidLevelOverride = atoi(argv[++i]);
+		}
+		else if (argument == "--change-gate")
+		{
+			// Skip frames that haven't changed, and only search the part of a frame that did. Off by default so every frame is timed in full.
+			changeGate = true;
+		}
+		else
+		{
+			cout << "Unknown argument '" << argument << "'." << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (baselinePath.empty())
+	{
+		baselinePath = rootPath + "/Code/bench_baseline.json";
+	}
+
+	// Only stress test the frame handoff between threads.
+	if (frameBufferCheckSeconds > 0)
+	{
+		if (!CheckFrameBuffer(frameBufferCheckSeconds))
+		{
+			cout << "FAILED: the frame buffer handed over a torn or out of order frame." << endl;
+			return EXIT_FAILURE;
+		}
+		cout << "PASSED: every frame handed over was whole and in order." << endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Only check the vision kernels against OpenCV.
+	if (checkKernels)
+	{
+		if (!CheckKernels())
+		{
+			cout << "FAILED: vision kernels are not bit-exact with OpenCV." << endl;
+			return EXIT_FAILURE;
+		}
+		if (!CheckPipeline())
+		{
+			cout << "FAILED: the streamed threshold pipeline doesn't match the separate stages." << endl;
+			return EXIT_FAILURE;
+		}
+		if (!CheckBlobs())
+		{
+			cout << "FAILED: run length encoded blobs don't match connectedComponentsWithStats." << endl;
+			return EXIT_FAILURE;
+		}
+		MeasureColorTable();
+		cout << "PASSED: vision kernels are bit-exact with OpenCV." << endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Load the saved tuning values.
+	Document visionTuningJSON;
+	if (!ReadJSONFile(rootPath + "/Code/trackbar_values.json", visionTuningJSON))
+	{
+		cout << "ERROR: Unable to load " << rootPath << "/Code/trackbar_values.json" << endl;
+		return EXIT_FAILURE;
+	}
+
+	// Load the YOLO model for fish tracking. Skip the mode if it can't be loaded.
+	cv::dnn::Net onnxModel;
+	vector<string> classList;
+	try
+	{
+		string modelPath = rootPath + "/YOLO_Models/COCO_v5n_Test/";
+		onnxModel = cv::dnn::readNet(modelPath + "best.onnx");
+		ifstream ifs(modelPath + "classes.txt");
+		string line;
+		while (getline(ifs, line))
+		{
+			classList.push_back(line);
+		}
+	}
+	catch (const exception& e)
+	{
+		cout << "WARNING: Unable to load DNN model, skipping FISH.\n" << e.what() << endl;
+		benchModes.erase(remove_if(benchModes.begin(), benchModes.end(), [](const BenchMode& mode) { return mode.trackingMode == VideoProcess::FISH_TRACKING; }), benchModes.end());
+	}
+
+	// Count every Mat buffer from here on.
+	static CountingMatAllocator countingMatAllocator;
+	Mat::setDefaultAllocator(&countingMatAllocator);
+
+	// Run every mode.
+	VideoProcess VideoProcessor;
+	vector<BenchResult> results;
+	vector<ChangeGateStats> gateStats;
+	bool allocatedAfterWarmup = false;
+	printf("%-12s %8s %10s %10s %10s %10s %10s %8s %10s %10s\n", "MODE", "FRAMES", "FPS", "P50 MS", "P95 MS", "P99 MS", "MAX MS", "ALLOCS", "LIB/FRAME", "POOL HIT%");
+	for (BenchMode mode : benchModes)
+	{
+		ChangeGateStats startGateStats = VideoProcessor.GetChangeGateStats();
+		BenchResult result = RunMode(mode, VideoProcessor, visionTuningJSON, classList, onnxModel);
+		ChangeGateStats endGateStats = VideoProcessor.GetChangeGateStats();
+		gateStats.push_back({endGateStats.checkedFrames - startGateStats.checkedFrames, endGateStats.skippedFrames - startGateStats.skippedFrames, endGateStats.narrowedFrames - startGateStats.narrowedFrames,
+			endGateStats.spentTime - startGateStats.spentTime, endGateStats.savedTime - startGateStats.savedTime});
+		printf("%-12s %8d %10.1f %10.2f %10.2f %10.2f %10.2f %8llu %10.1f %10.1f\n", result.name.c_str(), result.frames, result.framesPerSec, result.p50, result.p95, result.p99, result.max, (unsigned long long)result.allocations, result.libraryAllocationsPerFrame, result.poolHitPercent);
+		results.emplace_back(result);
+		allocatedAfterWarmup |= result.allocations > 0;
+	}
+
+	// Show how much of each mode's work the change gate saved.
+	if (changeGate)
+	{
+		printf("\n%-12s %8s %8s %8s %8s %10s\n", "CHANGE GATE", "CHECKED", "SKIPPED", "NARROWED", "SKIP%", "CPU SAVED%");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			double totalTime = double(gateStats[i].spentTime) + double(gateStats[i].savedTime);
+			printf("%-12s %8llu %8llu %8llu %8.1f %10.1f\n", results[i].name.c_str(), (unsigned long long)gateStats[i].checkedFrames, (unsigned long long)gateStats[i].skippedFrames, (unsigned long long)gateStats[i].narrowedFrames,
+				(gateStats[i].checkedFrames > 0) ? (100.0 * gateStats[i].skippedFrames / gateStats[i].checkedFrames) : 0.0, (totalTime > 0.0) ? (100.0 * gateStats[i].savedTime / totalTime) : 0.0);
+		}
+	}
+
+	// Put each alternative path's accuracy next to its speed.
+	bool benchingTrench = any_of(benchModes.begin(), benchModes.end(), [](const BenchMode& mode) { return mode.trackingMode == VideoProcess::TRENCH_TRACKING && !mode.trenchColumns; });
+	bool benchingTrenchColumns = any_of(benchModes.begin(), benchModes.end(), [](const BenchMode& mode) { return mode.trenchColumns; });
+	if (benchingTrench && benchingTrenchColumns)
+	{
+		CompareTrenchDetectors(visionTuningJSON, classList, onnxModel);
+	}
+	bool benchingLine = any_of(benchModes.begin(), benchModes.end(), [](const BenchMode& mode) { return mode.trackingMode == VideoProcess::LINE_TRACKING && mode.lineScanlines == 0; });
+	bool benchingScanlines = any_of(benchModes.begin(), benchModes.end(), [](const BenchMode& mode) { return mode.lineScanlines > 0; });
+	if (benchingLine && benchingScanlines)
+	{
+		CompareLineScanlines(visionTuningJSON, classList, onnxModel);
+	}
+
+	// Dump the per-stage spans of the last frames we ran.
+	if (!tracePath.empty())
+	{
+		Tracer::WriteChromeTrace(tracePath);
+	}
+
+	// Write the machine readable results.
+	if (!WriteResults(outputPath, results))
+	{
+		cout << "ERROR: Unable to write " << outputPath << endl;
+		return EXIT_FAILURE;
+	}
+	cout << "Results written to " << outputPath << endl;
+
+	// Our own code must not touch the heap once every buffer has grown to fit.
+	if (allocatedAfterWarmup)
+	{
+		for (const BenchResult &result : results)
+		{
+			if (result.allocations > 0)
+			{
+				cout << "FAILED: " << result.name << " made " << result.allocations << " heap allocations in " << result.allocatingFrames << " frames after warm-up." << endl;
+			}
+		}
+		return EXIT_FAILURE;
+	}
+
+	// Store these results as the new baseline instead of comparing.
+	if (saveBaseline)
+	{
+		if (!WriteResults(baselinePath, results))
+		{
+			cout << "ERROR: Unable to write " << baselinePath << endl;
+			return EXIT_FAILURE;
+		}
+		cout << "Baseline written to " << baselinePath << endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Compare against the stored baseline, if there is one.
+	Document baseline;
+	if (!ReadJSONFile(baselinePath, baseline))
+	{
+		cout << "No baseline found at " << baselinePath << ". Run with --save-baseline to create one." << endl;
+		return EXIT_SUCCESS;
+	}
+	if (!CompareToBaseline(results, baseline))
+	{
+		cout << "FAILED: results regressed more than " << tolerancePercent << "% against the baseline." << endl;
+		return EXIT_FAILURE;
+	}
+
+	cout << "PASSED: no regressions against the baseline." << endl;
+	return EXIT_SUCCESS;
+}